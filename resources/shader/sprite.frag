@@ -5,6 +5,7 @@ layout(location = 0) in vec2 in_texCoord;
 layout(location = 1) in flat uvec2 in_textureHandle;
 layout(location = 2) in flat vec4 in_anim;
 layout(location = 3) in flat vec2 in_numTiles;
+layout(location = 4) in flat vec4 in_color;
 
 layout(location = 0, index = 0) out vec4 out_color;
 
@@ -30,5 +31,7 @@ void main()
 	}
 	
 	if(color.a < 0.05) discard;
+	// replace blue areas by the instance color
+	if(in_color.a > 0.0) color.rgb = mix(color.rgb, in_color.rgb, color.b * in_color.a);
 	out_color = color;
 }
\ No newline at end of file
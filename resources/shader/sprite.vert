@@ -7,6 +7,7 @@ layout(location = 3) in vec3 in_position;
 layout(location = 4) in float in_rotation;
 layout(location = 5) in vec4 in_scale;
 layout(location = 6) in vec2 in_anim;
+layout(location = 7) in vec4 in_color;
 
 layout(location = 0) out vec4 out_texCoords;
 layout(location = 1) out uvec2 out_textureHandle;
@@ -15,6 +16,7 @@ layout(location = 3) out vec3 out_position;
 layout(location = 4) out float out_rotation;
 layout(location = 5) out vec4 out_scale;
 layout(location = 6) out vec2 out_anim;
+layout(location = 7) out vec4 out_color;
 
 void main()
 {
@@ -25,4 +27,5 @@ void main()
 	out_rotation = in_rotation;
 	out_scale = in_scale;
 	out_anim = in_anim;
+	out_color = in_color;
 }
\ No newline at end of file
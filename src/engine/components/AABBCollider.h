@@ -6,6 +6,8 @@
 #include <engine/math/geometrictypes.hpp>
 #include "transform.h"
 #include <algorithm>
+#include <vector>
+#include <memory_resource>
 
 namespace components {
     struct AABBCollider {
@@ -18,15 +20,56 @@ namespace components {
         glm::vec3 positiveBoundOffset = glm::vec3(1.0f, 1.0f, 1.0f);
         glm::vec3 negativeBoundOffset = glm::vec3(-1.0f, -1.0f, -1.0f);
 
-        [[nodiscard]] math::AABB<3, float> getAABB(components::Transform transform) const {
-            // because of rotation, we're not guaranteed that these are the actual min/max points -> gather min components individually
-            glm::vec3 pointA = transform.getPosition() + (transform.getRotation() * (transform.getScale() * negativeBoundOffset));
-            glm::vec3 pointB = transform.getPosition() + (transform.getRotation() * (transform.getScale() * positiveBoundOffset));
-            return {
-                    glm::vec3(std::min(pointA.x, pointB.x), std::min(pointA.y, pointB.y), std::min(pointA.z, pointB.z)),
-                    glm::vec3(std::max(pointA.x, pointB.x), std::max(pointA.y, pointB.y), std::max(pointA.z, pointB.z))
+        /**
+         * Computes the world space box which encloses the rotated and scaled collider.
+         * All eight corners are taken into account, so the box is never too small.
+         */
+        [[nodiscard]] math::AABB<3, float> getAABB(const components::Transform &transform) const {
+            return math::transform(math::AABB<3, float>(negativeBoundOffset, positiveBoundOffset), transform.getTransformMatrix());
+        }
+    };
+
+    /**
+     * Computes the world space boxes of all entities with a Transform and an AABBCollider in a single registry pass.
+     */
+    class AABBColliderSystem {
+    public:
+        struct ColliderBox {
+            const entity::EntityReference *entity;
+            math::AABB<3, float> box;
+        };
+
+    private:
+        auto action() {
+            return [this](const entity::EntityReference *entity, components::Transform transform, components::AABBCollider collider) {
+                boxes.push_back({entity, collider.getAABB(transform)});
             };
         }
+
+    public:
+        /**
+         * @param _boxes receives the boxes, previous content is removed
+         */
+        AABBColliderSystem(entity::EntityRegistry &_registry, std::pmr::vector<ColliderBox> &_boxes)
+                : registry(_registry), boxes(_boxes) {}
+
+        void execute() {
+            boxes.clear();
+            registry.execute(action());
+        }
+
+        /**
+         * Skips entities that have any of the components T_Excluded, e.g. sleeping entities whose boxes did not change.
+         */
+        template<typename ...T_Excluded>
+        void executeExcluding() {
+            boxes.clear();
+            registry.executeExcluding<T_Excluded...>(action());
+        }
+
+    private:
+        entity::EntityRegistry &registry;
+        std::pmr::vector<ColliderBox> &boxes;
     };
 }
 
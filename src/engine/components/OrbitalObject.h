@@ -3,9 +3,17 @@
 
 #include <glm/glm.hpp>
 #include <vector>
+#include <memory_resource>
 #include <engine/entity/entityregistry.h>
+#include <engine/utils/framearena.hpp>
+#include <engine/math/narrowphase.hpp>
+#include <engine/math/gravity.hpp>
+#include <engine/math/integrator.hpp>
+#include <engine/utils/threadpool.hpp>
+#include <engine/utils/containers/sweepandprune.hpp>
 #include "transform.h"
 #include "velocity.h"
+#include "sleep.h"
 
 namespace components {
     struct OrbitalObject {
@@ -17,6 +25,15 @@ namespace components {
         double mass = 1.0;
     };
 
+    enum class GravitySolver {
+        /** Exact sum over all pairs, the reference for the approximations. Suitable for a few hundred bodies. */
+        Pairwise,
+        /** Barnes-Hut octree, O(n log n) and evaluated in parallel. Suitable for many thousand bodies. */
+        BarnesHut,
+        /** Exact sum with a SIMD kernel, evaluated in parallel. Suitable for up to a few thousand bodies. */
+        DirectSum
+    };
+
     class OrbitalSystem {
     private:
         struct OrbitalQueryEntry {
@@ -29,28 +46,128 @@ namespace components {
             components::OrbitalObject orbital;
         };
 
+        struct BodyEntry {
+            const entity::EntityReference *entity;
+            components::Velocity velocity;
+        };
+
     public:
-        OrbitalSystem(entity::EntityRegistry &_registry, double _deltaSeconds, double _deltaSecondsSquared)
-                : registry(_registry), deltaSeconds(_deltaSeconds), deltaSecondsSquared(_deltaSecondsSquared) {}
+        static constexpr double gravConstant = 6.6743e-5;
+
+        /**
+         * @param _solver method to compute the accelerations
+         * @param _openingAngle theta of the Barnes-Hut solver: larger is faster but less accurate
+         * @param _softening added to the distances by BarnesHut and DirectSum to limit the force of close encounters
+         */
+        OrbitalSystem(entity::EntityRegistry &_registry, double _deltaSeconds, double _deltaSecondsSquared,
+                      GravitySolver _solver = GravitySolver::Pairwise, float _openingAngle = 0.5f, float _softening = 0.0f)
+                : registry(_registry), deltaSeconds(_deltaSeconds), deltaSecondsSquared(_deltaSecondsSquared),
+                  solver(_solver), openingAngle(_openingAngle), softening(_softening) {}
 
         void execute() {
-            std::vector<OrbitalQueryEntry> orbitalEntities = {};
+            switch (solver) {
+                case GravitySolver::Pairwise:
+                    executePairwise();
+                    break;
+                case GravitySolver::BarnesHut:
+                case GravitySolver::DirectSum:
+                    executeGathered();
+                    break;
+            }
+        }
+
+        /**
+         * Advances positions and velocities of all bodies with the given integrator, while execute() only updates the velocities.
+         * The positions are integrated here, so ApplyVelocitySystem has to skip the bodies:
+         * ApplyVelocitySystem(...).executeExcluding<OrbitalObject>().
+         * With a symplectic integrator like Leapfrog, orbits remain stable at much larger time steps.
+         * The Pairwise solver uses the scalar direct sum here.
+         * Sleeping bodies still attract the others, but are neither moved nor accelerated.
+         * The accelerations of Sleepable bodies are added to their Sleepable, so that the SleepSystem wakes a body
+         * once the pull on it becomes too strong.
+         */
+        void integrate(math::Integrator integrator) {
+            utils::FrameArena &arena = utils::FrameArena::get();
+            std::pmr::vector<const entity::EntityReference *> bodies(&arena);
+            std::pmr::vector<components::Transform> transforms(&arena);
+            std::pmr::vector<glm::vec3> positions(&arena);
+            std::pmr::vector<glm::vec3> velocities(&arena);
+            std::pmr::vector<float> masses(&arena);
+            std::pmr::vector<glm::vec3> lastAccelerations(&arena);
+            registry.executeExcluding<components::Sleeping>([&](const entity::EntityReference *entity, components::Transform transform,
+                                                                components::Velocity velocity, components::OrbitalObject orbital) {
+                bodies.push_back(entity);
+                transforms.push_back(transform);
+                positions.push_back(transform.getPosition());
+                velocities.push_back(velocity.velocity);
+                masses.push_back(static_cast<float>(orbital.mass));
+            });
+            // sleeping bodies are appended after the awake ones and only take part as sources
+            const size_t numAwake = bodies.size();
+            registry.execute([&](const entity::EntityReference *entity, components::Transform transform, components::OrbitalObject orbital,
+                                 components::Sleeping) {
+                bodies.push_back(entity);
+                positions.push_back(transform.getPosition());
+                velocities.push_back(glm::vec3(0.0f));
+                masses.push_back(static_cast<float>(orbital.mass));
+            });
+
+            math::integrate(integrator, std::span<glm::vec3>(positions), std::span<glm::vec3>(velocities), static_cast<float>(deltaSeconds),
+                            [&](std::span<const glm::vec3> x, std::span<const glm::vec3>, std::span<glm::vec3> accelerations) {
+                                computeAccelerations(x, masses, accelerations);
+                                lastAccelerations.assign(accelerations.begin(), accelerations.end());
+                                for (size_t i = numAwake; i < accelerations.size(); ++i) {
+                                    accelerations[i] = glm::vec3(0.0f);
+                                }
+                            }, &arena);
+
+            for (size_t i = 0; i < bodies.size(); ++i) {
+                std::optional<components::Sleepable> sleepable = registry.getComponentData<components::Sleepable>(bodies[i]);
+                if (sleepable) {
+                    sleepable->acceleration += lastAccelerations[i];
+                    registry.addOrSetComponent(bodies[i], *sleepable);
+                }
+            }
+
+            for (size_t i = 0; i < numAwake; ++i) {
+                transforms[i].setPosition(positions[i]);
+                registry.addOrSetComponent(bodies[i], transforms[i]);
+                registry.addOrSetComponent(bodies[i], components::Velocity(velocities[i]));
+            }
+        }
+
+    private:
+        /**
+         * Accelerations including the gravitational constant with the array based solvers.
+         */
+        void computeAccelerations(std::span<const glm::vec3> positions, std::span<const float> masses, std::span<glm::vec3> accelerations) const {
+            utils::FrameArena &arena = utils::FrameArena::get();
+            if (solver == GravitySolver::BarnesHut) {
+                math::BarnesHut<float> tree(openingAngle, softening, &arena);
+                tree.build(positions, masses);
+                tree.computeAccelerations(accelerations);
+            } else {
+                math::DirectSum<float> directSum(softening, solver == GravitySolver::DirectSum, &arena);
+                directSum.build(positions, masses);
+                directSum.computeAccelerations(accelerations);
+            }
+            for (glm::vec3 &acceleration: accelerations) {
+                acceleration *= static_cast<float>(gravConstant);
+            }
+        }
+
+        void executePairwise() {
+            std::pmr::vector<OrbitalQueryEntry> orbitalEntities(&utils::FrameArena::get());
             registry.execute([this, &orbitalEntities]
                                      (const entity::EntityReference *entity, components::Transform transform, components::Velocity velocity,
                                       components::OrbitalObject orbital) {
                 for (OrbitalQueryEntry &other: orbitalEntities) {
-                    static constexpr double gravConstant = 6.6743e-5;
                     glm::vec3 vecToOther = other.transform.getPosition() - transform.getPosition();
                     glm::vec3 vecToOtherNormal = glm::normalize(vecToOther);
 
                     float distanceSquared = glm::dot(vecToOther, vecToOther);
                     double acceleration = gravConstant * other.orbital.mass / distanceSquared;
                     double otherAcceleration = gravConstant * orbital.mass / distanceSquared;
-                    
-                    float collisionDistanceSquared = transform.getScale().x + other.transform.getScale().x;
-                    if (collisionDistanceSquared > distanceSquared){
-                        spdlog::error("planet-collision with entity: {} and {}", entity->getReferenceID(), other.entity->getReferenceID());
-                    }
 
                     // it is a lot easier to create stable orbits like this - not entirely sure why
                     // my assumption is this:
@@ -66,16 +183,66 @@ namespace components {
                 }
                 orbitalEntities.emplace_back(entity, transform, velocity, orbital);
             });
+            checkCollisions(orbitalEntities);
             for (const auto &queryEntry: orbitalEntities) {
                 registry.addOrSetComponent(queryEntry.entity, queryEntry.transform);
                 registry.addOrSetComponent(queryEntry.entity, queryEntry.velocity);
             }
         }
 
-    private:
+        /**
+         * Reports overlapping planets. Unlike the gravity, only close pairs have to be tested,
+         * so the candidates come from a sweep-and-prune broad phase.
+         */
+        static void checkCollisions(const std::pmr::vector<OrbitalQueryEntry> &orbitalEntities) {
+            // the planet meshes are unit spheres
+            auto getSphere = [&](size_t i) {
+                const components::Transform &transform = orbitalEntities[i].transform;
+                return math::HyperSphere<3, float>(transform.getPosition(), transform.getScale().x);
+            };
+            utils::SweepAndPrune<size_t, 3, float> broadPhase;
+            for (size_t i = 0; i < orbitalEntities.size(); ++i) {
+                broadPhase.add(math::AABB<3, float>(getSphere(i)), i);
+            }
+            for (const auto &[a, b]: broadPhase.findPairs()) {
+                if (math::collide(getSphere(a), getSphere(b))) {
+                    spdlog::error("planet-collision with entity: {} and {}", orbitalEntities[a].entity->getReferenceID(),
+                                  orbitalEntities[b].entity->getReferenceID());
+                }
+            }
+        }
+
+        /**
+         * Gathers positions and masses into arrays for the solvers from math/gravity.hpp and
+         * writes the new velocities back.
+         */
+        void executeGathered() {
+            utils::FrameArena &arena = utils::FrameArena::get();
+            std::pmr::vector<BodyEntry> bodies(&arena);
+            std::pmr::vector<glm::vec3> positions(&arena);
+            std::pmr::vector<float> masses(&arena);
+            registry.execute([&](const entity::EntityReference *entity, components::Transform transform, components::Velocity velocity,
+                                 components::OrbitalObject orbital) {
+                bodies.push_back({entity, velocity});
+                positions.push_back(transform.getPosition());
+                masses.push_back(static_cast<float>(orbital.mass));
+            });
+
+            std::pmr::vector<glm::vec3> accelerations(bodies.size(), &arena);
+            computeAccelerations(positions, masses, accelerations);
+
+            for (size_t i = 0; i < bodies.size(); ++i) {
+                bodies[i].velocity.velocity += accelerations[i] * static_cast<float>(deltaSeconds);
+                registry.addOrSetComponent(bodies[i].entity, bodies[i].velocity);
+            }
+        }
+
         entity::EntityRegistry &registry;
         double deltaSeconds;
         double deltaSecondsSquared;
+        GravitySolver solver;
+        float openingAngle;
+        float softening;
     };
 }
 
@@ -0,0 +1,81 @@
+﻿#ifndef ACAENGINE_PARTICLEEMITTER_H
+#define ACAENGINE_PARTICLEEMITTER_H
+
+#include <glm/glm.hpp>
+#include <span>
+#include <optional>
+#include <engine/entity/entityregistry.h>
+#include <engine/math/particlepool.hpp>
+#include <engine/utils/random.hpp>
+#include <engine/utils/threadpool.hpp>
+#include "transform.h"
+#include "velocity.h"
+
+namespace components {
+    /**
+     * Continuously emits particles into a ParticlePool, which is owned outside of the registry (e.g. by the game state).
+     * Offset and direction are local to the Transform of the entity. If the entity has a Velocity, it is inherited by the particles.
+     */
+    struct ParticleEmitter {
+    public:
+        ParticleEmitter() = default;
+
+        ParticleEmitter(math::ParticlePool<float> *_pool, float _rate, const glm::vec3 &_direction, float _speed, float _spread,
+                        float _lifetime, const glm::vec4 &_color, const glm::vec3 &_offset = glm::vec3(0.0f))
+                : pool(_pool), rate(_rate), direction(_direction), speed(_speed), spread(_spread), lifetime(_lifetime), color(_color), offset(_offset) {}
+
+        math::ParticlePool<float> *pool = nullptr;
+        /** particles per second, 0 pauses the emitter */
+        float rate = 0.0f;
+        glm::vec3 direction = glm::vec3(0.0f, 0.0f, 1.0f);
+        float speed = 0.0f;
+        /** maximum random velocity added in each axis */
+        float spread = 0.0f;
+        float lifetime = 1.0f;
+        glm::vec4 color = glm::vec4(1.0f);
+        glm::vec3 offset = glm::vec3(0.0f);
+        /** fraction of a particle carried over to the next tick */
+        float pending = 0.0f;
+    };
+
+    /**
+     * Lets all ParticleEmitters emit, then updates the given pools in parallel.
+     * Emitting uses utils::Random::get() and the pools keep their order, so the particles are deterministic.
+     */
+    class ParticleSystem {
+    public:
+        ParticleSystem(entity::EntityRegistry &_registry, std::span<math::ParticlePool<float> *const> _pools, double _deltaSeconds)
+                : registry(_registry), pools(_pools), deltaSeconds(_deltaSeconds) {}
+
+        void execute(utils::ThreadPool &threadPool = utils::ThreadPool::get()) {
+            registry.execute([this](const entity::EntityReference *entity, components::ParticleEmitter emitter, components::Transform transform) {
+                emitter.pending += emitter.rate * static_cast<float>(deltaSeconds);
+                const std::optional<components::Velocity> velocity = registry.getComponentData<components::Velocity>(entity);
+                const glm::vec3 position = transform.getPosition() + transform.getRotation() * emitter.offset;
+                const glm::vec3 baseVelocity = transform.getRotation() * emitter.direction * emitter.speed
+                                               + (velocity ? velocity->velocity : glm::vec3(0.0f));
+                utils::Random &random = utils::Random::get();
+                for (; emitter.pending >= 1.0f; emitter.pending -= 1.0f) {
+                    const glm::vec3 jitter(random.uniformFloat(-emitter.spread, emitter.spread),
+                                           random.uniformFloat(-emitter.spread, emitter.spread),
+                                           random.uniformFloat(-emitter.spread, emitter.spread));
+                    emitter.pool->emit(position, baseVelocity + jitter, emitter.lifetime, emitter.color);
+                }
+                registry.addOrSetComponent(entity, emitter);
+            });
+
+            threadPool.parallelFor(0, pools.size(), [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    pools[i]->update(static_cast<float>(deltaSeconds));
+                }
+            });
+        }
+
+    private:
+        entity::EntityRegistry &registry;
+        std::span<math::ParticlePool<float> *const> pools;
+        double deltaSeconds;
+    };
+}
+
+#endif //ACAENGINE_PARTICLEEMITTER_H
@@ -0,0 +1,167 @@
+﻿#ifndef ACAENGINE_RIGIDBODY_H
+#define ACAENGINE_RIGIDBODY_H
+
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <span>
+#include <vector>
+#include <limits>
+#include <memory_resource>
+#include <unordered_map>
+#include <engine/entity/entityregistry.h>
+#include <engine/utils/framearena.hpp>
+#include <engine/math/contactsolver.hpp>
+#include "transform.h"
+#include "velocity.h"
+#include "RotationalVelocity.h"
+
+namespace components {
+    /**
+     * Mass properties and surface of an entity that reacts to contacts.
+     * The center of mass is the position of the Transform.
+     * Entities without a RotationalVelocity do not rotate on contacts.
+     */
+    struct RigidBody {
+    public:
+        RigidBody() = default;
+
+        /**
+         * Solid sphere.
+         */
+        static RigidBody sphere(float mass, float radius, float friction = 0.5f, float restitution = 0.0f) {
+            const float inertia = 0.4f * mass * radius * radius;
+            return RigidBody(1.0f / mass, glm::vec3(1.0f / inertia), friction, restitution);
+        }
+
+        /**
+         * Solid box with the given half extents along the local axes.
+         */
+        static RigidBody box(float mass, const glm::vec3 &halfSize, float friction = 0.5f, float restitution = 0.0f) {
+            const glm::vec3 sizeSq = 4.0f * halfSize * halfSize;
+            const glm::vec3 inertia = mass / 12.0f * glm::vec3(sizeSq.y + sizeSq.z, sizeSq.x + sizeSq.z, sizeSq.x + sizeSq.y);
+            return RigidBody(1.0f / mass, 1.0f / inertia, friction, restitution);
+        }
+
+        /**
+         * Infinite mass, e.g. the ground. It is not moved by contacts.
+         */
+        static RigidBody fixed(float friction = 0.5f, float restitution = 0.0f) {
+            return RigidBody(0.0f, glm::vec3(0.0f), friction, restitution);
+        }
+
+        float inverseMass = 0.0f;
+        /** diagonal of the inverse inertia tensor in local space */
+        glm::vec3 inverseInertia = glm::vec3(0.0f);
+        float friction = 0.5f;
+        float restitution = 0.0f;
+
+    private:
+        RigidBody(float _inverseMass, const glm::vec3 &_inverseInertia, float _friction, float _restitution)
+                : inverseMass(_inverseMass), inverseInertia(_inverseInertia), friction(_friction), restitution(_restitution) {}
+    };
+
+    /**
+     * Contact between two entities from the narrow phase, the normal points from entityA to entityB.
+     * entityB may be nullptr for a contact with the static world, e.g. a wall.
+     */
+    struct EntityContact {
+        const entity::EntityReference *entityA;
+        const entity::EntityReference *entityB;
+        math::Contact<3, float> contact;
+    };
+
+    /**
+     * Resolves contacts by changing the Velocity and RotationalVelocity of the entities with a RigidBody.
+     * Entities without a RigidBody act like fixed bodies.
+     * The positions are integrated afterwards by ApplyVelocitySystem and ApplyRotationalVelocitySystem.
+     * The solver keeps the impulses for warm starting, so it has to live as long as the simulation.
+     */
+    class RigidBodySystem {
+    public:
+        RigidBodySystem(entity::EntityRegistry &_registry, math::ContactSolver<float> &_solver, double _deltaSeconds)
+                : registry(_registry), solver(_solver), deltaSeconds(_deltaSeconds) {}
+
+        void solve(std::span<const EntityContact> contacts) {
+            utils::FrameArena &arena = utils::FrameArena::get();
+            std::pmr::vector<math::SolverBody<float>> bodies(&arena);
+            std::pmr::vector<const entity::EntityReference *> bodyEntities(&arena);
+            std::pmr::vector<std::pair<uint32_t, uint32_t>> pairs(&arena);
+            std::pmr::vector<math::Contact<3, float>> solverContacts(&arena);
+            std::pmr::unordered_map<const entity::EntityReference *, uint32_t> bodyIndices(&arena);
+
+            // bodies are numbered in the order of the contacts, so that the solve is deterministic
+            auto getBody = [&](const entity::EntityReference *entity) {
+                const auto [it, inserted] = bodyIndices.try_emplace(entity, static_cast<uint32_t>(bodies.size()));
+                if (inserted) {
+                    bodies.push_back(gatherBody(entity));
+                    bodyEntities.push_back(entity);
+                }
+                return it->second;
+            };
+
+            for (const EntityContact &entityContact: contacts) {
+                pairs.emplace_back(getBody(entityContact.entityA), getBody(entityContact.entityB));
+                solverContacts.push_back(entityContact.contact);
+                solverContacts.back().pair = static_cast<uint32_t>(pairs.size() - 1);
+            }
+
+            solver.solve(bodies, pairs, solverContacts, static_cast<float>(deltaSeconds));
+
+            for (size_t i = 0; i < bodies.size(); ++i) {
+                if (bodies[i].isStatic()) {
+                    continue;
+                }
+                const entity::EntityReference *entity = bodyEntities[i];
+                registry.addOrSetComponent(entity, components::Velocity(bodies[i].velocity));
+                if (registry.getComponentData<components::RotationalVelocity>(entity).has_value()) {
+                    const glm::quat rotation = registry.getComponentData<components::Transform>(entity).value().getRotation();
+                    registry.addOrSetComponent(entity, components::RotationalVelocity(glm::inverse(rotation) * bodies[i].angularVelocity));
+                }
+            }
+        }
+
+    private:
+        entity::EntityRegistry &registry;
+        math::ContactSolver<float> &solver;
+        double deltaSeconds;
+
+        math::SolverBody<float> gatherBody(const entity::EntityReference *entity) const {
+            math::SolverBody<float> body;
+            body.id = std::numeric_limits<uint32_t>::max(); // the static world
+            if (!entity) {
+                return body;
+            }
+
+            // the reference id changes if other entities are erased, which only costs the warm start of one tick
+            body.id = static_cast<uint32_t>(entity->getReferenceID());
+            const std::optional<components::Transform> transform = registry.getComponentData<components::Transform>(entity);
+            const std::optional<components::Velocity> velocity = registry.getComponentData<components::Velocity>(entity);
+            const std::optional<components::RigidBody> rigidBody = registry.getComponentData<components::RigidBody>(entity);
+            if (transform) {
+                body.position = transform->getPosition();
+            }
+            if (rigidBody) {
+                body.friction = rigidBody->friction;
+                body.restitution = rigidBody->restitution;
+            }
+            if (!transform || !velocity || !rigidBody) {
+                return body;
+            }
+
+            body.velocity = velocity->velocity;
+            body.inverseMass = rigidBody->inverseMass;
+            // RotationalVelocity is applied in local space, the solver works in world space
+            const std::optional<components::RotationalVelocity> rotVelocity = registry.getComponentData<components::RotationalVelocity>(entity);
+            if (rotVelocity) {
+                const glm::mat3 rotation = glm::toMat3(transform->getRotation());
+                body.angularVelocity = rotation * rotVelocity->eulerAngleVelocity;
+                body.inverseInertia = rotation * glm::mat3(glm::vec3(rigidBody->inverseInertia.x, 0.0f, 0.0f),
+                                                                 glm::vec3(0.0f, rigidBody->inverseInertia.y, 0.0f),
+                                                                 glm::vec3(0.0f, 0.0f, rigidBody->inverseInertia.z)) * glm::transpose(rotation);
+            }
+            return body;
+        }
+    };
+}
+
+#endif //ACAENGINE_RIGIDBODY_H
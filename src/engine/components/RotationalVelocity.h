@@ -21,16 +21,28 @@ namespace components {
     };
 
     class ApplyRotationalVelocitySystem {
+    private:
+        auto action() {
+            return [this](const entity::EntityReference *entity, components::Transform transform, components::RotationalVelocity rotVelocity) {
+                rotVelocity.applyRotation(transform, deltaSeconds, deltaSecondsSquared);
+                registry.addOrSetComponent(entity, transform);
+            };
+        }
+
     public:
         ApplyRotationalVelocitySystem(entity::EntityRegistry &_registry, double _deltaSeconds, double _deltaSecondsSquared)
                 : registry(_registry), deltaSeconds(_deltaSeconds), deltaSecondsSquared(_deltaSecondsSquared) {}
 
         void execute() {
-            registry.execute([this]
-                                     (const entity::EntityReference *entity, components::Transform transform, components::RotationalVelocity rotVelocity) {
-                rotVelocity.applyRotation(transform, deltaSeconds, deltaSecondsSquared);
-                registry.addOrSetComponent(entity, transform);
-            });
+            registry.execute(action());
+        }
+
+        /**
+         * Skips entities that have any of the components T_Excluded, e.g. Sleeping.
+         */
+        template<typename ...T_Excluded>
+        void executeExcluding() {
+            registry.executeExcluding<T_Excluded...>(action());
         }
 
     private:
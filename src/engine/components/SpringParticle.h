@@ -0,0 +1,64 @@
+﻿#ifndef ACAENGINE_SPRINGPARTICLE_H
+#define ACAENGINE_SPRINGPARTICLE_H
+
+#include <glm/glm.hpp>
+#include <span>
+#include <engine/entity/entityregistry.h>
+#include <engine/math/springnetwork.hpp>
+#include <engine/utils/threadpool.hpp>
+#include "transform.h"
+
+namespace components {
+    /**
+     * Attaches an entity to a particle of a SpringNetwork, which is owned outside of the registry (e.g. by the game state).
+     * The Transform follows the particle. For pinned particles it is the other way around: the particle follows the Transform,
+     * so that a network can hang from a moving object.
+     */
+    struct SpringParticle {
+    public:
+        SpringParticle() = default;
+
+        SpringParticle(math::SpringNetwork<float> *_network, uint32_t _particle) : network(_network), particle(_particle) {}
+
+        math::SpringNetwork<float> *network = nullptr;
+        uint32_t particle = 0;
+    };
+
+    /**
+     * Steps the given networks in parallel and synchronizes them with the Transforms of the attached entities.
+     * Each network is stepped by a single thread, so the result does not depend on the number of threads.
+     */
+    class SpringNetworkSystem {
+    public:
+        SpringNetworkSystem(entity::EntityRegistry &_registry, std::span<math::SpringNetwork<float> *const> _networks, double _deltaSeconds)
+                : registry(_registry), networks(_networks), deltaSeconds(_deltaSeconds) {}
+
+        void execute(utils::ThreadPool &threadPool = utils::ThreadPool::get()) {
+            registry.execute([](components::SpringParticle springParticle, components::Transform transform) {
+                if (springParticle.network->isPinned(springParticle.particle)) {
+                    springParticle.network->setPosition(springParticle.particle, transform.getPosition());
+                }
+            });
+
+            threadPool.parallelFor(0, networks.size(), [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    networks[i]->step(static_cast<float>(deltaSeconds));
+                }
+            });
+
+            registry.execute([this](const entity::EntityReference *entity, components::SpringParticle springParticle, components::Transform transform) {
+                if (!springParticle.network->isPinned(springParticle.particle)) {
+                    transform.setPosition(springParticle.network->positions()[springParticle.particle]);
+                    registry.addOrSetComponent(entity, transform);
+                }
+            });
+        }
+
+    private:
+        entity::EntityRegistry &registry;
+        std::span<math::SpringNetwork<float> *const> networks;
+        double deltaSeconds;
+    };
+}
+
+#endif //ACAENGINE_SPRINGPARTICLE_H
@@ -0,0 +1,120 @@
+﻿#ifndef ACAENGINE_SLEEP_H
+#define ACAENGINE_SLEEP_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory_resource>
+#include <engine/entity/entityregistry.h>
+#include <engine/utils/framearena.hpp>
+#include "velocity.h"
+#include "RotationalVelocity.h"
+
+namespace components {
+    /**
+     * Opt-in for the SleepSystem. Counts the consecutive ticks the entity has been at rest.
+     * Force systems add the acceleration they computed for the entity, also while it sleeps and the acceleration is not applied.
+     * The SleepSystem consumes it once per tick.
+     */
+    struct Sleepable {
+        int ticksAtRest = 0;
+        glm::vec3 acceleration = glm::vec3(0.0f);
+    };
+
+    /**
+     * Tag of entities that are asleep.
+     * Systems skip them with executeExcluding<Sleeping>(), e.g. ApplyVelocitySystem or the broad phase.
+     */
+    struct Sleeping {
+    };
+
+    /**
+     * Puts Sleepable entities to sleep once their Velocity (and RotationalVelocity, if present) and the velocity change of their
+     * accumulated acceleration (|a| * deltaSeconds) stayed below the thresholds for ticksUntilSleep ticks.
+     * Their velocities are zeroed, so that they do not drift.
+     * Sleeping entities are woken if their Velocity is written above the threshold, if the accumulated acceleration grows above it,
+     * e.g. when the pull of another body increases, or explicitly with wake(), e.g. on a contact.
+     * Run this once per tick before the integration systems.
+     */
+    class SleepSystem {
+    public:
+        SleepSystem(entity::EntityRegistry &_registry, double _deltaSeconds, float _linearThreshold = 0.05f, float _angularThreshold = 0.05f,
+                    int _ticksUntilSleep = 60)
+                : registry(_registry), deltaSeconds(_deltaSeconds), linearThreshold(_linearThreshold), angularThreshold(_angularThreshold),
+                  ticksUntilSleep(_ticksUntilSleep) {}
+
+        void execute() {
+            utils::FrameArena &arena = utils::FrameArena::get();
+            // components are only changed after the iteration, so that the visited sets are not modified
+            std::pmr::vector<const entity::EntityReference *> fallingAsleep(&arena);
+            std::pmr::vector<const entity::EntityReference *> wakingUp(&arena);
+
+            registry.executeExcluding<Sleeping>([&](const entity::EntityReference *entity, components::Velocity velocity, components::Sleepable sleepable) {
+                if (isResting(entity, velocity, sleepable)) {
+                    sleepable.ticksAtRest++;
+                    if (sleepable.ticksAtRest >= ticksUntilSleep) {
+                        fallingAsleep.push_back(entity);
+                    }
+                } else {
+                    sleepable.ticksAtRest = 0;
+                }
+                sleepable.acceleration = glm::vec3(0.0f);
+                registry.addOrSetComponent(entity, sleepable);
+            });
+            registry.execute([&](const entity::EntityReference *entity, components::Velocity velocity, components::Sleepable sleepable,
+                                 components::Sleeping) {
+                if (!isResting(entity, velocity, sleepable)) {
+                    wakingUp.push_back(entity);
+                }
+                sleepable.acceleration = glm::vec3(0.0f);
+                registry.addOrSetComponent(entity, sleepable);
+            });
+
+            for (const entity::EntityReference *entity: fallingAsleep) {
+                registry.addOrSetComponent(entity, components::Velocity(glm::vec3(0.0f)));
+                if (registry.getComponentData<components::RotationalVelocity>(entity).has_value()) {
+                    registry.addOrSetComponent(entity, components::RotationalVelocity(glm::vec3(0.0f)));
+                }
+                registry.addOrSetComponent(entity, components::Sleeping());
+            }
+            for (const entity::EntityReference *entity: wakingUp) {
+                wake(registry, entity);
+            }
+        }
+
+        /**
+         * Wakes the entity up, it has to rest for ticksUntilSleep ticks again before it falls asleep.
+         */
+        static void wake(entity::EntityRegistry &registry, const entity::EntityReference *entity) {
+            registry.removeComponent<components::Sleeping>(entity);
+            if (registry.getComponentData<components::Sleepable>(entity).has_value()) {
+                registry.addOrSetComponent(entity, components::Sleepable());
+            }
+        }
+
+        static bool isSleeping(const entity::EntityRegistry &registry, const entity::EntityReference *entity) {
+            return registry.getComponentData<components::Sleeping>(entity).has_value();
+        }
+
+    private:
+        entity::EntityRegistry &registry;
+        double deltaSeconds;
+        float linearThreshold;
+        float angularThreshold;
+        int ticksUntilSleep;
+
+        bool isResting(const entity::EntityReference *entity, const components::Velocity &velocity, const components::Sleepable &sleepable) const {
+            if (glm::dot(velocity.velocity, velocity.velocity) >= linearThreshold * linearThreshold) {
+                return false;
+            }
+            const glm::vec3 velocityChange = sleepable.acceleration * static_cast<float>(deltaSeconds);
+            if (glm::dot(velocityChange, velocityChange) >= linearThreshold * linearThreshold) {
+                return false;
+            }
+            const std::optional<components::RotationalVelocity> rotVelocity = registry.getComponentData<components::RotationalVelocity>(entity);
+            return !rotVelocity.has_value()
+                   || glm::dot(rotVelocity->eulerAngleVelocity, rotVelocity->eulerAngleVelocity) < angularThreshold * angularThreshold;
+        }
+    };
+}
+
+#endif //ACAENGINE_SLEEP_H
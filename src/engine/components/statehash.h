@@ -0,0 +1,44 @@
+﻿#ifndef ACAENGINE_STATEHASH_H
+#define ACAENGINE_STATEHASH_H
+
+#include <engine/entity/entityregistry.h>
+#include <engine/utils/statehash.hpp>
+#include "transform.h"
+#include "velocity.h"
+#include "RotationalVelocity.h"
+
+namespace components {
+    /**
+     * Hashes the simulated state of all entities: Transform, Velocity and RotationalVelocity.
+     * The entities are visited in registry order, so the hash is only comparable between runs with a stable order,
+     * see EntityRegistry::setStableOrder().
+     */
+    class StateHashSystem {
+    public:
+        explicit StateHashSystem(entity::EntityRegistry &_registry) : registry(_registry) {}
+
+        uint64_t execute() {
+            utils::StateHash hash;
+            registry.execute([&hash](const entity::EntityReference *entity, components::Transform transform) {
+                hash.add(entity->getReferenceID());
+                hash.add(transform.getPosition());
+                hash.add(transform.getRotation());
+                hash.add(transform.getScale());
+            });
+            registry.execute([&hash](const entity::EntityReference *entity, components::Velocity velocity) {
+                hash.add(entity->getReferenceID());
+                hash.add(velocity.velocity);
+            });
+            registry.execute([&hash](const entity::EntityReference *entity, components::RotationalVelocity rotVelocity) {
+                hash.add(entity->getReferenceID());
+                hash.add(rotVelocity.eulerAngleVelocity);
+            });
+            return hash.value();
+        }
+
+    private:
+        entity::EntityRegistry &registry;
+    };
+}
+
+#endif //ACAENGINE_STATEHASH_H
@@ -4,6 +4,11 @@
 #include <glm/glm.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <vector>
+#include <memory_resource>
+#include <span>
+#include <engine/entity/entityregistry.h>
+#include <engine/utils/framearena.hpp>
 
 namespace components {
 
@@ -12,6 +17,10 @@ namespace components {
      * 
      * Changes to this transform should be made during the update tick.
      * Changes are then managed and cached during the draw tick.
+     *
+     * The setters only mark the matrix as outdated, so that an object which is moved, rotated and scaled in one tick
+     * composes its matrix once. ComposeTransformSystem composes all outdated matrices in one pass,
+     * otherwise getTransformMatrix() composes it on demand.
      */
     class Transform {
 
@@ -50,9 +59,17 @@ namespace components {
         }
 
         [[nodiscard]] const glm::mat4 &getTransformMatrix() const {
+            if (matrixOutdated) {
+                transformMatrix = glm::translate(glm::identity<glm::mat4>(), _position) * glm::toMat4(_rotation) * glm::scale(glm::identity<glm::mat4>(), _scale);
+                matrixOutdated = false;
+            }
             return transformMatrix;
         }
 
+        [[nodiscard]] bool isMatrixOutdated() const {
+            return matrixOutdated;
+        }
+
         [[nodiscard]] bool hasTransformChanged() const {
             return transformChanged;
         }
@@ -65,8 +82,10 @@ namespace components {
         }
 
     private:
+        friend class ComposeTransformSystem;
+
         void updateTransformMatrix() {
-            transformMatrix = glm::translate(glm::identity<glm::mat4>(), _position) * glm::toMat4(_rotation) * glm::scale(glm::identity<glm::mat4>(), _scale);
+            matrixOutdated = true;
             transformChanged = true;
         }
 
@@ -74,9 +93,113 @@ namespace components {
         glm::quat _rotation;
         glm::vec3 _scale;
 
-        glm::mat4 transformMatrix;
+        mutable glm::mat4 transformMatrix;
+        mutable bool matrixOutdated = false;
         bool transformChanged = false;
     };
+
+    /**
+     * Composes the matrices of all Transforms which changed since their matrix was last composed.
+     * Run it once per tick after all systems that move objects and before anything reads the matrices,
+     * e.g. collider bounds or MeshRenderer::update. Copies of a Transform compose their matrix on demand,
+     * but the result is lost with the copy.
+     * Only position, rotation and scale of the outdated transforms are gathered into one array per coordinate,
+     * so that the composition loop vectorizes. The matrices are written back into the registry in place.
+     */
+    class ComposeTransformSystem {
+    public:
+        explicit ComposeTransformSystem(entity::EntityRegistry &_registry) : registry(_registry) {}
+
+        void execute() {
+            utils::FrameArena &arena = utils::FrameArena::get();
+            std::pmr::vector<Transform *> outdated(&arena);
+            registry.modifyComponents<Transform>([&](Transform &transform) {
+                if (transform.matrixOutdated) {
+                    outdated.push_back(&transform);
+                }
+            });
+
+            const size_t count = outdated.size();
+            if (count == 0) {
+                return;
+            }
+            std::pmr::vector<float> components(10 * count, &arena);
+            for (size_t i = 0; i < count; ++i) {
+                gather(*outdated[i], components.data(), i, count);
+            }
+            std::pmr::vector<glm::mat4> matrices(count, &arena);
+            compose(components.data(), count, matrices.data());
+            for (size_t i = 0; i < count; ++i) {
+                outdated[i]->transformMatrix = matrices[i];
+                outdated[i]->matrixOutdated = false;
+            }
+        }
+
+        /**
+         * Same result as Transform::getTransformMatrix() for each transform.
+         */
+        static void composeMatrices(std::span<const Transform> transforms, std::span<glm::mat4> matrices) {
+            const size_t count = transforms.size();
+            if (count == 0) {
+                return;
+            }
+            std::pmr::vector<float> components(10 * count, &utils::FrameArena::get());
+            for (size_t i = 0; i < count; ++i) {
+                gather(transforms[i], components.data(), i, count);
+            }
+            compose(components.data(), count, matrices.data());
+        }
+
+    private:
+        /**
+         * Stores position, rotation (x, y, z, w) and scale of the i-th transform, one array of count floats each.
+         */
+        static void gather(const Transform &transform, float *components, size_t i, size_t count) {
+            components[i] = transform._position.x;
+            components[count + i] = transform._position.y;
+            components[2 * count + i] = transform._position.z;
+            components[3 * count + i] = transform._rotation.x;
+            components[4 * count + i] = transform._rotation.y;
+            components[5 * count + i] = transform._rotation.z;
+            components[6 * count + i] = transform._rotation.w;
+            components[7 * count + i] = transform._scale.x;
+            components[8 * count + i] = transform._scale.y;
+            components[9 * count + i] = transform._scale.z;
+        }
+
+        static void compose(const float *components, size_t count, glm::mat4 *matrices) {
+            const float *px = components, *py = px + count, *pz = py + count;
+            const float *qx = pz + count, *qy = qx + count, *qz = qy + count, *qw = qz + count;
+            const float *sx = qw + count, *sy = sx + count, *sz = sy + count;
+
+            // translate * rotate * scale, the rotation is the matrix of a unit quaternion like glm::toMat4
+            float *out = &matrices[0][0][0];
+            for (size_t i = 0; i < count; ++i) {
+                const float xx = qx[i] * qx[i], yy = qy[i] * qy[i], zz = qz[i] * qz[i];
+                const float xy = qx[i] * qy[i], xz = qx[i] * qz[i], yz = qy[i] * qz[i];
+                const float wx = qw[i] * qx[i], wy = qw[i] * qy[i], wz = qw[i] * qz[i];
+                float *m = out + i * 16;
+                m[0] = (1.0f - 2.0f * (yy + zz)) * sx[i];
+                m[1] = 2.0f * (xy + wz) * sx[i];
+                m[2] = 2.0f * (xz - wy) * sx[i];
+                m[3] = 0.0f;
+                m[4] = 2.0f * (xy - wz) * sy[i];
+                m[5] = (1.0f - 2.0f * (xx + zz)) * sy[i];
+                m[6] = 2.0f * (yz + wx) * sy[i];
+                m[7] = 0.0f;
+                m[8] = 2.0f * (xz + wy) * sz[i];
+                m[9] = 2.0f * (yz - wx) * sz[i];
+                m[10] = (1.0f - 2.0f * (xx + yy)) * sz[i];
+                m[11] = 0.0f;
+                m[12] = px[i];
+                m[13] = py[i];
+                m[14] = pz[i];
+                m[15] = 1.0f;
+            }
+        }
+
+        entity::EntityRegistry &registry;
+    };
 }
 
 #endif //ACAENGINE_TRANSFORM_H
@@ -31,16 +31,28 @@ namespace components {
     };
 
     class ApplyVelocitySystem {
+    private:
+        auto action() {
+            return [this](const entity::EntityReference *entity, components::Transform transform, components::Velocity velocity) {
+                velocity.applyVelocity(transform, deltaSeconds, deltaSecondsSquared);
+                registry.addOrSetComponent(entity, transform);
+            };
+        }
+
     public:
         ApplyVelocitySystem(entity::EntityRegistry &_registry, double _deltaSeconds, double _deltaSecondsSquared)
                 : registry(_registry), deltaSeconds(_deltaSeconds), deltaSecondsSquared(_deltaSecondsSquared) {}
 
         void execute() {
-            registry.execute([this]
-                                     (const entity::EntityReference *entity, components::Transform transform, components::Velocity velocity) {
-                velocity.applyVelocity(transform, deltaSeconds, deltaSecondsSquared);
-                registry.addOrSetComponent(entity, transform);
-            });
+            registry.execute(action());
+        }
+
+        /**
+         * Skips entities that have any of the components T_Excluded, e.g. because another system already integrates their positions.
+         */
+        template<typename ...T_Excluded>
+        void executeExcluding() {
+            registry.executeExcluding<T_Excluded...>(action());
         }
 
     private:
@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include "entityreference.h"
 #include <engine/utils/assert.hpp>
+#include <engine/utils/containers/hierarchicalbitset.hpp>
 
 namespace entity {
     class ComponentRegistry {
@@ -50,6 +51,8 @@ namespace entity {
             // copy componentData to componentsBytes
             *reinterpret_cast<T_component *>(componentsBytes.data() + dataSize + intByteSize) = componentData;
 
+            entityIDs.set(entityID);
+
             int componentID = componentCount;
             componentCount++;
             return componentID;
@@ -61,7 +64,10 @@ namespace entity {
          * @param newEntityID new value of the EntityID
          */
         void setEntityID(int componentID, int newEntityID) {
-            *reinterpret_cast<int *>(componentsBytes.data() + (componentID * (intByteSize + componentByteSize))) = newEntityID;
+            int &entityID = *reinterpret_cast<int *>(componentsBytes.data() + (componentID * (intByteSize + componentByteSize)));
+            entityIDs.reset(entityID);
+            entityIDs.set(newEntityID);
+            entityID = newEntityID;
         }
 
         /**
@@ -83,6 +89,7 @@ namespace entity {
          */
         void removeComponent(int componentId, int &movedEntityID, int &movedComponentID) {
             const auto removeComponent_begin = componentsBytes.begin() + (componentId * (intByteSize + componentByteSize));
+            entityIDs.reset(*reinterpret_cast<const int *>(std::addressof(*removeComponent_begin)));
             if (componentId == componentCount - 1) { // removing last component requires no moves
                 componentsBytes.erase(removeComponent_begin, componentsBytes.end());
             } else {
@@ -119,6 +126,26 @@ namespace entity {
             return result;
         }
 
+        /**
+         * Call action(component) with a reference to each stored component, so that it is modified in place.
+         * Components must not be added to or removed from this registry during the call.
+         * @tparam T_component Type of the stored Components
+         */
+        template<typename T_component, typename Action>
+        void forEachComponent(const Action &action) {
+            const int stride = intByteSize + componentByteSize;
+            for (int componentID = 0; componentID < componentCount; componentID++) {
+                action(*reinterpret_cast<T_component *>(componentsBytes.data() + (componentID * stride) + intByteSize));
+            }
+        }
+
+        /**
+         * @return The set of EntityIDs which have a component in this registry.
+         */
+        [[nodiscard]] const utils::HierarchicalBitSet &getEntityIDs() const {
+            return entityIDs;
+        }
+
     private:
         void checkComponentSize(const int byteSize) {
             if (componentByteSize >= 0) {
@@ -132,6 +159,7 @@ namespace entity {
         int componentCount = 0;
         int componentByteSize = -1; // size of the component stored in this registry, assigned when the first component is added
         std::vector<std::byte> componentsBytes = {}; // contains a sequence of {entityReferenceID, component} pairs, e.g. {id,data,id,data,...,id,data}
+        utils::HierarchicalBitSet entityIDs = {}; // one bit per entity that has a component in this registry
     };
 }
 
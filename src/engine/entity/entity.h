@@ -2,6 +2,7 @@
 #define ACAENGINE_ENTITY_H
 
 #include <vector>
+#include <span>
 #include <unordered_map>
 #include <typeindex>
 #include <algorithm>
@@ -13,7 +14,7 @@ namespace entity {
          */
         std::unordered_map<std::type_index, int> componentMap = {};
 
-        [[nodiscard]] bool containsAllComponents(const std::vector<std::type_index> &types) const {
+        [[nodiscard]] bool containsAllComponents(std::span<const std::type_index> types) const {
             return std::all_of(types.begin(), types.end(), [this](const std::type_index &type) { return componentMap.find(type) != componentMap.end(); });
         }
     };
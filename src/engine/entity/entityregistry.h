@@ -2,6 +2,8 @@
 #define ACAENGINE_ENTITYREGISTRY_H
 
 #include <vector>
+#include <array>
+#include <span>
 #include <optional>
 #include <utility>
 #include <typeindex>
@@ -78,19 +80,41 @@ namespace entity {
             // update entity list
             if (refID == entities.size() - 1) {
                 entities.pop_back();
-            } else { // move last entry into open slot
-                EntityDataPair lastDataPair = entities.back();
-                const auto refIterator = entities.begin() + refID;
-                lastDataPair.first->updateReferenceID(refID);
-                for (const auto &idxToComponentEntry: lastDataPair.second.componentMap) {
-                    ComponentRegistry *registry = ComponentRegistry::getInstance(idxToComponentEntry.first);
-                    registry->setEntityID(idxToComponentEntry.second, refID);
+            } else if (stableOrder) { // shift all following entries
+                for (int id = refID + 1; id < (int) entities.size(); id++) {
+                    moveEntity(id, id - 1);
                 }
-                *refIterator = lastDataPair;
+                entities.erase(entities.begin() + refID);
+            } else { // move last entry into open slot
+                moveEntity((int) entities.size() - 1, refID);
+                entities[refID] = entities.back();
                 entities.pop_back();
             }
         }
 
+        /**
+         * Calls action(T_component &) for every component of this type, the changes are stored in place.
+         * Unlike execute() this copies no components, but the action only gets one component type and no Entity.
+         * Components of this type must not be added or removed during the call.
+         */
+        template<typename T_component, typename Action>
+        void modifyComponents(const Action &action) {
+            ComponentRegistry::getInstance(std::type_index(typeid(T_component)))->template forEachComponent<T_component>(action);
+        }
+
+        /**
+         * By default, erasing an Entity moves the last Entity into the open slot, which changes the order in which execute() visits them.
+         * With a stable order, all following Entities are shifted instead, so execute() visits the Entities in the order they were created.
+         * This costs O(n) per erase and is meant for deterministic simulations.
+         */
+        void setStableOrder(bool stable) {
+            stableOrder = stable;
+        }
+
+        [[nodiscard]] bool hasStableOrder() const {
+            return stableOrder;
+        }
+
         /**
          * Retrieve stored data for an Entity.
          * @param reference Reference of the Entity to look up
@@ -221,73 +245,97 @@ namespace entity {
          */
         template<typename Action>
         void execute(const Action &action) {
-            _execute(action, &Action::operator());
+            _execute(action, {}, &Action::operator());
         }
 
         template<typename ...Args>
         void execute(void(*action)(Args...)) {
-            _execute<Args...>(action);
+            _execute<Args...>(action, {});
+        }
+
+        /**
+         * Same as execute, but skips all entities that have any of the components T_Excluded.
+         * @tparam T_Excluded ComponentTypes of the entities to skip
+         */
+        template<typename ...T_Excluded, typename Action>
+        void executeExcluding(const Action &action) {
+            const std::array<std::type_index, sizeof...(T_Excluded)> excludedIndices = utils::getTypeIndices<T_Excluded...>();
+            std::array<const utils::HierarchicalBitSet *, sizeof...(T_Excluded)> excludedSets = {};
+            for (std::size_t i = 0; i < excludedIndices.size(); i++) {
+                excludedSets[i] = &ComponentRegistry::getInstance(excludedIndices[i])->getEntityIDs();
+            }
+            _execute(action, excludedSets, &Action::operator());
         }
 
     private:
+        typedef std::span<const utils::HierarchicalBitSet *const> EntitySets;
+
         // gathers argument types of Action and forwards them to _execute2
         template<typename Action, typename Functor, typename ...Args>
-        void _execute(Action &&action, void(Functor::*)(Args...) const) {
-            _execute2<Action, Args...>(std::forward<Action>(action));
+        void _execute(Action &&action, EntitySets excludedSets, void(Functor::*)(Args...) const) {
+            _execute2<Action, Args...>(std::forward<Action>(action), excludedSets);
         }
 
         // gathers argument types of Action and forwards them to _execute2
         template<typename Action, typename Functor, typename ...Args>
-        void _execute(Action &&action, void(Functor::*)(Args...)) {
-            _execute2<Action, Args...>(std::forward<Action>(action));
+        void _execute(Action &&action, EntitySets excludedSets, void(Functor::*)(Args...)) {
+            _execute2<Action, Args...>(std::forward<Action>(action), excludedSets);
         }
 
         template<typename ...Args, typename Action>
-        void _execute(Action &&action) {
-            _execute2<Action, Args...>(std::forward<Action>(action));
+        void _execute(Action &&action, EntitySets excludedSets) {
+            _execute2<Action, Args...>(std::forward<Action>(action), excludedSets);
         }
 
         template<typename Action, typename Arg1, typename ...Args>
-        void _execute2(Action &&action) {
+        void _execute2(Action &&action, EntitySets excludedSets) {
             constexpr bool ProvideEntity = std::is_same<Arg1, const entity::EntityReference *>::value;
             constexpr std::size_t ComponentCount = ([]() { if constexpr(ProvideEntity) { return sizeof...(Args); } else { return sizeof ...(Args) + 1; }})();
 
-            std::vector<std::type_index> typeIndices = {};
-            if constexpr(ProvideEntity) {
-                utils::gatherTypeIDs<Args...>(typeIndices);
-            } else {
-                utils::gatherTypeIDs<Arg1, Args...>(typeIndices);
-            }
-
-            ASSERT(!typeIndices.empty(), "specified Action takes no parameters!");
-            ASSERT(typeIndices.size() == ComponentCount, "failed to deduce Component-Types for Action!");
+            static_assert(ComponentCount > 0, "specified Action takes no parameters!");
+            const std::array<std::type_index, ComponentCount> typeIndices = ([]() {
+                if constexpr(ProvideEntity) {
+                    return utils::getTypeIndices<Args...>();
+                } else {
+                    return utils::getTypeIndices<Arg1, Args...>();
+                }
+            })();
+            const std::array<ComponentRegistry *, ComponentCount> registries = getRegistries(typeIndices, std::make_index_sequence<ComponentCount>{});
 
-            // TODO find component with lowest proportion -> only consider entities contained in that component-Registry
+            // only visit entities that are contained in all component-Registries
+            std::array<const utils::HierarchicalBitSet *, ComponentCount> entitySets = {};
+            for (std::size_t i = 0; i < ComponentCount; i++) {
+                entitySets[i] = &registries[i]->getEntityIDs();
+            }
 
-            for (const auto &entityDataPair: entities) {
-                if (!entityDataPair.second.containsAllComponents(typeIndices)) {
-                    continue;
-                }
+            utils::HierarchicalBitSet::forEachIntersection(entitySets, excludedSets, [&](uint32_t entityID) {
+                const EntityDataPair &entityDataPair = entities[entityID];
                 if constexpr(ProvideEntity) {
-                    _executeWithEntity<Args...>(std::forward<Action>(action), typeIndices, entityDataPair, std::make_index_sequence<ComponentCount>{});
+                    _executeWithEntity<Args...>(std::forward<Action>(action), typeIndices, registries, entityDataPair,
+                                                std::make_index_sequence<ComponentCount>{});
                 } else {
-                    _executeComponentsOnly<Arg1, Args...>(std::forward<Action>(action), typeIndices, entityDataPair,
+                    _executeComponentsOnly<Arg1, Args...>(std::forward<Action>(action), typeIndices, registries, entityDataPair,
                                                           std::make_index_sequence<ComponentCount>{});
                 }
-            }
+            });
+        }
+
+        template<std::size_t Count, std::size_t ...Idx>
+        static std::array<ComponentRegistry *, Count> getRegistries(const std::array<std::type_index, Count> &typeIndices, std::index_sequence<Idx...>) {
+            return {ComponentRegistry::getInstance(typeIndices[Idx])...};
         }
 
-        template<typename ...TComponents, typename Action, std::size_t ...Idx>
-        static void _executeComponentsOnly(const Action &action, const std::vector<std::type_index> &typeIndices,
+        template<typename ...TComponents, typename Action, std::size_t Count, std::size_t ...Idx>
+        static void _executeComponentsOnly(const Action &action, const std::array<std::type_index, Count> &typeIndices,
+                                           const std::array<ComponentRegistry *, Count> &registries,
                                            const EntityDataPair &entityDataPair, std::index_sequence<Idx...>) {
-            std::vector<ComponentRegistry *> registries = {ComponentRegistry::getInstance(typeIndices[Idx])...};
             action(registries[Idx]->template getComponentData<TComponents>(entityDataPair.second.componentMap.at(typeIndices[Idx]))...);
         }
 
-        template<typename ...TComponents, typename Action, std::size_t ...Idx>
-        static void _executeWithEntity(const Action &action, const std::vector<std::type_index> &typeIndices,
+        template<typename ...TComponents, typename Action, std::size_t Count, std::size_t ...Idx>
+        static void _executeWithEntity(const Action &action, const std::array<std::type_index, Count> &typeIndices,
+                                       const std::array<ComponentRegistry *, Count> &registries,
                                        const EntityDataPair &entityDataPair, std::index_sequence<Idx...>) {
-            std::vector<ComponentRegistry *> registries = {ComponentRegistry::getInstance(typeIndices[Idx])...};
             action(entityDataPair.first, (registries[Idx]->template getComponentData<TComponents>(entityDataPair.second.componentMap.at(typeIndices[Idx])))...);
         }
 
@@ -295,7 +343,17 @@ namespace entity {
 
         EntityRegistry() = default;
 
+        // updates the ids of an Entity, the entry in entities is not moved
+        void moveEntity(int fromID, int toID) {
+            const EntityDataPair &dataPair = entities[fromID];
+            dataPair.first->updateReferenceID(toID);
+            for (const auto &idxToComponentEntry: dataPair.second.componentMap) {
+                ComponentRegistry::getInstance(idxToComponentEntry.first)->setEntityID(idxToComponentEntry.second, toID);
+            }
+        }
+
         std::vector<EntityDataPair> entities = {};
+        bool stableOrder = false;
 
     };
 }
@@ -7,9 +7,16 @@ namespace gameState {
     public:
         [[nodiscard]] const bool &isFinished() { return _isFinished; }
 
+        /**
+         * Advances the simulation by a fixed time step.
+         */
         virtual void update(const long long &deltaMicroseconds) = 0;
 
-        virtual void draw(const long long &deltaMicroseconds) = 0;
+        /**
+         * @param interpolation time since the last update as fraction of the update interval, in [0, 1).
+         * Drawing lags one update behind and blends the last two updates with this factor, see MeshRenderer::present.
+         */
+        virtual void draw(const long long &deltaMicroseconds, float interpolation) = 0;
 
         virtual void onResume() = 0;
 
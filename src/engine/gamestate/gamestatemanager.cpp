@@ -1,4 +1,8 @@
 ﻿#include "gamestatemanager.h"
+#include <engine/utils/framearena.hpp>
+#include <engine/utils/random.hpp>
+#include <engine/components/statehash.h>
+#include <algorithm>
 
 namespace gameState {
 
@@ -6,8 +10,6 @@ namespace gameState {
     using microseconds = std::chrono::microseconds;
 
     static constexpr auto noStateWaitDelay = microseconds(1'000'000 / 10).count();
-    static constexpr auto targetUpdateInterval = microseconds(1'000'000 / 30).count();
-    static constexpr auto targetDrawInterval = microseconds(1'000'000 / 60).count();
 
     void GameStateManager::startGameState(gameState::BaseGameState *baseGameState) {
         if (!gameStates.empty()) {
@@ -16,46 +18,73 @@ namespace gameState {
         gameStates.push_back(baseGameState);
     }
 
+    void GameStateManager::setDeterministic(uint64_t seed, size_t hashWindow) {
+        deterministic = true;
+        utils::Random::get().seed(seed);
+        entity::EntityRegistry::getInstance().setStableOrder(true);
+        stateHashes.assign(std::max<size_t>(hashWindow, 1), 0);
+        hashedTicks = 0;
+    }
+
     long long GameStateManager::updateGameStates(GLFWwindow *window) {
         if (gameStates.empty()) {
             return noStateWaitDelay;
         }
 
         auto now = clock::now();
-        // TODO if the pc is too slow for the target intervals, we're just building up time deficits that never get depleted
-
-        auto timeUntilUpdate = targetUpdateInterval - std::chrono::duration_cast<microseconds>(now - lastUpdateTime).count();
-        if (timeUntilUpdate <= 0) {
-            timeUntilUpdate += targetUpdateInterval;
-            lastUpdateTime = lastUpdateTime + microseconds(targetUpdateInterval);
-
-            gameState::BaseGameState *currentGameState = gameStates.back();
-            while (true) {
-                currentGameState->update(targetUpdateInterval);
-                if (currentGameState->isFinished()) {
-                    gameStates.pop_back();
-                    delete currentGameState;
-                    if (gameStates.empty()) {
-                        return noStateWaitDelay;
-                    }
-                    currentGameState = gameStates.back();
-                    currentGameState->onResume();
-                } else {
-                    break;
-                }
+        accumulatedTime += std::chrono::duration_cast<microseconds>(now - lastUpdateTime).count();
+        lastUpdateTime = now;
+
+        // fixed time steps, independent of the draw rate
+        for (int updates = 0; accumulatedTime >= updateInterval; updates++) {
+            if (updates == maxUpdatesPerCall) {
+                // the pc is too slow for the update interval, drop the deficit instead of building it up
+                accumulatedTime %= updateInterval;
+                break;
+            }
+            accumulatedTime -= updateInterval;
+            if (!updateCurrentState()) {
+                return noStateWaitDelay;
             }
         }
+        auto timeUntilUpdate = updateInterval - accumulatedTime;
 
-        auto timeUntilDraw = targetDrawInterval - std::chrono::duration_cast<microseconds>(now - lastDrawTime).count();
+        auto timeUntilDraw = drawInterval - std::chrono::duration_cast<microseconds>(now - lastDrawTime).count();
         if (timeUntilDraw <= 0) {
             graphics::glCall(glClear, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            timeUntilDraw += targetDrawInterval;
-            lastDrawTime = lastDrawTime + microseconds(targetDrawInterval);
-            gameStates.back()->draw(targetDrawInterval);
+            // skip missed draws instead of catching up
+            lastDrawTime = timeUntilDraw > -drawInterval ? lastDrawTime + microseconds(drawInterval) : now;
+            timeUntilDraw = drawInterval - std::chrono::duration_cast<microseconds>(now - lastDrawTime).count();
+            const float interpolation = static_cast<float>(accumulatedTime) / static_cast<float>(updateInterval);
+            gameStates.back()->draw(drawInterval, interpolation);
             glfwSwapBuffers(window);
             graphics::glCall(glClear, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         }
 
         return std::min(timeUntilUpdate, timeUntilDraw);
     }
+
+    bool GameStateManager::updateCurrentState() {
+        // temporaries of the previous tick remain valid until the end of this tick
+        utils::FrameArena::get().nextFrame();
+
+        gameState::BaseGameState *currentGameState = gameStates.back();
+        while (true) {
+            currentGameState->update(updateInterval);
+            if (deterministic) {
+                stateHashes[hashedTicks % stateHashes.size()] = components::StateHashSystem(entity::EntityRegistry::getInstance()).execute();
+                hashedTicks++;
+            }
+            if (!currentGameState->isFinished()) {
+                return true;
+            }
+            gameStates.pop_back();
+            delete currentGameState;
+            if (gameStates.empty()) {
+                return false;
+            }
+            currentGameState = gameStates.back();
+            currentGameState->onResume();
+        }
+    }
 }
\ No newline at end of file
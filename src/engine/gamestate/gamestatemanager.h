@@ -3,7 +3,9 @@
 
 #include "basegamestate.h"
 #include <vector>
+#include <optional>
 #include <chrono>
+#include <cstdint>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <engine/graphics/core/opengl.hpp>
@@ -23,12 +25,70 @@ namespace gameState {
 
         void startGameState(gameState::BaseGameState *baseGameState);
 
+        /**
+         * Runs as many fixed updates as the elapsed time requires and draws if it is time to.
+         * @return microseconds until the next update or draw is due
+         */
         long long updateGameStates(GLFWwindow *window);
 
+        /**
+         * @param microseconds time step of each update
+         */
+        void setUpdateInterval(long long microseconds) { updateInterval = microseconds; }
+
+        /**
+         * @param microseconds minimum time between two draws
+         */
+        void setDrawInterval(long long microseconds) { drawInterval = microseconds; }
+
+        /**
+         * If more updates are due at once, the remaining time is dropped and the simulation runs slower than real time.
+         * This keeps the cost bounded if the pc is too slow for the update interval.
+         */
+        void setMaxUpdatesPerCall(int updates) { maxUpdatesPerCall = updates; }
+
+        /**
+         * Lockstep mode: seeds utils::Random, keeps the iteration order of the EntityRegistry stable and hashes the state after every update.
+         * Runs with the same seed and the same inputs have the same hashes, the first differing hash shows the tick in which they diverged.
+         * @param hashWindow number of recent state hashes that are kept, older ones are overwritten
+         */
+        void setDeterministic(uint64_t seed, size_t hashWindow = 1024);
+
+        [[nodiscard]] bool isDeterministic() const { return deterministic; }
+
+        /**
+         * @return number of updates hashed since setDeterministic()
+         */
+        [[nodiscard]] uint64_t getHashedTicks() const { return hashedTicks; }
+
+        /**
+         * @param tick index of the update since setDeterministic(), starting at 0
+         * @return state hash after this update, or nothing if it is not within the last hashWindow updates
+         */
+        [[nodiscard]] std::optional<uint64_t> getStateHash(uint64_t tick) const {
+            if (tick >= hashedTicks || hashedTicks - tick > stateHashes.size()) {
+                return std::nullopt;
+            }
+            return stateHashes[tick % stateHashes.size()];
+        }
+
     private:
         GameStateManager() = default;
 
+        /**
+         * @return false if no game state is left
+         */
+        bool updateCurrentState();
+
         std::vector<gameState::BaseGameState *> gameStates = {};
+        long long updateInterval = 1'000'000 / 30;
+        long long drawInterval = 1'000'000 / 60;
+        int maxUpdatesPerCall = 5;
+        long long accumulatedTime = 0;
+        bool deterministic = false;
+        // ring buffer with the hash of update i at i % stateHashes.size()
+        std::vector<uint64_t> stateHashes = {};
+        uint64_t hashedTicks = 0;
         std::chrono::time_point<std::chrono::high_resolution_clock> lastUpdateTime = std::chrono::high_resolution_clock::now();
         std::chrono::time_point<std::chrono::high_resolution_clock> lastDrawTime = std::chrono::high_resolution_clock::now();
 
@@ -1,10 +1,12 @@
 ﻿#include "LightManager.h"
+#include <engine/utils/framearena.hpp>
+#include <memory_resource>
 
 namespace graphics {
 
     void LightManager::LightSystem::execute() {
         bool boundLightCountChanged = false;
-        std::vector<const entity::EntityReference *> changedLights = {};
+        std::pmr::vector<const entity::EntityReference *> changedLights(&utils::FrameArena::get());
         // make sure all Lights are registered in LightManager
         registry.execute([this, &boundLightCountChanged, &changedLights](const entity::EntityReference *entity, components::Light light) {
             if (light.getLightManagerId() < 0) {
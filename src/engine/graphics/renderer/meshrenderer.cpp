@@ -5,8 +5,8 @@ namespace graphics {
     MeshRenderer::MeshRenderData::MeshRenderData(Mesh *_meshData,
                                                  const Texture2D *_textureData, const Texture2D *_phongData, const Texture2D *_normalData,
                                                  const Texture2D *_heightData,
-                                                 const glm::mat4 &_transform)
-            : meshData(_meshData), transform(_transform) {
+                                                 const components::Transform &_transform)
+            : meshData(_meshData), transform(_transform.getTransformMatrix()), previousTransform(_transform), currentTransform(_transform) {
         setTextureData(_textureData);
         setPhongData(_phongData);
         setNormalData(_normalData);
@@ -57,7 +57,7 @@ namespace graphics {
         activeMeshEntities.push_back(entity);
 
         auto *data = new MeshRenderData(new Mesh(mesh.getMeshData()), mesh.getTextureData(), mesh.getPhongData(), mesh.getNormalData(),
-                                        mesh.getHeightData(), transform.getTransformMatrix());
+                                        mesh.getHeightData(), transform);
         data->isEnabled = mesh.getIsEnabled();
         meshBuffer.push_back(data);
 
@@ -74,13 +74,13 @@ namespace graphics {
 
     void MeshRenderer::update() {
         entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
-
         for (const entity::EntityReference *entity: activeMeshEntities) {
             components::Mesh mesh = registry.getComponentData<components::Mesh>(entity).value();
             components::Transform transform = registry.getComponentData<components::Transform>(entity).value();
 
             MeshRenderData *data = meshBuffer[mesh._rendererID];
             data->isEnabled = mesh.getIsEnabled();
+            data->previousTransform = data->currentTransform;
             if (mesh.hasAnyChanges()) {
                 if (mesh.meshHasChanged()) {
                     delete data->meshData;
@@ -107,6 +107,7 @@ namespace graphics {
             }
             if (transform.hasTransformChanged()) {
                 data->transform = transform.getTransformMatrix();
+                data->currentTransform = TransformSnapshot(transform);
                 transform.onChangesHandled();
                 registry.addOrSetComponent(entity, transform);
             }
@@ -138,7 +139,7 @@ namespace graphics {
         activeMeshEntities.pop_back();
     }
 
-    void MeshRenderer::present(const unsigned int programID) {
+    void MeshRenderer::present(const unsigned int programID, const float interpolation) {
         if (currentProgramID != programID) {
             currentProgramID = programID;
             glsl_object_to_world_matrix = glGetUniformLocation(programID, "object_to_world_matrix");
@@ -152,7 +153,17 @@ namespace graphics {
             meshRenderData->phongData->bind(1);
             meshRenderData->normalData->bind(2);
             meshRenderData->heightData->bind(3);
-            glUniformMatrix4fv(glsl_object_to_world_matrix, 1, false, glm::value_ptr(meshRenderData->transform));
+
+            const TransformSnapshot &previous = meshRenderData->previousTransform;
+            const TransformSnapshot &current = meshRenderData->currentTransform;
+            if (interpolation < 1.0f && previous != current) {
+                const glm::mat4 transform = glm::translate(glm::identity<glm::mat4>(), glm::mix(previous.position, current.position, interpolation))
+                                            * glm::toMat4(glm::slerp(previous.rotation, current.rotation, interpolation))
+                                            * glm::scale(glm::identity<glm::mat4>(), glm::mix(previous.scale, current.scale, interpolation));
+                glUniformMatrix4fv(glsl_object_to_world_matrix, 1, false, glm::value_ptr(transform));
+            } else {
+                glUniformMatrix4fv(glsl_object_to_world_matrix, 1, false, glm::value_ptr(meshRenderData->transform));
+            }
             meshRenderData->meshData->getGeometryBuffer()->draw();
         }
     }
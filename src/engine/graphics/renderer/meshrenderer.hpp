@@ -18,10 +18,24 @@ namespace graphics {
     class MeshRenderer {
 
     private:
+        /**
+         * Position, rotation and scale of a Transform at the end of an update tick.
+         */
+        struct TransformSnapshot {
+            explicit TransformSnapshot(const components::Transform &transform)
+                    : position(transform.getPosition()), rotation(transform.getRotation()), scale(transform.getScale()) {}
+
+            bool operator==(const TransformSnapshot &other) const = default;
+
+            glm::vec3 position;
+            glm::quat rotation;
+            glm::vec3 scale;
+        };
+
         struct MeshRenderData {
             MeshRenderData(Mesh *_meshData,
                            const Texture2D *_textureData, const Texture2D *_phongData, const Texture2D *_normalData, const Texture2D *_heightData,
-                           const glm::mat4 &_transform);
+                           const components::Transform &_transform);
 
             void setTextureData(const Texture2D *_textureData);
 
@@ -36,7 +50,9 @@ namespace graphics {
             Texture2D::Handle phongData = nullptr;
             Texture2D::Handle normalData = nullptr;
             Texture2D::Handle heightData = nullptr;
-            glm::mat4 transform = glm::identity<glm::mat4>();
+            glm::mat4 transform = glm::identity<glm::mat4>(); ///< matrix of the current snapshot
+            TransformSnapshot previousTransform;
+            TransformSnapshot currentTransform;
             bool isEnabled = true;
 
             ~MeshRenderData() {
@@ -49,13 +65,21 @@ namespace graphics {
 
         void registerMesh(const entity::EntityReference *entity);
 
+        /**
+         * Takes the changes of the meshes and a snapshot of their transforms. Call once at the end of each update tick,
+         * after components::ComposeTransformSystem so that the matrices are not composed again.
+         */
         void update();
 
         void removeMesh(const entity::EntityReference *meshEntity);
 
         void removeMesh(const components::Mesh &mesh);
 
-        void present(unsigned int programID);
+        /**
+         * @param interpolation between the transforms of the previous (0) and the last (1) update tick,
+         * see BaseGameState::draw. Smooths the movement when drawing more often than updating.
+         */
+        void present(unsigned int programID, float interpolation = 1.0f);
 
         void clear();
 
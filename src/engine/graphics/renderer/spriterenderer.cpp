@@ -59,9 +59,7 @@ void SpriteRenderer::draw(const Sprite& _sprite, const vec3& _position, float _r
 	//instance.position.z = -1.0f + instance.position.z;
 	instance.rotation = _rotation;
 	instance.color = _color;
-	vec2 minPos = _scale * (sp.offset);
-	vec2 maxPos = _scale * (vec2(sp.size) + sp.offset);
-	instance.scale = glm::uvec2(packHalf2x16(minPos), packHalf2x16(maxPos));
+	instance.scale = packScale(sp, _scale);
 	if(sp.data.numTiles.x > 1) instance.animation.x = fmod(_animX, (float)sp.data.numTiles.x);
 	else instance.animation.x = 0.0f;
 	if(sp.data.numTiles.y > 1) instance.animation.y = fmod(_animY, (float)sp.data.numTiles.y);
@@ -71,16 +69,50 @@ void SpriteRenderer::draw(const Sprite& _sprite, const vec3& _position, float _r
 	m_dirty = true;
 }
 
+void SpriteRenderer::draw(const Sprite& _sprite, const math::ParticlePool<float>& _particles, const vec2& _scale)
+{
+	SpriteInstance instance;
+	instance.sprite = _sprite.data;
+	instance.rotation = 0.0f;
+	instance.scale = packScale(_sprite, _scale);
+	instance.animation = vec2(0.0f);
+
+	m_instances.reserve(m_instances.size() + _particles.size());
+	for(size_t i = 0; i < _particles.size(); ++i)
+	{
+		instance.position = _particles.position(i);
+		instance.color = _particles.color(i);
+		m_instances.push_back(instance);
+	}
+	m_dirty = true;
+}
+
+uvec2 SpriteRenderer::packScale(const Sprite& _sprite, const vec2& _scale)
+{
+	vec2 minPos = _scale * (_sprite.offset);
+	vec2 maxPos = _scale * (vec2(_sprite.size) + _sprite.offset);
+	return uvec2(packHalf2x16(minPos), packHalf2x16(maxPos));
+}
+
 void SpriteRenderer::clear()
 {
 	m_instances.clear();
 	m_dirty = true;
 }
 
-void SpriteRenderer::present(const Camera& _camera)
+void SpriteRenderer::present(const Camera& _camera, bool _billboard)
 {
 	m_program.use();
-	m_program.setUniform(0, _camera.getViewProjection()); //todo: move this into an uniform buffer object?
+	if(_billboard)
+	{
+		m_program.setUniform(0, _camera.getWorldToCamera());
+		m_program.setUniform(1, _camera.rightVector());
+		m_program.setUniform(2, _camera.upVector());
+	} else {
+		m_program.setUniform(0, _camera.getViewProjection()); //todo: move this into an uniform buffer object?
+		m_program.setUniform(1, vec3(1.0f, 0.0f, 0.0f));
+		m_program.setUniform(2, vec3(0.0f, 1.0f, 0.0f));
+	}
 
 	// Update instance data each frame - it could be dynamic
 	if(m_dirty)
@@ -3,6 +3,7 @@
 #include "sprite.hpp"
 #include "../core/shader.hpp"
 #include "../camera.hpp"
+#include "../../math/particlepool.hpp"
 #include <vector>
 
 namespace graphics {
@@ -38,16 +39,26 @@ namespace graphics {
 			float _animX = 0.0f, 
 			float _animY = 0.0f);
 
+		/// Add one instance per living particle of a pool.
+		/// \param [in] _scale Same as for single sprites. All particles use the color they
+		///		were emitted with, no rotation and no animation.
+		void draw(const Sprite& _sprite, const math::ParticlePool<float>& _particles, const glm::vec2& _scale);
+
 		/// Clear all existing instances (recommended for fully dynamic buffers)
 		void clear();
 		
 		/// Single draw call for all instances.
-		void present(const Camera& _camera);
+		/// \param [in] _billboard Turn all sprites towards the camera and use its position and
+		///		rotation (Camera::getWorldToCamera()), e.g. for particles in a 3D scene. Otherwise
+		///		the sprites lie in the xy-plane and only the view-projection is applied.
+		void present(const Camera& _camera, bool _billboard = false);
 
 		/// Check if there are any instances to draw
 		bool isEmpty() const { return m_instances.empty(); }
 
 	private:
+		static glm::uvec2 packScale(const Sprite& _sprite, const glm::vec2& _scale);
+
 #pragma pack(push, 4)
 
 		struct SpriteInstance
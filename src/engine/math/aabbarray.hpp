@@ -0,0 +1,169 @@
+#pragma once
+
+#include "geometrictypes.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+#include <array>
+#include <limits>
+#include <bit>
+#include <algorithm>
+#include <type_traits>
+#include <cinttypes>
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ACAENGINE_AABB_SSE2
+#endif
+
+namespace math {
+
+	// Array of axis aligned boxes in structure of arrays layout.
+	// Each coordinate is stored in its own array, so that one box can be tested against
+	// LANES boxes at once with SIMD instructions (AVX if enabled, else SSE2).
+	// The arrays are padded to a multiple of LANES with empty boxes which intersect nothing.
+	template<unsigned Dim, typename FloatT = float>
+	class AABBArray
+	{
+	public:
+		using BoxT = Box<Dim, FloatT>;
+		constexpr static size_t LANES = 8;
+
+		AABBArray() = default;
+		explicit AABBArray(size_t _size) { resize(_size); }
+
+		size_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+
+		void clear() { resize(0); }
+
+		void reserve(size_t _size)
+		{
+			for (unsigned d = 0; d < Dim; ++d)
+			{
+				m_min[d].reserve(paddedSize(_size));
+				m_max[d].reserve(paddedSize(_size));
+			}
+		}
+
+		// New boxes are empty.
+		void resize(size_t _size)
+		{
+			for (unsigned d = 0; d < Dim; ++d)
+			{
+				m_min[d].resize(paddedSize(_size), std::numeric_limits<FloatT>::max());
+				m_max[d].resize(paddedSize(_size), std::numeric_limits<FloatT>::lowest());
+				// reset the padding after a shrink
+				for (size_t i = _size; i < m_min[d].size(); ++i)
+				{
+					m_min[d][i] = std::numeric_limits<FloatT>::max();
+					m_max[d][i] = std::numeric_limits<FloatT>::lowest();
+				}
+			}
+			m_size = _size;
+		}
+
+		void push_back(const BoxT& _box)
+		{
+			resize(m_size + 1);
+			set(m_size - 1, _box);
+		}
+
+		void set(size_t _idx, const BoxT& _box)
+		{
+			for (unsigned d = 0; d < Dim; ++d)
+			{
+				m_min[d][_idx] = _box.min[d];
+				m_max[d][_idx] = _box.max[d];
+			}
+		}
+
+		BoxT operator[](size_t _idx) const
+		{
+			BoxT box;
+			for (unsigned d = 0; d < Dim; ++d)
+			{
+				box.min[d] = m_min[d][_idx];
+				box.max[d] = m_max[d][_idx];
+			}
+			return box;
+		}
+
+		const FloatT* min(unsigned _axis) const { return m_min[_axis].data(); }
+		const FloatT* max(unsigned _axis) const { return m_max[_axis].data(); }
+
+		// Test _box against the LANES boxes starting at _first, which has to be a multiple of LANES.
+		// Bit i of the result is set if the box _first + i intersects _box. Uses the same
+		// inclusive bounds as Box::intersect.
+		uint32_t intersectMask(const BoxT& _box, size_t _first) const
+		{
+			if constexpr (std::is_same_v<FloatT, float>)
+			{
+#if defined(__AVX__)
+				__m256 hit = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (unsigned d = 0; d < Dim; ++d)
+				{
+					const __m256 mins = _mm256_loadu_ps(m_min[d].data() + _first);
+					const __m256 maxs = _mm256_loadu_ps(m_max[d].data() + _first);
+					hit = _mm256_and_ps(hit, _mm256_cmp_ps(mins, _mm256_set1_ps(_box.max[d]), _CMP_LE_OQ));
+					hit = _mm256_and_ps(hit, _mm256_cmp_ps(maxs, _mm256_set1_ps(_box.min[d]), _CMP_GE_OQ));
+				}
+				return static_cast<uint32_t>(_mm256_movemask_ps(hit));
+#elif defined(ACAENGINE_AABB_SSE2)
+				return intersectMask4(_box, _first) | (intersectMask4(_box, _first + 4) << 4);
+#endif
+			}
+
+			uint32_t mask = 0;
+			for (size_t i = 0; i < LANES; ++i)
+			{
+				bool hit = true;
+				for (unsigned d = 0; d < Dim; ++d)
+					hit &= m_min[d][_first + i] <= _box.max[d] && m_max[d][_first + i] >= _box.min[d];
+				mask |= static_cast<uint32_t>(hit) << i;
+			}
+			return mask;
+		}
+
+		// Call _fn(index) in ascending order for each box in [_begin, _end) which intersects _box.
+		template<typename Fn>
+		void forEachIntersection(const BoxT& _box, Fn&& _fn, size_t _begin = 0, size_t _end = std::numeric_limits<size_t>::max()) const
+		{
+			_end = std::min(_end, m_size);
+			for (size_t first = _begin / LANES * LANES; first < _end; first += LANES)
+			{
+				uint32_t mask = intersectMask(_box, first);
+				while (mask)
+				{
+					const size_t idx = first + std::countr_zero(mask);
+					mask &= mask - 1;
+					if (idx >= _begin && idx < _end) _fn(idx);
+				}
+			}
+		}
+
+	private:
+		static size_t paddedSize(size_t _size) { return (_size + LANES - 1) / LANES * LANES; }
+
+#if defined(ACAENGINE_AABB_SSE2)
+		uint32_t intersectMask4(const BoxT& _box, size_t _first) const
+		{
+			__m128 hit = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (unsigned d = 0; d < Dim; ++d)
+			{
+				const __m128 mins = _mm_loadu_ps(m_min[d].data() + _first);
+				const __m128 maxs = _mm_loadu_ps(m_max[d].data() + _first);
+				hit = _mm_and_ps(hit, _mm_cmple_ps(mins, _mm_set1_ps(_box.max[d])));
+				hit = _mm_and_ps(hit, _mm_cmpge_ps(maxs, _mm_set1_ps(_box.min[d])));
+			}
+			return static_cast<uint32_t>(_mm_movemask_ps(hit));
+		}
+#endif
+
+		std::array<std::vector<FloatT>, Dim> m_min;
+		std::array<std::vector<FloatT>, Dim> m_max;
+		size_t m_size = 0;
+	};
+}
@@ -0,0 +1,322 @@
+#pragma once
+
+#include "narrowphase.hpp"
+#include "../utils/threadpool.hpp"
+#include "../utils/assert.hpp"
+#include "../utils/containers/flathashmap.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+#include <span>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <cinttypes>
+#include <algorithm>
+
+namespace math {
+
+	// State of a rigid body during the contact solve.
+	// Bodies with inverseMass 0 are static: they are not changed by the solver and do not
+	// connect islands.
+	template<typename FloatT = float>
+	struct SolverBody
+	{
+		using VecT = glm::vec<3, FloatT, glm::defaultp>;
+		using MatT = glm::mat<3, 3, FloatT, glm::defaultp>;
+
+		VecT position = VecT(0); ///< center of mass
+		VecT velocity = VecT(0);
+		VecT angularVelocity = VecT(0); ///< in world space
+		MatT inverseInertia = MatT(0); ///< in world space
+		FloatT inverseMass = 0;
+		FloatT friction = 0;
+		FloatT restitution = 0;
+		uint32_t id = 0; ///< identifies the body across solves to find the impulses of the last one
+
+		bool isStatic() const { return inverseMass == 0; }
+	};
+
+	// Sequential impulse solver for contacts between rigid bodies (Catto, "Iterative Dynamics
+	// with Temporal Coherence", 2005). Each contact is a non-penetration constraint along the
+	// normal and two friction constraints in the tangent plane. The constraints are solved
+	// one after another for a fixed number of iterations, where the accumulated impulse of
+	// each constraint is clamped instead of the increments.
+	// The accumulated impulses are kept for the next solve and applied up front (warm
+	// starting), so that resting contacts converge within a few iterations.
+	// Bodies connected by contacts form islands which are solved independently in parallel.
+	// The result only depends on the inputs and their order, not on the number of threads.
+	template<typename FloatT = float>
+	class ContactSolver
+	{
+	public:
+		using VecT = glm::vec<3, FloatT, glm::defaultp>;
+		using Body = SolverBody<FloatT>;
+		using Pair = std::pair<uint32_t, uint32_t>;
+
+		/// @param _iterations Number of passes over all constraints.
+		/// @param _baumgarte Fraction of the penetration which is removed per step.
+		/// @param _slop Penetration which is not corrected, so that resting contacts do not jitter.
+		/// @param _restitutionThreshold Contacts which approach slower do not bounce.
+		explicit ContactSolver(int _iterations = 10, FloatT _baumgarte = static_cast<FloatT>(0.2),
+			FloatT _slop = static_cast<FloatT>(0.01), FloatT _restitutionThreshold = static_cast<FloatT>(0.5))
+			: m_iterations(_iterations), m_baumgarte(_baumgarte), m_slop(_slop), m_restitutionThreshold(_restitutionThreshold)
+		{}
+
+		/// @brief Change the velocities of the bodies so that the contacts are resolved.
+		/// @param _pairs Indices (a, b) into _bodies. The contact normals point from a to b.
+		/// @param _contacts Contacts as produced by collidePairs(): Contact::pair is the index
+		///		of the pair in _pairs.
+		/// @param _dt Time step after which the positions will be integrated.
+		void solve(std::span<Body> _bodies, std::span<const Pair> _pairs, std::span<const Contact<3, FloatT>> _contacts,
+			FloatT _dt, utils::ThreadPool& _threadPool = utils::ThreadPool::get());
+
+		/// Number of independent islands in the last solve.
+		size_t numIslands() const { return m_islandBegin.empty() ? 0 : m_islandBegin.size() - 1; }
+
+		/// Forget the impulses of the last solve, e.g. after bodies were teleported.
+		void clearCache() { m_cache.clear(); }
+
+	private:
+		struct Constraint
+		{
+			uint32_t bodyA;
+			uint32_t bodyB;
+			VecT rA; ///< contact point relative to the center of mass of a
+			VecT rB;
+			VecT normal;
+			VecT tangents[2];
+			FloatT normalMass;
+			FloatT tangentMass[2];
+			FloatT bias; ///< target separating velocity from restitution and penetration
+			FloatT friction;
+			FloatT normalImpulse;
+			FloatT tangentImpulse[2];
+			uint64_t key;
+		};
+
+		struct CachedImpulse
+		{
+			VecT direction; ///< contact normal
+			FloatT normal;
+			VecT tangent; ///< friction impulse in world space, since the tangents may change
+		};
+
+		uint32_t findRoot(uint32_t _body);
+		void prepare(Constraint& _constraint, std::span<const Body> _bodies, const Contact<3, FloatT>& _contact, FloatT _dt) const;
+		static void applyImpulse(std::span<Body> _bodies, const Constraint& _constraint, const VecT& _impulse);
+		static VecT relativeVelocity(std::span<const Body> _bodies, const Constraint& _constraint);
+		void solveIsland(std::span<Body> _bodies, size_t _island);
+
+		int m_iterations;
+		FloatT m_baumgarte;
+		FloatT m_slop;
+		FloatT m_restitutionThreshold;
+
+		std::vector<Constraint> m_constraints; ///< grouped by island
+		std::vector<uint32_t> m_islandBegin; ///< first constraint of each island and the end
+		std::vector<uint32_t> m_parent; ///< union find over the bodies
+		std::vector<uint32_t> m_islandOfRoot;
+		std::vector<uint32_t> m_constraintIsland;
+		std::vector<Constraint> m_unsorted;
+		utils::FlatHashMap<uint64_t, CachedImpulse> m_cache;
+	};
+
+	// ******************************************************************* //
+	template<typename FloatT>
+	uint32_t ContactSolver<FloatT>::findRoot(uint32_t _body)
+	{
+		while (m_parent[_body] != _body)
+		{
+			// path halving
+			m_parent[_body] = m_parent[m_parent[_body]];
+			_body = m_parent[_body];
+		}
+		return _body;
+	}
+
+	template<typename FloatT>
+	void ContactSolver<FloatT>::prepare(Constraint& _constraint, std::span<const Body> _bodies, const Contact<3, FloatT>& _contact, FloatT _dt) const
+	{
+		const Body& a = _bodies[_constraint.bodyA];
+		const Body& b = _bodies[_constraint.bodyB];
+		_constraint.rA = _contact.point - a.position;
+		_constraint.rB = _contact.point - b.position;
+		_constraint.normal = _contact.normal;
+
+		// any orthonormal basis of the tangent plane, see Duff et al., "Building an Orthonormal Basis, Revisited"
+		const VecT& n = _contact.normal;
+		const FloatT s = n.z >= 0 ? static_cast<FloatT>(1) : static_cast<FloatT>(-1);
+		const FloatT u = static_cast<FloatT>(-1) / (s + n.z);
+		const FloatT v = n.x * n.y * u;
+		_constraint.tangents[0] = VecT(1 + s * n.x * n.x * u, s * v, -s * n.x);
+		_constraint.tangents[1] = VecT(v, s + n.y * n.y * u, -n.y);
+
+		// inverse of the effective mass along a direction
+		auto effectiveMass = [&](const VecT& _dir)
+		{
+			const VecT rnA = glm::cross(_constraint.rA, _dir);
+			const VecT rnB = glm::cross(_constraint.rB, _dir);
+			const FloatT k = a.inverseMass + b.inverseMass + glm::dot(rnA, a.inverseInertia * rnA) + glm::dot(rnB, b.inverseInertia * rnB);
+			return k > 0 ? static_cast<FloatT>(1) / k : static_cast<FloatT>(0);
+		};
+		_constraint.normalMass = effectiveMass(n);
+		_constraint.tangentMass[0] = effectiveMass(_constraint.tangents[0]);
+		_constraint.tangentMass[1] = effectiveMass(_constraint.tangents[1]);
+		_constraint.friction = std::sqrt(a.friction * b.friction);
+
+		_constraint.bias = m_baumgarte / _dt * std::max(_contact.depth - m_slop, static_cast<FloatT>(0));
+		const FloatT approachSpeed = -glm::dot(relativeVelocity(_bodies, _constraint), n);
+		if (approachSpeed > m_restitutionThreshold)
+			_constraint.bias = std::max(_constraint.bias, std::max(a.restitution, b.restitution) * approachSpeed);
+	}
+
+	template<typename FloatT>
+	void ContactSolver<FloatT>::applyImpulse(std::span<Body> _bodies, const Constraint& _constraint, const VecT& _impulse)
+	{
+		// static bodies are shared between islands and must not be written
+		Body& a = _bodies[_constraint.bodyA];
+		Body& b = _bodies[_constraint.bodyB];
+		if (!a.isStatic())
+		{
+			a.velocity -= _impulse * a.inverseMass;
+			a.angularVelocity -= a.inverseInertia * glm::cross(_constraint.rA, _impulse);
+		}
+		if (!b.isStatic())
+		{
+			b.velocity += _impulse * b.inverseMass;
+			b.angularVelocity += b.inverseInertia * glm::cross(_constraint.rB, _impulse);
+		}
+	}
+
+	template<typename FloatT>
+	typename ContactSolver<FloatT>::VecT ContactSolver<FloatT>::relativeVelocity(std::span<const Body> _bodies, const Constraint& _constraint)
+	{
+		const Body& a = _bodies[_constraint.bodyA];
+		const Body& b = _bodies[_constraint.bodyB];
+		return b.velocity + glm::cross(b.angularVelocity, _constraint.rB) - a.velocity - glm::cross(a.angularVelocity, _constraint.rA);
+	}
+
+	template<typename FloatT>
+	void ContactSolver<FloatT>::solveIsland(std::span<Body> _bodies, size_t _island)
+	{
+		const std::span<Constraint> constraints(m_constraints.data() + m_islandBegin[_island], m_constraints.data() + m_islandBegin[_island + 1]);
+
+		for (const Constraint& constraint : constraints)
+		{
+			applyImpulse(_bodies, constraint, constraint.normal * constraint.normalImpulse
+				+ constraint.tangents[0] * constraint.tangentImpulse[0] + constraint.tangents[1] * constraint.tangentImpulse[1]);
+		}
+
+		for (int iteration = 0; iteration < m_iterations; ++iteration)
+		{
+			for (Constraint& constraint : constraints)
+			{
+				// friction first, since the normal constraint is more important
+				const FloatT maxFriction = constraint.friction * constraint.normalImpulse;
+				for (int k = 0; k < 2; ++k)
+				{
+					const FloatT speed = glm::dot(relativeVelocity(_bodies, constraint), constraint.tangents[k]);
+					const FloatT previous = constraint.tangentImpulse[k];
+					constraint.tangentImpulse[k] = std::clamp(previous - speed * constraint.tangentMass[k], -maxFriction, maxFriction);
+					applyImpulse(_bodies, constraint, constraint.tangents[k] * (constraint.tangentImpulse[k] - previous));
+				}
+
+				const FloatT speed = glm::dot(relativeVelocity(_bodies, constraint), constraint.normal);
+				const FloatT previous = constraint.normalImpulse;
+				constraint.normalImpulse = std::max(previous + (constraint.bias - speed) * constraint.normalMass, static_cast<FloatT>(0));
+				applyImpulse(_bodies, constraint, constraint.normal * (constraint.normalImpulse - previous));
+			}
+		}
+	}
+
+	template<typename FloatT>
+	void ContactSolver<FloatT>::solve(std::span<Body> _bodies, std::span<const Pair> _pairs, std::span<const Contact<3, FloatT>> _contacts,
+		FloatT _dt, utils::ThreadPool& _threadPool)
+	{
+		constexpr uint32_t NO_ISLAND = std::numeric_limits<uint32_t>::max();
+
+		// islands of the dynamic bodies
+		m_parent.resize(_bodies.size());
+		for (uint32_t i = 0; i < m_parent.size(); ++i)
+			m_parent[i] = i;
+		for (const Contact<3, FloatT>& contact : _contacts)
+		{
+			const auto& [a, b] = _pairs[contact.pair];
+			ASSERT(a < _bodies.size() && b < _bodies.size(), "Pair refers to a missing body.");
+			if (!_bodies[a].isStatic() && !_bodies[b].isStatic())
+				m_parent[findRoot(a)] = findRoot(b);
+		}
+
+		// Islands are numbered in the order of their first contact and the constraints keep
+		// their order within an island, so the result does not depend on the scheduling.
+		m_islandOfRoot.assign(_bodies.size(), NO_ISLAND);
+		m_constraintIsland.clear();
+		m_unsorted.clear();
+		m_islandBegin.clear();
+		for (const Contact<3, FloatT>& contact : _contacts)
+		{
+			const auto& [a, b] = _pairs[contact.pair];
+			if (_bodies[a].isStatic() && _bodies[b].isStatic())
+				continue;
+			const uint32_t root = findRoot(_bodies[a].isStatic() ? b : a);
+			if (m_islandOfRoot[root] == NO_ISLAND)
+			{
+				m_islandOfRoot[root] = static_cast<uint32_t>(m_islandBegin.size());
+				m_islandBegin.push_back(0);
+			}
+			m_constraintIsland.push_back(m_islandOfRoot[root]);
+
+			Constraint& constraint = m_unsorted.emplace_back();
+			constraint.bodyA = a;
+			constraint.bodyB = b;
+			prepare(constraint, _bodies, contact, _dt);
+			constraint.key = (static_cast<uint64_t>(_bodies[a].id) << 32) | _bodies[b].id;
+			constraint.normalImpulse = 0;
+			constraint.tangentImpulse[0] = 0;
+			constraint.tangentImpulse[1] = 0;
+			// A pair may have multiple contacts, e.g. a body with the static world. Only the
+			// impulses of a contact with a similar normal are a good guess.
+			const auto cached = m_cache.find(constraint.key);
+			if (cached && glm::dot(cached.data().direction, constraint.normal) > static_cast<FloatT>(0.95))
+			{
+				const CachedImpulse& impulse = cached.data();
+				constraint.normalImpulse = impulse.normal;
+				constraint.tangentImpulse[0] = glm::dot(impulse.tangent, constraint.tangents[0]);
+				constraint.tangentImpulse[1] = glm::dot(impulse.tangent, constraint.tangents[1]);
+			}
+		}
+
+		// counting sort by island
+		const size_t numIslands = m_islandBegin.size();
+		for (uint32_t island : m_constraintIsland)
+			++m_islandBegin[island];
+		uint32_t offset = 0;
+		for (uint32_t& begin : m_islandBegin)
+		{
+			const uint32_t count = begin;
+			begin = offset;
+			offset += count;
+		}
+		m_islandBegin.push_back(offset);
+		m_constraints.resize(m_unsorted.size());
+		{
+			std::vector<uint32_t>& next = m_islandOfRoot; // reused as write position per island
+			next.assign(m_islandBegin.begin(), m_islandBegin.end() - 1);
+			for (size_t i = 0; i < m_unsorted.size(); ++i)
+				m_constraints[next[m_constraintIsland[i]]++] = m_unsorted[i];
+		}
+
+		_threadPool.parallelFor(0, numIslands, [&](size_t _begin, size_t _end)
+		{
+			for (size_t island = _begin; island < _end; ++island)
+				solveIsland(_bodies, island);
+		});
+
+		m_cache.clear();
+		for (const Constraint& constraint : m_constraints)
+		{
+			m_cache.add(constraint.key, CachedImpulse{ constraint.normal, constraint.normalImpulse,
+				constraint.tangents[0] * constraint.tangentImpulse[0] + constraint.tangents[1] * constraint.tangentImpulse[1] });
+		}
+	}
+}
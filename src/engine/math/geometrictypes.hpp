@@ -4,6 +4,7 @@
 
 #include <glm/glm.hpp>
 #include <cstdint>
+#include <cmath>
 
 namespace math {
 
@@ -87,6 +88,32 @@ namespace math {
 	using AABB = Box<Dim, FloatT>;
 	using AABB2D = AABB<2>;
 
+	// Smallest axis aligned box which contains _box after an affine transformation,
+	// e.g. the transformation matrix of an object. Exact for rotations and non-uniform
+	// scaling and without branches (Arvo, "Transforming Axis-Aligned Bounding Boxes", 1990):
+	// The center is transformed as a point and the half size by the absolute linear part.
+	template<unsigned Dim, typename FloatT>
+	Box<Dim, FloatT> transform(const Box<Dim, FloatT>& _box, const glm::mat<Dim + 1, Dim + 1, FloatT, glm::defaultp>& _transform)
+	{
+		using VecT = typename Box<Dim, FloatT>::VecT;
+		const VecT center = (_box.min + _box.max) * static_cast<FloatT>(0.5);
+		const VecT halfSize = (_box.max - _box.min) * static_cast<FloatT>(0.5);
+
+		VecT newCenter;
+		VecT newHalfSize(0);
+		for (unsigned i = 0; i < Dim; ++i)
+			newCenter[i] = _transform[Dim][i];
+		for (unsigned j = 0; j < Dim; ++j)
+		{
+			for (unsigned i = 0; i < Dim; ++i)
+			{
+				newCenter[i] += _transform[j][i] * center[j];
+				newHalfSize[i] += std::abs(_transform[j][i]) * halfSize[j];
+			}
+		}
+		return Box<Dim, FloatT>(newCenter - newHalfSize, newCenter + newHalfSize);
+	}
+
 	template<unsigned Dim, typename FloatT>
 	struct HyperSphere
 	{
@@ -124,4 +151,53 @@ namespace math {
 	};
 
 	using Ray2D = Ray<2, float>;
+
+	// Line segment from a to b extended by radius in all directions.
+	template<unsigned Dim, typename FloatT>
+	struct Capsule
+	{
+		using VecT = glm::vec<Dim, FloatT, glm::defaultp>;
+
+		VecT a;
+		VecT b;
+		FloatT radius;
+
+		Capsule(const VecT& _a, const VecT& _b, FloatT _radius) noexcept
+			: a(_a), b(_b), radius(_radius) {}
+	};
+
+	// Box with arbitrary orientation in 3D.
+	template<typename FloatT = float>
+	struct OrientedBox
+	{
+		using VecT = glm::vec<3, FloatT, glm::defaultp>;
+		using MatT = glm::mat<3, 3, FloatT, glm::defaultp>;
+
+		VecT center;
+		VecT halfSize;
+		MatT axes; ///< orthonormal local axes as columns
+
+		OrientedBox(const VecT& _center, const VecT& _halfSize, const MatT& _axes) noexcept
+			: center(_center), halfSize(_halfSize), axes(_axes) {}
+
+		/// \brief Transform a box in local space, e.g. a collider, with an affine transformation
+		///		without shear.
+		OrientedBox(const Box<3, FloatT>& _box, const glm::mat<4, 4, FloatT, glm::defaultp>& _transform) noexcept
+		{
+			const VecT localCenter = (_box.min + _box.max) * static_cast<FloatT>(0.5);
+			center = VecT(_transform * glm::vec<4, FloatT, glm::defaultp>(localCenter, 1));
+			for (int i = 0; i < 3; ++i)
+			{
+				const VecT axis(_transform[i]);
+				const FloatT scale = glm::length(axis);
+				if (scale > 0) axes[i] = axis / scale;
+				else
+				{
+					axes[i] = VecT(0);
+					axes[i][i] = 1;
+				}
+				halfSize[i] = (_box.max[i] - _box.min[i]) * static_cast<FloatT>(0.5) * scale;
+			}
+		}
+	};
 }
\ No newline at end of file
@@ -0,0 +1,446 @@
+#pragma once
+
+#include "../utils/threadpool.hpp"
+#include "../utils/assert.hpp"
+#include <glm/glm.hpp>
+#include <memory_resource>
+#include <vector>
+#include <array>
+#include <span>
+#include <limits>
+#include <cmath>
+#include <cinttypes>
+#include <type_traits>
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace math {
+
+	// Barnes-Hut approximation of the gravitational accelerations between many bodies.
+	// The bodies are sorted into an octree whose nodes know their total mass and center of
+	// mass. A node which appears smaller than the opening angle from a body acts on it as a
+	// single mass, otherwise its childs are visited. This reduces the cost per body from
+	// O(n) to O(log n).
+	// The nodes are stored in depth first order and each node knows the index after its
+	// subtree, so the evaluation is a single loop without a stack.
+	// All accelerations are computed without the gravitational constant.
+	template<typename FloatT = float>
+	class BarnesHut
+	{
+	public:
+		using VecT = glm::vec<3, FloatT, glm::defaultp>;
+
+		/// @param _theta Opening angle: nodes with size / distance < _theta are not opened.
+		///		0 gives the exact sum, 0.5 is a common trade-off.
+		/// @param _softening Added to all distances to avoid singular forces of close bodies.
+		/// @param _resource Memory for the tree, e.g. utils::FrameArena::get() if it is
+		///		rebuilt every tick.
+		explicit BarnesHut(FloatT _theta = static_cast<FloatT>(0.5), FloatT _softening = 0,
+			std::pmr::memory_resource* _resource = std::pmr::get_default_resource())
+			: m_thetaSq(_theta * _theta), m_softeningSq(_softening * _softening),
+			m_nodes(_resource), m_positions(_resource), m_masses(_resource), m_order(_resource), m_buffer(_resource)
+		{}
+
+		/// @brief Replace the bodies of the tree.
+		void build(std::span<const VecT> _positions, std::span<const FloatT> _masses);
+
+		/// @brief Acceleration of each body due to all other bodies.
+		/// @param _accelerations Receives the result in the order of the bodies passed to build().
+		void computeAccelerations(std::span<VecT> _accelerations, utils::ThreadPool& _threadPool = utils::ThreadPool::get()) const;
+
+		/// @brief Acceleration due to all bodies at an arbitrary point.
+		VecT accelerationAt(const VecT& _point) const { return evaluate(_point, NO_BODY); }
+
+		size_t size() const { return m_positions.size(); }
+		size_t numNodes() const { return m_nodes.size(); }
+
+	private:
+		constexpr static uint32_t LEAF_SIZE = 8;
+		// Coincident bodies cannot be separated, so the depth is limited.
+		constexpr static int MAX_DEPTH = 32;
+		constexpr static uint32_t NO_BODY = std::numeric_limits<uint32_t>::max();
+
+		struct Node
+		{
+			VecT centerOfMass;
+			FloatT mass;
+			FloatT sizeSq; ///< squared edge length of the cell
+			uint32_t next; ///< index of the node after the subtree
+			uint32_t begin; ///< first body of the subtree
+			uint32_t end;
+			bool isLeaf;
+		};
+
+		void buildNode(std::span<const VecT> _positions, uint32_t _begin, uint32_t _end, const VecT& _center, FloatT _halfSize, int _depth);
+
+		// Sum over all bodies except the one with sorted index _self.
+		VecT evaluate(const VecT& _point, uint32_t _self) const;
+
+		void addBody(VecT& _acceleration, const VecT& _point, const VecT& _source, FloatT _mass) const
+		{
+			const VecT d = _source - _point;
+			const FloatT distSq = glm::dot(d, d) + m_softeningSq;
+			if (distSq <= 0) return;
+			const FloatT invDist = 1 / std::sqrt(distSq);
+			_acceleration += d * (_mass * invDist * invDist * invDist);
+		}
+
+		FloatT m_thetaSq;
+		FloatT m_softeningSq;
+		std::pmr::vector<Node> m_nodes;
+		std::pmr::vector<VecT> m_positions; ///< positions in tree order
+		std::pmr::vector<FloatT> m_masses; ///< masses in tree order
+		std::pmr::vector<uint32_t> m_order; ///< index in the input of each body in tree order
+		std::pmr::vector<uint32_t> m_buffer; ///< temporary for build
+	};
+
+	template<typename FloatT>
+	void BarnesHut<FloatT>::build(std::span<const VecT> _positions, std::span<const FloatT> _masses)
+	{
+		ASSERT(_positions.size() == _masses.size(), "Each body needs a mass.");
+
+		const uint32_t n = static_cast<uint32_t>(_positions.size());
+		m_nodes.clear();
+		m_positions.resize(n);
+		m_masses.resize(n);
+		m_order.resize(n);
+		m_buffer.resize(n);
+		if (!n) return;
+
+		VecT min = _positions[0];
+		VecT max = _positions[0];
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			min = glm::min(min, _positions[i]);
+			max = glm::max(max, _positions[i]);
+			m_order[i] = i;
+		}
+		const VecT extent = max - min;
+		const FloatT halfSize = std::max(std::max(extent.x, extent.y), std::max(extent.z, static_cast<FloatT>(0))) * static_cast<FloatT>(0.5);
+		buildNode(_positions, 0, n, (min + max) * static_cast<FloatT>(0.5), halfSize, 0);
+
+		// The masses are needed in tree order to compute the centers of mass bottom up.
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			m_positions[i] = _positions[m_order[i]];
+			m_masses[i] = _masses[m_order[i]];
+		}
+		for (size_t i = m_nodes.size(); i-- > 0;)
+		{
+			Node& node = m_nodes[i];
+			VecT weighted(0);
+			FloatT mass = 0;
+			if (node.isLeaf)
+			{
+				for (uint32_t j = node.begin; j < node.end; ++j)
+				{
+					weighted += m_positions[j] * m_masses[j];
+					mass += m_masses[j];
+				}
+			}
+			else
+			{
+				for (size_t c = i + 1; c < node.next; c = m_nodes[c].next)
+				{
+					weighted += m_nodes[c].centerOfMass * m_nodes[c].mass;
+					mass += m_nodes[c].mass;
+				}
+			}
+			node.mass = mass;
+			// massless nodes have no effect, any point will do
+			node.centerOfMass = mass > 0 ? weighted / mass : m_positions[node.begin];
+		}
+	}
+
+	template<typename FloatT>
+	void BarnesHut<FloatT>::buildNode(std::span<const VecT> _positions, uint32_t _begin, uint32_t _end,
+		const VecT& _center, FloatT _halfSize, int _depth)
+	{
+		const uint32_t idx = static_cast<uint32_t>(m_nodes.size());
+		m_nodes.push_back({ VecT(0), 0, 4 * _halfSize * _halfSize, 0, _begin, _end, false });
+		if (_end - _begin <= LEAF_SIZE || _depth >= MAX_DEPTH)
+		{
+			m_nodes[idx].isLeaf = true;
+			m_nodes[idx].next = idx + 1;
+			return;
+		}
+
+		// counting sort of the bodies into the octants
+		auto octant = [&](uint32_t _body)
+		{
+			const VecT& p = _positions[_body];
+			return (p.x > _center.x ? 1 : 0) | (p.y > _center.y ? 2 : 0) | (p.z > _center.z ? 4 : 0);
+		};
+		std::array<uint32_t, 9> offsets{};
+		for (uint32_t i = _begin; i < _end; ++i)
+			++offsets[octant(m_order[i]) + 1];
+		for (int c = 0; c < 8; ++c)
+			offsets[c + 1] += offsets[c];
+		std::array<uint32_t, 8> insert;
+		for (int c = 0; c < 8; ++c)
+			insert[c] = _begin + offsets[c];
+		for (uint32_t i = _begin; i < _end; ++i)
+		{
+			const uint32_t body = m_order[i];
+			m_buffer[insert[octant(body)]++] = body;
+		}
+		std::copy(m_buffer.begin() + _begin, m_buffer.begin() + _end, m_order.begin() + _begin);
+
+		const FloatT childHalfSize = _halfSize * static_cast<FloatT>(0.5);
+		for (int c = 0; c < 8; ++c)
+		{
+			const uint32_t childBegin = _begin + offsets[c];
+			const uint32_t childEnd = _begin + offsets[c + 1];
+			if (childBegin == childEnd) continue;
+
+			const VecT childCenter(
+				_center.x + (c & 1 ? childHalfSize : -childHalfSize),
+				_center.y + (c & 2 ? childHalfSize : -childHalfSize),
+				_center.z + (c & 4 ? childHalfSize : -childHalfSize));
+			buildNode(_positions, childBegin, childEnd, childCenter, childHalfSize, _depth + 1);
+		}
+		m_nodes[idx].next = static_cast<uint32_t>(m_nodes.size());
+	}
+
+	template<typename FloatT>
+	typename BarnesHut<FloatT>::VecT BarnesHut<FloatT>::evaluate(const VecT& _point, uint32_t _self) const
+	{
+		VecT acceleration(0);
+		uint32_t idx = 0;
+		while (idx < m_nodes.size())
+		{
+			const Node& node = m_nodes[idx];
+			const VecT d = node.centerOfMass - _point;
+			// A node which contains the body itself is always opened, otherwise the body
+			// would attract itself.
+			const bool open = node.sizeSq > m_thetaSq * glm::dot(d, d)
+				|| (_self >= node.begin && _self < node.end);
+			if (!open)
+			{
+				addBody(acceleration, _point, node.centerOfMass, node.mass);
+			}
+			else if (node.isLeaf)
+			{
+				for (uint32_t j = node.begin; j < node.end; ++j)
+					if (j != _self) addBody(acceleration, _point, m_positions[j], m_masses[j]);
+			}
+			else
+			{
+				++idx;
+				continue;
+			}
+			idx = node.next;
+		}
+		return acceleration;
+	}
+
+	template<typename FloatT>
+	void BarnesHut<FloatT>::computeAccelerations(std::span<VecT> _accelerations, utils::ThreadPool& _threadPool) const
+	{
+		ASSERT(_accelerations.size() == m_positions.size(), "One acceleration per body required.");
+
+		// Bodies in tree order are close to each other, so neighbouring evaluations visit
+		// mostly the same nodes.
+		_threadPool.parallelFor(0, m_positions.size(), [&](size_t _begin, size_t _end)
+		{
+			for (size_t i = _begin; i < _end; ++i)
+				_accelerations[m_order[i]] = evaluate(m_positions[i], static_cast<uint32_t>(i));
+		}, 256);
+	}
+
+	// Exact sum of the gravitational accelerations between all pairs of bodies.
+	// For up to a few thousand bodies this is faster than the tree of BarnesHut.
+	// The bodies are stored as structure of arrays, padded to a multiple of LANES with
+	// massless bodies. With AVX each pass computes a tile of 4 bodies against LANES
+	// bodies at once, so that every load is used four times. Double precision and builds
+	// without AVX use a scalar loop.
+	// All accelerations are computed without the gravitational constant.
+	template<typename FloatT = float>
+	class DirectSum
+	{
+	public:
+		using VecT = glm::vec<3, FloatT, glm::defaultp>;
+		constexpr static size_t LANES = 8;
+
+		/// @param _softening Added to all distances to avoid singular forces of close bodies.
+		/// @param _vectorized Use the SIMD kernel if available. The scalar kernel is
+		///		slower but exists for comparison.
+		explicit DirectSum(FloatT _softening = 0, bool _vectorized = true,
+			std::pmr::memory_resource* _resource = std::pmr::get_default_resource())
+			: m_softeningSq(_softening * _softening), m_vectorized(_vectorized),
+			m_x(_resource), m_y(_resource), m_z(_resource), m_masses(_resource)
+		{}
+
+		/// @brief Replace the bodies.
+		void build(std::span<const VecT> _positions, std::span<const FloatT> _masses);
+
+		/// @brief Acceleration of each body due to all other bodies.
+		/// @param _accelerations Receives the result in the order of the bodies passed to build().
+		void computeAccelerations(std::span<VecT> _accelerations, utils::ThreadPool& _threadPool = utils::ThreadPool::get()) const;
+
+		size_t size() const { return m_size; }
+
+	private:
+		constexpr static size_t TILE = 4;
+
+		void computeScalar(std::span<VecT> _accelerations, size_t _begin, size_t _end) const;
+#if defined(__AVX__)
+		void computeAVX(std::span<VecT> _accelerations, size_t _begin, size_t _end) const;
+#endif
+
+		FloatT m_softeningSq;
+		bool m_vectorized;
+		size_t m_size = 0;
+		std::pmr::vector<FloatT> m_x;
+		std::pmr::vector<FloatT> m_y;
+		std::pmr::vector<FloatT> m_z;
+		std::pmr::vector<FloatT> m_masses;
+	};
+
+	template<typename FloatT>
+	void DirectSum<FloatT>::build(std::span<const VecT> _positions, std::span<const FloatT> _masses)
+	{
+		ASSERT(_positions.size() == _masses.size(), "Each body needs a mass.");
+
+		m_size = _positions.size();
+		const size_t padded = (m_size + LANES - 1) / LANES * LANES;
+		// The padding is at the origin without mass, so it adds nothing.
+		m_x.assign(padded, 0);
+		m_y.assign(padded, 0);
+		m_z.assign(padded, 0);
+		m_masses.assign(padded, 0);
+		for (size_t i = 0; i < m_size; ++i)
+		{
+			m_x[i] = _positions[i].x;
+			m_y[i] = _positions[i].y;
+			m_z[i] = _positions[i].z;
+			m_masses[i] = _masses[i];
+		}
+	}
+
+	template<typename FloatT>
+	void DirectSum<FloatT>::computeAccelerations(std::span<VecT> _accelerations, utils::ThreadPool& _threadPool) const
+	{
+		ASSERT(_accelerations.size() == m_size, "One acceleration per body required.");
+
+		// Work is split into whole tiles, each costs about m_size interactions per body.
+		const size_t numTiles = (m_size + TILE - 1) / TILE;
+		_threadPool.parallelFor(0, numTiles, [&](size_t _begin, size_t _end)
+		{
+			const size_t begin = _begin * TILE;
+			const size_t end = std::min(_end * TILE, m_size);
+#if defined(__AVX__)
+			if constexpr (std::is_same_v<FloatT, float>)
+			{
+				if (m_vectorized)
+				{
+					computeAVX(_accelerations, begin, end);
+					return;
+				}
+			}
+#endif
+			computeScalar(_accelerations, begin, end);
+		}, std::max<size_t>(1, 16384 / (m_size + 1)));
+	}
+
+	template<typename FloatT>
+	void DirectSum<FloatT>::computeScalar(std::span<VecT> _accelerations, size_t _begin, size_t _end) const
+	{
+		for (size_t i = _begin; i < _end; ++i)
+		{
+			const FloatT x = m_x[i];
+			const FloatT y = m_y[i];
+			const FloatT z = m_z[i];
+			FloatT ax = 0;
+			FloatT ay = 0;
+			FloatT az = 0;
+			for (size_t j = 0; j < m_masses.size(); ++j)
+			{
+				const FloatT dx = m_x[j] - x;
+				const FloatT dy = m_y[j] - y;
+				const FloatT dz = m_z[j] - z;
+				const FloatT distSq = dx * dx + dy * dy + dz * dz + m_softeningSq;
+				// the body itself
+				if (distSq <= 0) continue;
+				const FloatT invDist = 1 / std::sqrt(distSq);
+				const FloatT s = m_masses[j] * invDist * invDist * invDist;
+				ax += dx * s;
+				ay += dy * s;
+				az += dz * s;
+			}
+			_accelerations[i] = VecT(ax, ay, az);
+		}
+	}
+
+#if defined(__AVX__)
+	template<typename FloatT>
+	void DirectSum<FloatT>::computeAVX(std::span<VecT> _accelerations, size_t _begin, size_t _end) const
+	{
+		auto fmadd = [](__m256 _a, __m256 _b, __m256 _c)
+		{
+#if defined(__FMA__)
+			return _mm256_fmadd_ps(_a, _b, _c);
+#else
+			return _mm256_add_ps(_mm256_mul_ps(_a, _b), _c);
+#endif
+		};
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 half = _mm256_set1_ps(0.5f);
+		const __m256 threeHalfs = _mm256_set1_ps(1.5f);
+		const __m256 softeningSq = _mm256_set1_ps(m_softeningSq);
+
+		// _begin is a multiple of TILE and the arrays are padded, so whole tiles can be read.
+		for (size_t i = _begin; i < _end; i += TILE)
+		{
+			__m256 x[TILE], y[TILE], z[TILE], ax[TILE], ay[TILE], az[TILE];
+			for (size_t t = 0; t < TILE; ++t)
+			{
+				x[t] = _mm256_set1_ps(m_x[i + t]);
+				y[t] = _mm256_set1_ps(m_y[i + t]);
+				z[t] = _mm256_set1_ps(m_z[i + t]);
+				ax[t] = ay[t] = az[t] = zero;
+			}
+
+			for (size_t j = 0; j < m_masses.size(); j += LANES)
+			{
+				const __m256 xj = _mm256_loadu_ps(m_x.data() + j);
+				const __m256 yj = _mm256_loadu_ps(m_y.data() + j);
+				const __m256 zj = _mm256_loadu_ps(m_z.data() + j);
+				const __m256 mj = _mm256_loadu_ps(m_masses.data() + j);
+				for (size_t t = 0; t < TILE; ++t)
+				{
+					const __m256 dx = _mm256_sub_ps(xj, x[t]);
+					const __m256 dy = _mm256_sub_ps(yj, y[t]);
+					const __m256 dz = _mm256_sub_ps(zj, z[t]);
+					const __m256 distSq = fmadd(dx, dx, fmadd(dy, dy, fmadd(dz, dz, softeningSq)));
+					// approximate 1/sqrt refined by one Newton step
+					__m256 invDist = _mm256_rsqrt_ps(distSq);
+					const __m256 halfDistSq = _mm256_mul_ps(half, distSq);
+					invDist = _mm256_mul_ps(invDist, _mm256_sub_ps(threeHalfs, _mm256_mul_ps(halfDistSq, _mm256_mul_ps(invDist, invDist))));
+					// the body itself has distance 0
+					invDist = _mm256_and_ps(invDist, _mm256_cmp_ps(distSq, zero, _CMP_GT_OQ));
+					const __m256 s = _mm256_mul_ps(mj, _mm256_mul_ps(invDist, _mm256_mul_ps(invDist, invDist)));
+					ax[t] = fmadd(dx, s, ax[t]);
+					ay[t] = fmadd(dy, s, ay[t]);
+					az[t] = fmadd(dz, s, az[t]);
+				}
+			}
+
+			for (size_t t = 0; t < TILE && i + t < _end; ++t)
+			{
+				alignas(32) float sums[3][LANES];
+				_mm256_store_ps(sums[0], ax[t]);
+				_mm256_store_ps(sums[1], ay[t]);
+				_mm256_store_ps(sums[2], az[t]);
+				VecT acceleration(0.f);
+				for (size_t l = 0; l < LANES; ++l)
+					acceleration += VecT(sums[0][l], sums[1][l], sums[2][l]);
+				_accelerations[i + t] = acceleration;
+			}
+		}
+	}
+#endif
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "../utils/assert.hpp"
+#include <glm/glm.hpp>
+#include <memory_resource>
+#include <vector>
+#include <span>
+
+namespace math {
+
+	// Methods to advance positions and velocities under an acceleration which depends on
+	// the state.
+	enum class Integrator
+	{
+		/// Kick then drift. First order, but symplectic. One evaluation per step.
+		SemiImplicitEuler,
+		/// Kick, drift, kick. Second order and symplectic. Two evaluations per step,
+		/// because the acceleration of the last step is not kept.
+		VelocityVerlet,
+		/// Drift, kick, drift. Second order and symplectic with one evaluation per step.
+		/// The best choice for conservative forces like gravity.
+		Leapfrog,
+		/// Classic Runge-Kutta. Fourth order, but not symplectic, so the energy of orbits
+		/// slowly drifts. Suited for accelerations which depend on the velocity, e.g. drag.
+		RK4
+	};
+
+	/// @brief Advance all bodies by one step of _dt.
+	/// @param _acceleration Called as _acceleration(positions, velocities, accelerations) and has
+	///		to fill accelerations for the given state. The spans have the size of _positions.
+	/// @param _resource Memory for the temporary states, e.g. utils::FrameArena::get().
+	template<typename VecT, typename FloatT, typename AccelerationFn>
+	void integrate(Integrator _integrator, std::span<VecT> _positions, std::span<VecT> _velocities, FloatT _dt,
+		AccelerationFn&& _acceleration, std::pmr::memory_resource* _resource = std::pmr::get_default_resource())
+	{
+		ASSERT(_positions.size() == _velocities.size(), "Each body needs a velocity.");
+
+		const size_t n = _positions.size();
+		const FloatT halfDt = _dt / 2;
+		std::pmr::vector<VecT> accelerations(n, _resource);
+		auto evaluate = [&](std::span<const VecT> _x, std::span<const VecT> _v, std::span<VecT> _a)
+		{
+			_acceleration(_x, _v, _a);
+		};
+
+		switch (_integrator)
+		{
+		case Integrator::SemiImplicitEuler:
+			evaluate(_positions, _velocities, accelerations);
+			for (size_t i = 0; i < n; ++i)
+			{
+				_velocities[i] += accelerations[i] * _dt;
+				_positions[i] += _velocities[i] * _dt;
+			}
+			break;
+		case Integrator::VelocityVerlet:
+			evaluate(_positions, _velocities, accelerations);
+			for (size_t i = 0; i < n; ++i)
+			{
+				_velocities[i] += accelerations[i] * halfDt;
+				_positions[i] += _velocities[i] * _dt;
+			}
+			evaluate(_positions, _velocities, accelerations);
+			for (size_t i = 0; i < n; ++i)
+				_velocities[i] += accelerations[i] * halfDt;
+			break;
+		case Integrator::Leapfrog:
+			for (size_t i = 0; i < n; ++i)
+				_positions[i] += _velocities[i] * halfDt;
+			evaluate(_positions, _velocities, accelerations);
+			for (size_t i = 0; i < n; ++i)
+			{
+				_velocities[i] += accelerations[i] * _dt;
+				_positions[i] += _velocities[i] * halfDt;
+			}
+			break;
+		case Integrator::RK4:
+		{
+			// Each stage k has the derivatives (velocity, acceleration) at a trial state.
+			// The sum of the weighted stages is accumulated in dx and dv.
+			std::pmr::vector<VecT> x(n, _resource);
+			std::pmr::vector<VecT> v(n, _resource);
+			std::pmr::vector<VecT> dx(n, _resource);
+			std::pmr::vector<VecT> dv(n, _resource);
+
+			evaluate(_positions, _velocities, accelerations);
+			for (size_t i = 0; i < n; ++i)
+			{
+				dx[i] = _velocities[i];
+				dv[i] = accelerations[i];
+				x[i] = _positions[i] + _velocities[i] * halfDt;
+				v[i] = _velocities[i] + accelerations[i] * halfDt;
+			}
+			const FloatT stageDt[2] = { halfDt, _dt };
+			for (int stage = 0; stage < 2; ++stage)
+			{
+				evaluate(x, v, accelerations);
+				for (size_t i = 0; i < n; ++i)
+				{
+					dx[i] += v[i] * static_cast<FloatT>(2);
+					dv[i] += accelerations[i] * static_cast<FloatT>(2);
+					const VecT velocity = v[i];
+					x[i] = _positions[i] + velocity * stageDt[stage];
+					v[i] = _velocities[i] + accelerations[i] * stageDt[stage];
+				}
+			}
+			evaluate(x, v, accelerations);
+			const FloatT sixthDt = _dt / 6;
+			for (size_t i = 0; i < n; ++i)
+			{
+				_positions[i] += (dx[i] + v[i]) * sixthDt;
+				_velocities[i] += (dv[i] + accelerations[i]) * sixthDt;
+			}
+			break;
+		}
+		}
+	}
+}
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "geometrictypes.hpp"
 #include <glm/glm.hpp>
 #include <optional>
+#include <limits>
+#include <utility>
+#include <cmath>
 
 namespace math {
 
@@ -31,4 +35,95 @@ namespace math {
 
 		return {};
 	}
+
+	// Slab test of a ray against a box with the precomputed inverse of the ray direction.
+	// Returns the distance to the entry point in multiples of the direction, or 0 if the
+	// origin is inside the box. Only intersections within [0, _maxDistance] are reported.
+	template<unsigned Dim, typename FloatT>
+	constexpr std::optional<FloatT> intersect(
+		const typename Box<Dim, FloatT>::VecT& _origin,
+		const typename Box<Dim, FloatT>::VecT& _invDirection,
+		const Box<Dim, FloatT>& _box,
+		FloatT _maxDistance = std::numeric_limits<FloatT>::max())
+	{
+		FloatT tMin = 0;
+		FloatT tMax = _maxDistance;
+		for (unsigned i = 0; i < Dim; ++i)
+		{
+			// parallel to the slab
+			if (_invDirection[i] == std::numeric_limits<FloatT>::infinity()
+				|| _invDirection[i] == -std::numeric_limits<FloatT>::infinity())
+			{
+				if (_origin[i] < _box.min[i] || _origin[i] > _box.max[i]) return {};
+				continue;
+			}
+
+			FloatT t0 = (_box.min[i] - _origin[i]) * _invDirection[i];
+			FloatT t1 = (_box.max[i] - _origin[i]) * _invDirection[i];
+			if (t0 > t1) std::swap(t0, t1);
+			if (t0 > tMin) tMin = t0;
+			if (t1 < tMax) tMax = t1;
+			if (tMin > tMax) return {};
+		}
+		return tMin;
+	}
+
+	template<unsigned Dim, typename FloatT>
+	constexpr std::optional<FloatT> intersect(const Ray<Dim, FloatT>& _ray, const Box<Dim, FloatT>& _box,
+		FloatT _maxDistance = std::numeric_limits<FloatT>::max())
+	{
+		return intersect(_ray.origin, typename Box<Dim, FloatT>::VecT(1) / _ray.direction, _box, _maxDistance);
+	}
+
+	// Squared distance of a point to the closest point of the box; 0 if it is inside.
+	template<unsigned Dim, typename FloatT>
+	constexpr FloatT distanceSq(const typename Box<Dim, FloatT>::VecT& _point, const Box<Dim, FloatT>& _box)
+	{
+		FloatT dist = 0;
+		for (unsigned i = 0; i < Dim; ++i)
+		{
+			const FloatT d = _point[i] < _box.min[i] ? _box.min[i] - _point[i]
+				: (_point[i] > _box.max[i] ? _point[i] - _box.max[i] : 0);
+			dist += d * d;
+		}
+		return dist;
+	}
+
+	// Time of impact in [0, 1] of a box moving by _displacement against a static box; 0 if they
+	// overlap at the start. For two moving boxes pass the relative displacement.
+	// The moving box shrinks to its center and the target grows by the same amount, which
+	// turns the sweep into a ray test.
+	template<unsigned Dim, typename FloatT>
+	std::optional<FloatT> sweep(const Box<Dim, FloatT>& _moving,
+		const typename Box<Dim, FloatT>::VecT& _displacement, const Box<Dim, FloatT>& _target)
+	{
+		using VecT = typename Box<Dim, FloatT>::VecT;
+		const VecT halfSize = (_moving.max - _moving.min) * static_cast<FloatT>(0.5);
+		const Box<Dim, FloatT> expanded(_target.min - halfSize, _target.max + halfSize);
+		return intersect<Dim, FloatT>(_moving.min + halfSize, VecT(1) / _displacement, expanded, static_cast<FloatT>(1));
+	}
+
+	// Time of impact in [0, 1] of a sphere moving by _displacement against a static sphere; 0 if
+	// they overlap at the start.
+	template<unsigned Dim, typename FloatT>
+	std::optional<FloatT> sweep(const HyperSphere<Dim, FloatT>& _moving,
+		const typename HyperSphere<Dim, FloatT>::VecT& _displacement, const HyperSphere<Dim, FloatT>& _target)
+	{
+		// smallest t with |s + t * d| = r
+		const auto s = _moving.center - _target.center;
+		const FloatT radius = _moving.radius + _target.radius;
+		const FloatT c = glm::dot(s, s) - radius * radius;
+		if (c <= 0) return static_cast<FloatT>(0);
+
+		const FloatT b = glm::dot(s, _displacement);
+		// moving apart
+		if (b >= 0) return {};
+		const FloatT a = glm::dot(_displacement, _displacement);
+		const FloatT discriminant = b * b - a * c;
+		if (discriminant < 0) return {};
+
+		const FloatT t = (-b - std::sqrt(discriminant)) / a;
+		if (t > 1) return {};
+		return t;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,384 @@
+#pragma once
+
+#include "geometrictypes.hpp"
+#include <glm/glm.hpp>
+#include <optional>
+#include <span>
+#include <utility>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cinttypes>
+
+namespace math {
+
+	// Narrow phase tests which generate a contact for overlapping shapes.
+	// The normal points from the first to the second shape, so moving the second shape by
+	// normal * depth separates them. Each test reports a single contact at the deepest
+	// point, located midway between the two surfaces.
+	template<unsigned Dim, typename FloatT>
+	struct Contact
+	{
+		using VecT = glm::vec<Dim, FloatT, glm::defaultp>;
+
+		VecT point;
+		VecT normal;
+		FloatT depth;
+		uint32_t pair = 0; ///< index of the pair in collidePairs()
+	};
+
+	namespace details {
+		// Parameter in [0,1] of the point on the segment a-b which is closest to _point.
+		template<typename VecT, typename FloatT = typename VecT::value_type>
+		FloatT closestOnSegment(const VecT& _point, const VecT& _a, const VecT& _b)
+		{
+			const VecT ab = _b - _a;
+			const FloatT lenSq = glm::dot(ab, ab);
+			if (lenSq <= 0) return 0;
+			return std::clamp(glm::dot(_point - _a, ab) / lenSq, static_cast<FloatT>(0), static_cast<FloatT>(1));
+		}
+
+		// Closest points of the segments p1-q1 and p2-q2.
+		// See Ericson, "Real-Time Collision Detection", 5.1.9.
+		template<typename VecT, typename FloatT = typename VecT::value_type>
+		std::pair<VecT, VecT> closestPoints(const VecT& _p1, const VecT& _q1, const VecT& _p2, const VecT& _q2)
+		{
+			constexpr FloatT EPS = std::numeric_limits<FloatT>::epsilon();
+			constexpr FloatT ZERO = 0;
+			constexpr FloatT ONE = 1;
+
+			const VecT d1 = _q1 - _p1;
+			const VecT d2 = _q2 - _p2;
+			const VecT r = _p1 - _p2;
+			const FloatT a = glm::dot(d1, d1);
+			const FloatT e = glm::dot(d2, d2);
+			const FloatT f = glm::dot(d2, r);
+
+			if (a <= EPS && e <= EPS) return { _p1, _p2 };
+
+			FloatT s;
+			FloatT t;
+			if (a <= EPS)
+			{
+				s = 0;
+				t = std::clamp(f / e, ZERO, ONE);
+			}
+			else
+			{
+				const FloatT c = glm::dot(d1, r);
+				if (e <= EPS)
+				{
+					t = 0;
+					s = std::clamp(-c / a, ZERO, ONE);
+				}
+				else
+				{
+					const FloatT b = glm::dot(d1, d2);
+					const FloatT denom = a * e - b * b;
+					// parallel segments: any s works, t is fixed below
+					s = denom != 0 ? std::clamp((b * f - c * e) / denom, ZERO, ONE) : ZERO;
+					t = (b * s + f) / e;
+					if (t < 0)
+					{
+						t = 0;
+						s = std::clamp(-c / a, ZERO, ONE);
+					}
+					else if (t > 1)
+					{
+						t = 1;
+						s = std::clamp((b - c) / a, ZERO, ONE);
+					}
+				}
+			}
+			return { _p1 + d1 * s, _p2 + d2 * t };
+		}
+
+		template<unsigned Dim, typename FloatT>
+		std::optional<Contact<Dim, FloatT>> spheres(const typename Contact<Dim, FloatT>::VecT& _centerA, FloatT _radiusA,
+			const typename Contact<Dim, FloatT>::VecT& _centerB, FloatT _radiusB)
+		{
+			const typename Contact<Dim, FloatT>::VecT d = _centerB - _centerA;
+			const FloatT distSq = glm::dot(d, d);
+			const FloatT radius = _radiusA + _radiusB;
+			if (distSq > radius * radius) return {};
+
+			Contact<Dim, FloatT> contact;
+			const FloatT dist = std::sqrt(distSq);
+			if (dist > 0) contact.normal = d / dist;
+			else
+			{
+				// concentric, any direction separates the spheres
+				contact.normal = d * static_cast<FloatT>(0);
+				contact.normal[0] = 1;
+			}
+			contact.depth = radius - dist;
+			contact.point = _centerA + contact.normal * (_radiusA - contact.depth * static_cast<FloatT>(0.5));
+			return contact;
+		}
+
+		template<unsigned Dim, typename FloatT>
+		std::optional<Contact<Dim, FloatT>> flip(std::optional<Contact<Dim, FloatT>> _contact)
+		{
+			if (_contact) _contact->normal = -_contact->normal;
+			return _contact;
+		}
+
+		// Coordinates of _point in the local frame of the box.
+		template<typename FloatT>
+		glm::vec<3, FloatT, glm::defaultp> toLocal(const glm::vec<3, FloatT, glm::defaultp>& _point, const OrientedBox<FloatT>& _box)
+		{
+			const auto rel = _point - _box.center;
+			return { glm::dot(rel, _box.axes[0]), glm::dot(rel, _box.axes[1]), glm::dot(rel, _box.axes[2]) };
+		}
+
+		// Signed distance of _point to the surface of the box, negative inside.
+		// The function is convex in _point.
+		template<typename FloatT>
+		FloatT signedDistance(const glm::vec<3, FloatT, glm::defaultp>& _point, const OrientedBox<FloatT>& _box)
+		{
+			const auto q = glm::abs(toLocal(_point, _box)) - _box.halfSize;
+			const FloatT outside = glm::length(glm::max(q, glm::vec<3, FloatT, glm::defaultp>(0)));
+			const FloatT inside = std::min(std::max(q[0], std::max(q[1], q[2])), static_cast<FloatT>(0));
+			return outside + inside;
+		}
+
+		// -1, 0 or 1 where values close to 0 count as 0.
+		template<typename FloatT>
+		FloatT sign(FloatT _value)
+		{
+			constexpr FloatT EPS = static_cast<FloatT>(1e-6);
+			return _value > EPS ? static_cast<FloatT>(1) : (_value < -EPS ? static_cast<FloatT>(-1) : static_cast<FloatT>(0));
+		}
+	}
+
+	template<unsigned Dim, typename FloatT>
+	std::optional<Contact<Dim, FloatT>> collide(const HyperSphere<Dim, FloatT>& _a, const HyperSphere<Dim, FloatT>& _b)
+	{
+		return details::spheres<Dim, FloatT>(_a.center, _a.radius, _b.center, _b.radius);
+	}
+
+	template<unsigned Dim, typename FloatT>
+	std::optional<Contact<Dim, FloatT>> collide(const Capsule<Dim, FloatT>& _a, const HyperSphere<Dim, FloatT>& _b)
+	{
+		const FloatT t = details::closestOnSegment(_b.center, _a.a, _a.b);
+		return details::spheres<Dim, FloatT>(_a.a + (_a.b - _a.a) * t, _a.radius, _b.center, _b.radius);
+	}
+
+	template<unsigned Dim, typename FloatT>
+	std::optional<Contact<Dim, FloatT>> collide(const HyperSphere<Dim, FloatT>& _a, const Capsule<Dim, FloatT>& _b)
+	{
+		return details::flip(collide(_b, _a));
+	}
+
+	template<unsigned Dim, typename FloatT>
+	std::optional<Contact<Dim, FloatT>> collide(const Capsule<Dim, FloatT>& _a, const Capsule<Dim, FloatT>& _b)
+	{
+		const auto [pointA, pointB] = details::closestPoints(_a.a, _a.b, _b.a, _b.b);
+		return details::spheres<Dim, FloatT>(pointA, _a.radius, pointB, _b.radius);
+	}
+
+	template<typename FloatT>
+	std::optional<Contact<3, FloatT>> collide(const HyperSphere<3, FloatT>& _a, const OrientedBox<FloatT>& _b)
+	{
+		using VecT = glm::vec<3, FloatT, glm::defaultp>;
+		constexpr FloatT HALF = static_cast<FloatT>(0.5);
+
+		const VecT local = details::toLocal(_a.center, _b);
+		const VecT clamped = glm::clamp(local, -_b.halfSize, _b.halfSize);
+		Contact<3, FloatT> contact;
+		if (clamped != local)
+		{
+			const VecT closest = _b.center + _b.axes * clamped;
+			const VecT d = closest - _a.center;
+			const FloatT distSq = glm::dot(d, d);
+			if (distSq > _a.radius * _a.radius) return {};
+
+			const FloatT dist = std::sqrt(distSq);
+			if (dist > 0)
+			{
+				contact.normal = d / dist;
+				contact.depth = _a.radius - dist;
+				contact.point = (_a.center + contact.normal * _a.radius + closest) * HALF;
+				return contact;
+			}
+		}
+
+		// The center is inside, push the sphere out through the closest face.
+		int axis = 0;
+		for (int i = 1; i < 3; ++i)
+			if (_b.halfSize[i] - std::abs(local[i]) < _b.halfSize[axis] - std::abs(local[axis])) axis = i;
+		const FloatT faceDist = _b.halfSize[axis] - std::abs(local[axis]);
+		contact.normal = local[axis] < 0 ? _b.axes[axis] : -_b.axes[axis];
+		contact.depth = _a.radius + faceDist;
+		contact.point = _a.center + contact.normal * ((_a.radius - faceDist) * HALF);
+		return contact;
+	}
+
+	template<typename FloatT>
+	std::optional<Contact<3, FloatT>> collide(const OrientedBox<FloatT>& _a, const HyperSphere<3, FloatT>& _b)
+	{
+		return details::flip(collide(_b, _a));
+	}
+
+	// The contact is the one of the sphere around the point of the segment which is deepest
+	// inside the box.
+	template<typename FloatT>
+	std::optional<Contact<3, FloatT>> collide(const Capsule<3, FloatT>& _a, const OrientedBox<FloatT>& _b)
+	{
+		// The signed distance is convex along the segment, so a ternary search finds its minimum.
+		FloatT lo = 0;
+		FloatT hi = 1;
+		const auto dir = _a.b - _a.a;
+		for (int i = 0; i < 32; ++i)
+		{
+			const FloatT t1 = lo + (hi - lo) / 3;
+			const FloatT t2 = hi - (hi - lo) / 3;
+			if (details::signedDistance(_a.a + dir * t1, _b) < details::signedDistance(_a.a + dir * t2, _b)) hi = t2;
+			else lo = t1;
+		}
+		return collide(HyperSphere<3, FloatT>(_a.a + dir * ((lo + hi) * static_cast<FloatT>(0.5)), _a.radius), _b);
+	}
+
+	template<typename FloatT>
+	std::optional<Contact<3, FloatT>> collide(const OrientedBox<FloatT>& _a, const Capsule<3, FloatT>& _b)
+	{
+		return details::flip(collide(_b, _a));
+	}
+
+	// Separating axis test with the 3 face normals of each box and the 9 cross products of
+	// their edges (Gottschalk et al., "OBBTree", 1996). The axis of minimal overlap is the
+	// contact normal; face axes are preferred over nearly equal edge axes for stable contacts.
+	template<typename FloatT>
+	std::optional<Contact<3, FloatT>> collide(const OrientedBox<FloatT>& _a, const OrientedBox<FloatT>& _b)
+	{
+		using VecT = glm::vec<3, FloatT, glm::defaultp>;
+		// counters arithmetic errors for nearly parallel edges
+		constexpr FloatT EPS = static_cast<FloatT>(1e-6);
+		constexpr FloatT EDGE_BIAS = static_cast<FloatT>(0.95);
+		constexpr FloatT HALF = static_cast<FloatT>(0.5);
+
+		// rotation of b in the frame of a
+		FloatT rot[3][3];
+		FloatT absRot[3][3];
+		for (int i = 0; i < 3; ++i)
+			for (int j = 0; j < 3; ++j)
+			{
+				rot[i][j] = glm::dot(_a.axes[i], _b.axes[j]);
+				absRot[i][j] = std::abs(rot[i][j]) + EPS;
+			}
+		const VecT t = details::toLocal(_b.center, _a);
+
+		enum struct Feature { FaceA, FaceB, Edges };
+		FloatT minOverlap = std::numeric_limits<FloatT>::max();
+		Feature feature = Feature::FaceA;
+		int axisA = 0;
+		int axisB = 0;
+		VecT normal(0);
+		// Returns false if the axis separates the boxes.
+		auto testAxis = [&](FloatT _overlap, FloatT _dist, const VecT& _axis, Feature _feature, int _i, int _j)
+		{
+			if (_overlap < 0) return false;
+			if (_feature == Feature::Edges ? _overlap < EDGE_BIAS * minOverlap : _overlap < minOverlap)
+			{
+				minOverlap = _overlap;
+				feature = _feature;
+				axisA = _i;
+				axisB = _j;
+				normal = _dist < 0 ? -_axis : _axis;
+			}
+			return true;
+		};
+
+		for (int i = 0; i < 3; ++i)
+		{
+			const FloatT rb = _b.halfSize[0] * absRot[i][0] + _b.halfSize[1] * absRot[i][1] + _b.halfSize[2] * absRot[i][2];
+			if (!testAxis(_a.halfSize[i] + rb - std::abs(t[i]), t[i], _a.axes[i], Feature::FaceA, i, 0)) return {};
+		}
+		for (int j = 0; j < 3; ++j)
+		{
+			const FloatT ra = _a.halfSize[0] * absRot[0][j] + _a.halfSize[1] * absRot[1][j] + _a.halfSize[2] * absRot[2][j];
+			const FloatT dist = t[0] * rot[0][j] + t[1] * rot[1][j] + t[2] * rot[2][j];
+			if (!testAxis(ra + _b.halfSize[j] - std::abs(dist), dist, _b.axes[j], Feature::FaceB, 0, j)) return {};
+		}
+		for (int i = 0; i < 3; ++i)
+		{
+			const int i1 = (i + 1) % 3;
+			const int i2 = (i + 2) % 3;
+			for (int j = 0; j < 3; ++j)
+			{
+				const int j1 = (j + 1) % 3;
+				const int j2 = (j + 2) % 3;
+				const FloatT ra = _a.halfSize[i1] * absRot[i2][j] + _a.halfSize[i2] * absRot[i1][j];
+				const FloatT rb = _b.halfSize[j1] * absRot[i][j2] + _b.halfSize[j2] * absRot[i][j1];
+				const FloatT dist = t[i2] * rot[i1][j] - t[i1] * rot[i2][j];
+				const FloatT overlap = ra + rb - std::abs(dist);
+				// parallel edges are covered by the face axes
+				const FloatT len = std::sqrt(std::max(static_cast<FloatT>(1) - rot[i][j] * rot[i][j], static_cast<FloatT>(0)));
+				if (len < static_cast<FloatT>(1e-3))
+				{
+					if (overlap < 0) return {};
+					continue;
+				}
+				if (!testAxis(overlap / len, dist, glm::cross(_a.axes[i], _b.axes[j]) / len, Feature::Edges, i, j)) return {};
+			}
+		}
+
+		Contact<3, FloatT> contact;
+		contact.normal = normal;
+		contact.depth = minOverlap;
+		switch (feature)
+		{
+		case Feature::FaceA: {
+			// deepest point of b along the normal, centered on parallel features
+			VecT support = _b.center;
+			for (int j = 0; j < 3; ++j)
+				support -= _b.axes[j] * (details::sign(glm::dot(normal, _b.axes[j])) * _b.halfSize[j]);
+			contact.point = support + normal * (minOverlap * HALF);
+			break;
+		}
+		case Feature::FaceB: {
+			VecT support = _a.center;
+			for (int i = 0; i < 3; ++i)
+				support += _a.axes[i] * (details::sign(glm::dot(normal, _a.axes[i])) * _a.halfSize[i]);
+			contact.point = support - normal * (minOverlap * HALF);
+			break;
+		}
+		case Feature::Edges: {
+			// the edges of both boxes which are closest to each other along the normal
+			VecT edgeA = _a.center;
+			VecT edgeB = _b.center;
+			for (int k = 0; k < 3; ++k)
+			{
+				if (k != axisA) edgeA += _a.axes[k] * (details::sign(glm::dot(normal, _a.axes[k])) * _a.halfSize[k]);
+				if (k != axisB) edgeB -= _b.axes[k] * (details::sign(glm::dot(normal, _b.axes[k])) * _b.halfSize[k]);
+			}
+			const VecT extentA = _a.axes[axisA] * _a.halfSize[axisA];
+			const VecT extentB = _b.axes[axisB] * _b.halfSize[axisB];
+			const auto [pointA, pointB] = details::closestPoints(edgeA - extentA, edgeA + extentA, edgeB - extentB, edgeB + extentB);
+			contact.point = (pointA + pointB) * HALF;
+			break;
+		}
+		}
+		return contact;
+	}
+
+	/// @brief Test a list of pairs and append a contact for each overlapping one.
+	/// @param _shapesA, _shapesB Ranges of shapes with random access.
+	/// @param _pairs Indices (i, j) to test _shapesA[i] against _shapesB[j].
+	/// @param _contacts Vector of the matching Contact type. Contact::pair is set to the
+	///		index of the pair in _pairs.
+	template<typename RangeA, typename RangeB, typename ContactVector>
+	void collidePairs(const RangeA& _shapesA, const RangeB& _shapesB,
+		std::span<const std::pair<uint32_t, uint32_t>> _pairs, ContactVector& _contacts)
+	{
+		for (size_t i = 0; i < _pairs.size(); ++i)
+		{
+			const auto& [a, b] = _pairs[i];
+			if (auto contact = collide(_shapesA[a], _shapesB[b]))
+			{
+				contact->pair = static_cast<uint32_t>(i);
+				_contacts.push_back(*contact);
+			}
+		}
+	}
+}
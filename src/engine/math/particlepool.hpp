@@ -0,0 +1,215 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <type_traits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace math {
+
+	// Short-lived particles without an entity each, e.g. projectiles, sparks or exhaust.
+	// The pool has a fixed capacity and stores position, velocity, remaining life and color
+	// as structure of arrays, padded to a multiple of LANES. An update moves all particles
+	// and ages them, with AVX for LANES particles at once. Particles whose life ran out are
+	// removed by compact(), which keeps the remaining particles in the order they were
+	// emitted, so the pool is deterministic. Double precision and builds without AVX use a
+	// scalar loop.
+	template<typename FloatT = float>
+	class ParticlePool
+	{
+	public:
+		using VecT = glm::vec<3, FloatT, glm::defaultp>;
+		using ColorT = glm::vec<4, FloatT, glm::defaultp>;
+		constexpr static size_t LANES = 8;
+
+		/// @param _capacity Maximum number of living particles. Emitting more fails.
+		/// @param _gravity Acceleration of all particles.
+		/// @param _vectorized Use the SIMD kernel if available. The scalar kernel is
+		///		slower but exists for comparison.
+		explicit ParticlePool(size_t _capacity, const VecT& _gravity = VecT(0), bool _vectorized = true)
+			: m_capacity(_capacity), m_gravity(_gravity), m_vectorized(_vectorized)
+		{
+			const size_t padded = (_capacity + LANES - 1) / LANES * LANES;
+			for (std::vector<FloatT>* array : { &m_x, &m_y, &m_z, &m_vx, &m_vy, &m_vz, &m_life, &m_r, &m_g, &m_b, &m_a })
+				array->assign(padded, 0);
+		}
+
+		/// @brief Add a particle.
+		/// @param _life Time in seconds until the particle is removed.
+		/// @return false if the pool is full.
+		bool emit(const VecT& _position, const VecT& _velocity, FloatT _life, const ColorT& _color = ColorT(1))
+		{
+			if (m_size == m_capacity)
+				return false;
+			const size_t i = m_size++;
+			m_x[i] = _position.x; m_y[i] = _position.y; m_z[i] = _position.z;
+			m_vx[i] = _velocity.x; m_vy[i] = _velocity.y; m_vz[i] = _velocity.z;
+			m_life[i] = _life;
+			m_r[i] = _color.x; m_g[i] = _color.y; m_b[i] = _color.z; m_a[i] = _color.w;
+			return true;
+		}
+
+		/// @brief Move and age all particles by _dt, then remove the expired ones.
+		void update(FloatT _dt);
+
+		/// @brief Mark a particle as expired, e.g. after a collision. It is removed by
+		///		the next compact() or update(), so indices stay valid until then.
+		void kill(size_t _index) { m_life[_index] = 0; }
+
+		/// @brief Remove all particles without life left.
+		void compact();
+
+		void clear() { m_size = 0; }
+		void setGravity(const VecT& _gravity) { m_gravity = _gravity; }
+
+		VecT position(size_t _index) const { return VecT(m_x[_index], m_y[_index], m_z[_index]); }
+		VecT velocity(size_t _index) const { return VecT(m_vx[_index], m_vy[_index], m_vz[_index]); }
+		FloatT life(size_t _index) const { return m_life[_index]; }
+		ColorT color(size_t _index) const { return ColorT(m_r[_index], m_g[_index], m_b[_index], m_a[_index]); }
+		bool isAlive(size_t _index) const { return m_life[_index] > 0; }
+
+		size_t size() const { return m_size; }
+		size_t capacity() const { return m_capacity; }
+		bool isEmpty() const { return m_size == 0; }
+
+	private:
+		void integrateScalar(FloatT _dt, size_t _end);
+#if defined(__AVX__)
+		void integrateAVX(FloatT _dt, size_t _end);
+#endif
+		/// First particle without life left or m_size.
+		size_t findExpired() const;
+
+		void move(size_t _from, size_t _to);
+
+		size_t m_capacity;
+		size_t m_size = 0;
+		VecT m_gravity;
+		bool m_vectorized;
+		std::vector<FloatT> m_x;
+		std::vector<FloatT> m_y;
+		std::vector<FloatT> m_z;
+		std::vector<FloatT> m_vx;
+		std::vector<FloatT> m_vy;
+		std::vector<FloatT> m_vz;
+		std::vector<FloatT> m_life;
+		std::vector<FloatT> m_r;
+		std::vector<FloatT> m_g;
+		std::vector<FloatT> m_b;
+		std::vector<FloatT> m_a;
+	};
+
+	// ******************************************************************* //
+	template<typename FloatT>
+	void ParticlePool<FloatT>::update(FloatT _dt)
+	{
+		// Whole blocks are processed, the padding behind m_size is moved as well but never read.
+		const size_t end = (m_size + LANES - 1) / LANES * LANES;
+#if defined(__AVX__)
+		if constexpr (std::is_same_v<FloatT, float>)
+		{
+			if (m_vectorized)
+			{
+				integrateAVX(_dt, end);
+				compact();
+				return;
+			}
+		}
+#endif
+		integrateScalar(_dt, end);
+		compact();
+	}
+
+	template<typename FloatT>
+	void ParticlePool<FloatT>::compact()
+	{
+		size_t write = findExpired();
+		for (size_t read = write + 1; read < m_size; ++read)
+		{
+			if (m_life[read] > 0)
+				move(read, write++);
+		}
+		m_size = write;
+	}
+
+	template<typename FloatT>
+	void ParticlePool<FloatT>::integrateScalar(FloatT _dt, size_t _end)
+	{
+		const VecT dv = m_gravity * _dt;
+		for (size_t i = 0; i < _end; ++i)
+		{
+			m_vx[i] += dv.x;
+			m_vy[i] += dv.y;
+			m_vz[i] += dv.z;
+			m_x[i] += m_vx[i] * _dt;
+			m_y[i] += m_vy[i] * _dt;
+			m_z[i] += m_vz[i] * _dt;
+			m_life[i] -= _dt;
+		}
+	}
+
+	template<typename FloatT>
+	size_t ParticlePool<FloatT>::findExpired() const
+	{
+		size_t i = 0;
+#if defined(__AVX__)
+		if constexpr (std::is_same_v<FloatT, float>)
+		{
+			// skip blocks in which all particles are alive
+			const __m256 zero = _mm256_setzero_ps();
+			for (; i + LANES <= m_size; i += LANES)
+			{
+				const __m256 expired = _mm256_cmp_ps(_mm256_loadu_ps(m_life.data() + i), zero, _CMP_LE_OQ);
+				if (_mm256_movemask_ps(expired))
+					break;
+			}
+		}
+#endif
+		while (i < m_size && m_life[i] > 0)
+			++i;
+		return i;
+	}
+
+	template<typename FloatT>
+	void ParticlePool<FloatT>::move(size_t _from, size_t _to)
+	{
+		for (std::vector<FloatT>* array : { &m_x, &m_y, &m_z, &m_vx, &m_vy, &m_vz, &m_life, &m_r, &m_g, &m_b, &m_a })
+			(*array)[_to] = (*array)[_from];
+	}
+
+#if defined(__AVX__)
+	template<typename FloatT>
+	void ParticlePool<FloatT>::integrateAVX(FloatT _dt, size_t _end)
+	{
+		auto fmadd = [](__m256 _a, __m256 _b, __m256 _c)
+		{
+#if defined(__FMA__)
+			return _mm256_fmadd_ps(_a, _b, _c);
+#else
+			return _mm256_add_ps(_mm256_mul_ps(_a, _b), _c);
+#endif
+		};
+
+		const __m256 dt = _mm256_set1_ps(_dt);
+		const __m256 dvx = _mm256_set1_ps(m_gravity.x * _dt);
+		const __m256 dvy = _mm256_set1_ps(m_gravity.y * _dt);
+		const __m256 dvz = _mm256_set1_ps(m_gravity.z * _dt);
+		for (size_t i = 0; i < _end; i += LANES)
+		{
+			const __m256 vx = _mm256_add_ps(_mm256_loadu_ps(m_vx.data() + i), dvx);
+			const __m256 vy = _mm256_add_ps(_mm256_loadu_ps(m_vy.data() + i), dvy);
+			const __m256 vz = _mm256_add_ps(_mm256_loadu_ps(m_vz.data() + i), dvz);
+			_mm256_storeu_ps(m_vx.data() + i, vx);
+			_mm256_storeu_ps(m_vy.data() + i, vy);
+			_mm256_storeu_ps(m_vz.data() + i, vz);
+			_mm256_storeu_ps(m_x.data() + i, fmadd(vx, dt, _mm256_loadu_ps(m_x.data() + i)));
+			_mm256_storeu_ps(m_y.data() + i, fmadd(vy, dt, _mm256_loadu_ps(m_y.data() + i)));
+			_mm256_storeu_ps(m_z.data() + i, fmadd(vz, dt, _mm256_loadu_ps(m_z.data() + i)));
+			_mm256_storeu_ps(m_life.data() + i, _mm256_sub_ps(_mm256_loadu_ps(m_life.data() + i), dt));
+		}
+	}
+#endif
+}
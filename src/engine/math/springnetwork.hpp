@@ -0,0 +1,139 @@
+#pragma once
+
+#include "../utils/assert.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <cmath>
+#include <cinttypes>
+
+namespace math {
+
+	// Particles connected by springs, e.g. a rope, cloth or a soft body.
+	// The network is simulated with extended position based dynamics (Macklin et al., "XPBD:
+	// Position-Based Simulation of Compliant Constrained Dynamics", 2016): each spring is a
+	// distance constraint whose compliance is the inverse of its stiffness, so the result
+	// converges to the physical spring forces instead of depending on the iteration count.
+	// A step is split into substeps with a single constraint pass each ("Small Steps in
+	// Physics Simulation", 2019), which is stable even for stiff springs.
+	// Particles and springs are stored in contiguous arrays and the springs are solved in the
+	// order they were added, so a step is deterministic. Independent networks can be stepped
+	// in parallel.
+	template<typename FloatT = float>
+	class SpringNetwork
+	{
+	public:
+		using VecT = glm::vec<3, FloatT, glm::defaultp>;
+
+		struct Spring
+		{
+			uint32_t a;
+			uint32_t b;
+			FloatT restLength;
+			FloatT compliance; ///< inverse stiffness
+		};
+
+		/// @param _gravity Acceleration of all particles which are not pinned.
+		/// @param _damping Fraction of the velocity which is lost per second.
+		/// @param _substeps Number of substeps per step.
+		explicit SpringNetwork(const VecT& _gravity = VecT(0), FloatT _damping = 0, int _substeps = 8)
+			: m_gravity(_gravity), m_damping(_damping), m_substeps(_substeps)
+		{}
+
+		/// @brief Add a particle and return its index.
+		/// @param _mass 0 pins the particle, it is only moved by setPosition().
+		uint32_t addParticle(const VecT& _position, FloatT _mass, const VecT& _velocity = VecT(0))
+		{
+			m_positions.push_back(_position);
+			m_previous.push_back(_position);
+			m_velocities.push_back(_velocity);
+			m_inverseMasses.push_back(_mass > 0 ? static_cast<FloatT>(1) / _mass : static_cast<FloatT>(0));
+			return static_cast<uint32_t>(m_positions.size() - 1);
+		}
+
+		/// @brief Connect two particles and return the index of the spring.
+		/// @param _stiffness Force per unit of extension.
+		/// @param _restLength Length without force, a negative value takes the current distance.
+		uint32_t addSpring(uint32_t _a, uint32_t _b, FloatT _stiffness, FloatT _restLength = -1)
+		{
+			ASSERT(_a < m_positions.size() && _b < m_positions.size() && _a != _b, "Spring needs two different particles.");
+			ASSERT(_stiffness > 0, "Springs need a positive stiffness.");
+			if (_restLength < 0)
+				_restLength = glm::length(m_positions[_b] - m_positions[_a]);
+			m_springs.push_back({ _a, _b, _restLength, static_cast<FloatT>(1) / _stiffness });
+			return static_cast<uint32_t>(m_springs.size() - 1);
+		}
+
+		/// @brief Advance the network by _dt.
+		void step(FloatT _dt);
+
+		void clear() { m_positions.clear(); m_previous.clear(); m_velocities.clear(); m_inverseMasses.clear(); m_springs.clear(); }
+
+		/// Move a particle without a velocity change, e.g. a pinned particle attached to an object.
+		void setPosition(uint32_t _particle, const VecT& _position) { m_positions[_particle] = _position; }
+		void setVelocity(uint32_t _particle, const VecT& _velocity) { m_velocities[_particle] = _velocity; }
+		void setGravity(const VecT& _gravity) { m_gravity = _gravity; }
+
+		bool isPinned(uint32_t _particle) const { return m_inverseMasses[_particle] == 0; }
+		std::span<const VecT> positions() const { return m_positions; }
+		std::span<const VecT> velocities() const { return m_velocities; }
+		std::span<const Spring> springs() const { return m_springs; }
+		size_t numParticles() const { return m_positions.size(); }
+		size_t numSprings() const { return m_springs.size(); }
+
+	private:
+		VecT m_gravity;
+		FloatT m_damping;
+		int m_substeps;
+
+		std::vector<VecT> m_positions;
+		std::vector<VecT> m_previous; ///< positions at the start of the substep
+		std::vector<VecT> m_velocities;
+		std::vector<FloatT> m_inverseMasses;
+		std::vector<Spring> m_springs;
+	};
+
+	// ******************************************************************* //
+	template<typename FloatT>
+	void SpringNetwork<FloatT>::step(FloatT _dt)
+	{
+		const FloatT h = _dt / static_cast<FloatT>(m_substeps);
+		const FloatT invHSq = static_cast<FloatT>(1) / (h * h);
+		const FloatT damping = std::max(static_cast<FloatT>(1) - m_damping * h, static_cast<FloatT>(0));
+		const size_t n = m_positions.size();
+
+		for (int substep = 0; substep < m_substeps; ++substep)
+		{
+			for (size_t i = 0; i < n; ++i)
+			{
+				m_previous[i] = m_positions[i];
+				if (m_inverseMasses[i] == 0) continue;
+				m_velocities[i] += m_gravity * h;
+				m_positions[i] += m_velocities[i] * h;
+			}
+
+			// With a single pass the Lagrange multiplier starts at 0 in every substep, so the
+			// correction is -C / (w_a + w_b + compliance / h^2).
+			for (const Spring& spring : m_springs)
+			{
+				const FloatT wA = m_inverseMasses[spring.a];
+				const FloatT wB = m_inverseMasses[spring.b];
+				const VecT d = m_positions[spring.b] - m_positions[spring.a];
+				const FloatT length = glm::length(d);
+				const FloatT w = wA + wB + spring.compliance * invHSq;
+				if (length <= 0 || w <= 0) continue;
+
+				const VecT correction = d * ((length - spring.restLength) / (length * w));
+				m_positions[spring.a] += correction * wA;
+				m_positions[spring.b] -= correction * wB;
+			}
+
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (m_inverseMasses[i] == 0) continue;
+				m_velocities[i] = (m_positions[i] - m_previous[i]) * (damping / h);
+			}
+		}
+	}
+}
@@ -1,67 +1,256 @@
 #pragma once
 
+#include "assert.hpp"
 #include <utility>
+#include <algorithm>
 #include <memory>
+#include <new>
+#include <vector>
+#include <bit>
+#include <cinttypes>
+#include <cstddef>
 
 namespace utils {
-	/// @brief A simple allocator which maintains memory blocks holding multiple 
+	/// @brief A simple allocator which maintains memory blocks holding multiple
 	///		elements of the same type.
+	/// @details Freed objects are kept in an intrusive free list and reused by the next create().
+	///		Blocks are aligned to their (power of two) size, so the block of an object is found
+	///		by masking its address. Each block tracks its living objects in a bitset which
+	///		allows to destroy exactly those on reset() and destruction.
 	/// @param T The type of objects to handle.
-	/// @param ElemPerBlock Number elements to hold in a single memory block.
-	///		A larger value leads to fewer allocations but more wasted space if 
-	///		the lifetimes differ.
-	template<typename T, int ElemPerBlock>
+	/// @param ElemPerBlock Minimum number elements to hold in a single memory block.
+	///		A larger value leads to fewer allocations but more wasted space if
+	///		the lifetimes differ. The number is rounded up to fill the power of two block size.
+	/// @param ThreadLocalCache If true, blocks which are no longer needed are kept in a cache
+	///		of the current thread and reused by all allocators of the same type on that thread.
+	///		Useful for structures which are rebuilt every frame.
+	template<typename T, int ElemPerBlock, bool ThreadLocalCache = false>
 	class BlockAllocator
 	{
-	public:
-		BlockAllocator()
-			: first(new Node()), current(first.get())
+		union Slot
+		{
+			Slot* nextFree;
+			alignas(T) unsigned char storage[sizeof(T)];
+		};
+
+		struct Block
+		{
+			Block* next = nullptr;
+			uint32_t numElements = 0; ///< Number of slots which have been used at least once.
+
+			uint64_t* alive() { return reinterpret_cast<uint64_t*>(reinterpret_cast<unsigned char*>(this) + sizeof(Block)); }
+			Slot* slots() { return reinterpret_cast<Slot*>(reinterpret_cast<unsigned char*>(this) + slotsOffset(CAPACITY)); }
+		};
+
+		constexpr static size_t numWords(size_t _numElements) { return (_numElements + 63) / 64; }
+		constexpr static size_t slotsOffset(size_t _numElements)
+		{
+			const size_t headerSize = sizeof(Block) + numWords(_numElements) * sizeof(uint64_t);
+			return (headerSize + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+		}
+		constexpr static size_t blockSize(size_t _numElements) { return slotsOffset(_numElements) + _numElements * sizeof(Slot); }
+		constexpr static size_t computeCapacity()
 		{
+			size_t n = ElemPerBlock;
+			while (blockSize(n + 1) <= BLOCK_SIZE) ++n;
+			return n;
+		}
+
+		constexpr static size_t BLOCK_SIZE = std::bit_ceil(blockSize(ElemPerBlock));
+		constexpr static uint32_t CAPACITY = static_cast<uint32_t>(computeCapacity());
+		constexpr static size_t MAX_CACHED_BLOCKS = 64;
+	public:
+		BlockAllocator() = default;
+
+		BlockAllocator(BlockAllocator&& _other) noexcept
+			: m_first(std::exchange(_other.m_first, nullptr)),
+			m_current(std::exchange(_other.m_current, nullptr)),
+			m_freeList(std::exchange(_other.m_freeList, nullptr))
+		{}
 
+		BlockAllocator& operator=(BlockAllocator&& _other) noexcept
+		{
+			release();
+			m_first = std::exchange(_other.m_first, nullptr);
+			m_current = std::exchange(_other.m_current, nullptr);
+			m_freeList = std::exchange(_other.m_freeList, nullptr);
+			return *this;
 		}
 
+		BlockAllocator(const BlockAllocator&) = delete;
+		BlockAllocator& operator=(const BlockAllocator&) = delete;
+
+		~BlockAllocator() { release(); }
+
 		/// @brief Create a new object.
 		/// Arguments are forwarded to the constructor of T.
 		template<typename... Args>
 		T* create(Args&&... args)
 		{
-			if (current->numElements == ElemPerBlock)
+			Slot* slot;
+			Block* block;
+			if (m_freeList)
 			{
-				Node* prev = current;
-				current = new Node();
-				prev->next = current;
+				slot = m_freeList;
+				m_freeList = slot->nextFree;
+				block = blockOf(slot);
 			}
-			char* ptr = current->buffer + current->numElements * sizeof(T);
-			++current->numElements;
+			else
+			{
+				if (!m_current || m_current->numElements == CAPACITY)
+				{
+					Block* newBlock = allocateBlock();
+					if (m_current) m_current->next = newBlock;
+					else m_first = newBlock;
+					m_current = newBlock;
+				}
+				block = m_current;
+				slot = block->slots() + block->numElements;
+				++block->numElements;
+			}
+
+			T* ptr = new (slot->storage) T (std::forward<Args>(args)...);
+			const uint32_t idx = static_cast<uint32_t>(slot - block->slots());
+			block->alive()[idx / 64] |= uint64_t(1) << (idx % 64);
+			return ptr;
+		}
 
-			return new (ptr) T (std::forward<Args>(args)...);
+		/// @brief Destroy a single object created by this allocator and reuse its memory.
+		void destroy(T* _ptr)
+		{
+			Slot* slot = reinterpret_cast<Slot*>(_ptr);
+			Block* block = blockOf(slot);
+			const uint32_t idx = static_cast<uint32_t>(slot - block->slots());
+			uint64_t& word = block->alive()[idx / 64];
+			const uint64_t bit = uint64_t(1) << (idx % 64);
+			ASSERT(word & bit, "Trying to destroy an object which is not alive.");
+
+			_ptr->~T();
+			word &= ~bit;
+			slot->nextFree = m_freeList;
+			m_freeList = slot;
 		}
 
 		// Delete all objects and free all but one block.
 		void reset()
 		{
-			first.reset(new Node());
-			current = first.get();
+			if (!m_first) return;
+
+			Block* block = m_first->next;
+			while (block)
+			{
+				Block* next = block->next;
+				destroyElements(block);
+				releaseBlock(block);
+				block = next;
+			}
+			destroyElements(m_first);
+			m_first->next = nullptr;
+			m_first->numElements = 0;
+			m_current = m_first;
+			m_freeList = nullptr;
 		}
 
 	private:
-		struct Node
+		static Block* blockOf(Slot* _slot)
+		{
+			return reinterpret_cast<Block*>(reinterpret_cast<uintptr_t>(_slot) & ~(BLOCK_SIZE - 1));
+		}
+
+		static void destroyElements(Block* _block)
 		{
-			~Node()
+			uint64_t* alive = _block->alive();
+			Slot* slots = _block->slots();
+			for (size_t w = 0; w < numWords(_block->numElements); ++w)
 			{
-				T* ptr = reinterpret_cast<T*>(buffer);
-				for (int i = 0; i < numElements; ++i)
-					ptr[i].~T();
+				uint64_t bits = alive[w];
+				while (bits)
+				{
+					reinterpret_cast<T*>(slots[w * 64 + std::countr_zero(bits)].storage)->~T();
+					bits &= bits - 1;
+				}
+				alive[w] = 0;
+			}
+		}
 
-				if (next) delete next;
+		// Destroys all objects and frees all blocks. Iterative, so that a long chain of
+		// blocks cannot overflow the stack.
+		void release()
+		{
+			Block* block = m_first;
+			while (block)
+			{
+				Block* next = block->next;
+				destroyElements(block);
+				releaseBlock(block);
+				block = next;
 			}
+			m_first = nullptr;
+			m_current = nullptr;
+			m_freeList = nullptr;
+		}
+
+		struct BlockCache
+		{
+			std::vector<Block*> blocks;
 
-			char buffer[sizeof(T) * ElemPerBlock];
-			Node* next = nullptr;
-			int numElements = 0;
+			~BlockCache()
+			{
+				for (Block* block : blocks)
+					freeBlock(block);
+				t_cacheDestroyed = true;
+			}
 		};
 
-		std::unique_ptr<Node> first;
-		Node* current;
+		// Allocators which outlive the cache of their thread (e.g. globals) bypass it.
+		inline static thread_local bool t_cacheDestroyed = false;
+
+		static BlockCache& threadCache()
+		{
+			thread_local BlockCache cache;
+			return cache;
+		}
+
+		static Block* allocateBlock()
+		{
+			if constexpr (ThreadLocalCache)
+			{
+				if (!t_cacheDestroyed && !threadCache().blocks.empty())
+				{
+					Block* block = threadCache().blocks.back();
+					threadCache().blocks.pop_back();
+					return new (block) Block();
+				}
+			}
+
+			void* mem = ::operator new(BLOCK_SIZE, std::align_val_t(BLOCK_SIZE));
+			Block* block = new (mem) Block();
+			std::fill_n(block->alive(), numWords(CAPACITY), uint64_t(0));
+			return block;
+		}
+
+		// All elements of the block need to be destroyed already.
+		static void releaseBlock(Block* _block)
+		{
+			if constexpr (ThreadLocalCache)
+			{
+				if (!t_cacheDestroyed && threadCache().blocks.size() < MAX_CACHED_BLOCKS)
+				{
+					threadCache().blocks.push_back(_block);
+					return;
+				}
+			}
+			freeBlock(_block);
+		}
+
+		static void freeBlock(Block* _block)
+		{
+			_block->~Block();
+			::operator delete(_block, std::align_val_t(BLOCK_SIZE));
+		}
+
+		Block* m_first = nullptr;
+		Block* m_current = nullptr;
+		Slot* m_freeList = nullptr;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "flathashmap.hpp"
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+#include <optional>
+#include <cinttypes>
+#include <functional>
+#include <future>
+#include <exception>
+#include <utility>
+#include <bit>
+
+namespace utils {
+
+	/// Thread-safe hash map which splits the elements over NumShards independently locked
+	/// FlatHashMaps.
+	/// \details The shard is chosen by the low bits of the hash while FlatHashMap places the
+	///		elements by the high bits of the (multiplied) hash, so the keys of one shard are still
+	///		spread over all of its buckets.
+	///		Lookups take a shared lock and can run in parallel with other lookups. add/remove
+	///		take an exclusive lock of one shard only, so writers only block readers and writers
+	///		which happen to access the same shard.
+	///
+	///		getOrAdd() creates missing elements without holding a lock.
+	///		Handles returned by find() and begin() keep a shared lock on the shard they point
+	///		into. While a thread holds a handle it must not modify the map itself or it will
+	///		dead-lock. Keep handles short lived; if the value is needed longer use get().
+	template<typename K, typename T, typename Hash = std::hash<K>, typename Compare = std::equal_to<K>, uint32_t NumShards = 16>
+	class ConcurrentHashMap
+	{
+		static_assert(std::has_single_bit(NumShards), "The number of shards must be a power of two.");
+
+		using ShardMap = FlatHashMap<K, T, Hash, Compare>;
+
+		// Each shard on its own cache line to avoid false sharing between the locks.
+		struct alignas(64) Shard
+		{
+			mutable std::shared_mutex mutex;
+			ShardMap map;
+			// Elements which are currently created by getOrAdd().
+			FlatHashMap<K, std::shared_future<T>, Hash, Compare> pending;
+		};
+	public:
+		/// Read only access to an element which locks the containing shard for shared access.
+		/// \details Handles can be moved but not copied because they own the lock.
+		class Handle
+		{
+			const ConcurrentHashMap* map;
+			uint32_t shard;
+			typename ShardMap::ConstHandle inner;
+			std::shared_lock<std::shared_mutex> lock;
+
+			Handle(const ConcurrentHashMap* _map, uint32_t _shard, typename ShardMap::ConstHandle _inner,
+				std::shared_lock<std::shared_mutex>&& _lock) :
+				map(_map),
+				shard(_shard),
+				inner(_inner),
+				lock(std::move(_lock))
+			{
+				if (!inner) { map = nullptr; shard = 0; lock = {}; }
+			}
+
+			friend ConcurrentHashMap;
+		public:
+			Handle(Handle&&) noexcept = default;
+			Handle& operator = (Handle&&) noexcept = default;
+
+			const K& key() const { return inner.key(); }
+
+			const T& data() const { return inner.data(); }
+
+			operator bool () const { return map != nullptr; }
+
+			/// Advances to the next element, possibly in the next shard.
+			Handle& operator ++ ()
+			{
+				++inner;
+				if (inner) return *this;
+
+				lock = {};
+				while (++shard < NumShards)
+				{
+					lock = std::shared_lock(map->m_shards[shard].mutex);
+					inner = map->m_shards[shard].map.begin();
+					if (inner) return *this;
+					lock = {};
+				}
+				map = nullptr;
+				shard = 0;
+				return *this;
+			}
+
+			bool operator == (const Handle& _other) const { return map == _other.map && shard == _other.shard && inner == _other.inner; }
+			bool operator != (const Handle& _other) const { return !(*this == _other); }
+
+			// The dereference operator has no function other than making this handle compatible
+			// for range based loops.
+			const Handle& operator * () const { return *this; }
+		};
+
+		explicit ConcurrentHashMap(uint32_t _expectedElementCount = 15)
+		{
+			for (Shard& shard : m_shards)
+				shard.map.reserve(_expectedElementCount / NumShards + 1);
+		}
+
+		ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+		ConcurrentHashMap& operator = (const ConcurrentHashMap&) = delete;
+
+		// Add an element to the map.
+		// Overwrites the current value if the key already exists.
+		template<class KeyT, class DataT>
+			requires (std::is_same_v<std::remove_cvref_t<KeyT>, K>)
+		void add(KeyT&& _key, DataT&& _data)
+		{
+			Shard& shard = getShard(_key);
+			std::unique_lock lock(shard.mutex);
+			shard.map.add(std::forward<KeyT>(_key), std::forward<DataT>(_data));
+		}
+
+		// Remove an element if it exists.
+		// Returns true if an element was removed.
+		template<typename KeyLike>
+		bool remove(const KeyLike& _key)
+		{
+			Shard& shard = getShard(_key);
+			std::unique_lock lock(shard.mutex);
+			auto handle = shard.map.find(_key);
+			if (!handle) return false;
+			shard.map.remove(handle);
+			return true;
+		}
+
+		/// Find an element and lock its shard for reading as long as the handle exists.
+		template<typename KeyLike>
+		Handle find(const KeyLike& _key) const
+		{
+			const uint32_t idx = shardIndex(_key);
+			std::shared_lock lock(m_shards[idx].mutex);
+			return Handle(this, idx, m_shards[idx].map.find(_key), std::move(lock));
+		}
+
+		/// Returns a copy of the element without keeping the shard locked.
+		template<typename KeyLike>
+		std::optional<T> get(const KeyLike& _key) const
+		{
+			const Shard& shard = getShard(_key);
+			std::shared_lock lock(shard.mutex);
+			auto handle = shard.map.find(_key);
+			if (handle) return handle.data();
+			return std::nullopt;
+		}
+
+		/// Returns a copy of the element or creates it with _create() if it does not exist yet.
+		/// \details _create is called at most once per key even if multiple threads request the
+		///		same missing key at once; the other threads wait for its result. The shard is not
+		///		locked while _create runs, so a slow load does not block other keys and _create
+		///		may access the map itself, except for requesting the key it creates.
+		///		If _create throws, the waiting threads receive the exception as well.
+		template<typename KeyLike, typename Factory>
+		T getOrAdd(const KeyLike& _key, Factory&& _create)
+		{
+			Shard& shard = getShard(_key);
+			{
+				std::shared_lock lock(shard.mutex);
+				auto handle = shard.map.find(_key);
+				if (handle) return handle.data();
+			}
+
+			std::promise<T> promise;
+			{
+				std::unique_lock lock(shard.mutex);
+				// Another thread could have added the element or started creating it in between.
+				auto handle = shard.map.find(_key);
+				if (handle) return handle.data();
+				auto pending = shard.pending.find(_key);
+				if (pending)
+				{
+					std::shared_future<T> future = pending.data();
+					lock.unlock();
+					return future.get();
+				}
+				shard.pending.add(K(_key), promise.get_future().share());
+			}
+
+			try
+			{
+				T data = _create();
+				{
+					std::unique_lock lock(shard.mutex);
+					shard.map.add(K(_key), data);
+					shard.pending.remove(_key);
+				}
+				promise.set_value(data);
+				return data;
+			}
+			catch (...)
+			{
+				{
+					std::unique_lock lock(shard.mutex);
+					shard.pending.remove(_key);
+				}
+				promise.set_exception(std::current_exception());
+				throw;
+			}
+		}
+
+		/// Make sure that _expectedElementCount elements fit without a resize.
+		void reserve(uint32_t _expectedElementCount)
+		{
+			for (Shard& shard : m_shards)
+			{
+				std::unique_lock lock(shard.mutex);
+				shard.map.reserve(_expectedElementCount / NumShards + 1);
+			}
+		}
+
+		/// Remove all elements from the map but keep the capacity.
+		void clear()
+		{
+			for (Shard& shard : m_shards)
+			{
+				std::unique_lock lock(shard.mutex);
+				shard.map.clear();
+			}
+		}
+
+		/// The number of elements at some point during the call.
+		uint32_t size() const
+		{
+			uint32_t count = 0;
+			for (const Shard& shard : m_shards)
+			{
+				std::shared_lock lock(shard.mutex);
+				count += shard.map.size();
+			}
+			return count;
+		}
+		bool empty() const { return size() == 0; }
+
+		/// Returns the first element found in the map or an invalid handle when the map is empty.
+		/// \details Only the shard of the current element is locked. Elements in other shards
+		///		can be added or removed concurrently while iterating.
+		Handle begin() const
+		{
+			for (uint32_t i = 0; i < NumShards; ++i)
+			{
+				std::shared_lock lock(m_shards[i].mutex);
+				auto inner = m_shards[i].map.begin();
+				if (inner) return Handle(this, i, inner, std::move(lock));
+			}
+			return end();
+		}
+
+		/// Return the invalid handle for range based for loops
+		Handle end() const { return Handle(nullptr, 0, m_shards[0].map.end(), {}); }
+
+	private:
+		template<typename KeyLike>
+		uint32_t shardIndex(const KeyLike& _key) const
+		{
+			return static_cast<uint32_t>(m_hash(_key)) & (NumShards - 1);
+		}
+
+		template<typename KeyLike>
+		Shard& getShard(const KeyLike& _key) { return m_shards[shardIndex(_key)]; }
+		template<typename KeyLike>
+		const Shard& getShard(const KeyLike& _key) const { return m_shards[shardIndex(_key)]; }
+
+		std::array<Shard, NumShards> m_shards;
+		Hash m_hash;
+	};
+}
@@ -0,0 +1,439 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <functional>
+#include <concepts>
+#include <utility>
+#include <bit>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLATHASHMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace utils {
+
+	namespace details {
+		template<typename Hash, typename Compare>
+		concept transparent_lookup = requires {
+			typename Hash::is_transparent;
+			typename Compare::is_transparent;
+		};
+	}
+
+	/// Robin Hood hash map with a separate array of control bytes.
+	/// \details Each slot has one control byte which is 0 for an empty slot and otherwise
+	///		stores the distance to the home bucket + 1. Because Robin Hood keeps the elements
+	///		sorted by their home bucket, all candidates for a key are exactly the slots whose
+	///		control byte equals their offset from the home bucket + 1. These are found for 16
+	///		slots at once (SSE2) and only the candidates are compared against the key.
+	///		The table does not wrap around. Instead, there is a small overflow area behind
+	///		the last bucket and the map grows if an element would be displaced beyond it.
+	///		Elements are removed with a backward shift, so there are no tombstones and the
+	///		table never needs to be cleaned up by a rehash.
+	///
+	///		Lookup with other key types (e.g. std::string_view for std::string) is possible
+	///		if both Hash and Compare define is_transparent.
+	template<typename K, typename T, typename Hash = std::hash<K>, typename Compare = std::equal_to<K>>
+	class FlatHashMap
+	{
+		constexpr static uint32_t GROUP_SIZE = 16;
+		constexpr static uint32_t MAX_CONTROL = 0xff;
+		constexpr static uint32_t MIN_BUCKETS = GROUP_SIZE;
+		constexpr static float MAX_LOAD_FACTOR = 0.8f;
+	public:
+		/// Handles are direct accesses into a specific hashmap.
+		/// Any add or remove in the HM will invalidate the handle without notification.
+		/// A handle might be usable afterwards, but there is no guaranty.
+		template<typename MapT, typename DataT>
+		class HandleT
+		{
+			MapT* map;
+			uint32_t idx;
+
+			HandleT(MapT* _map, uint32_t _idx = 0) :
+				map(_map),
+				idx(_idx)
+			{
+				if (map)
+				{
+					// Find a valid start value.
+					while (idx < map->m_numSlots && map->m_control[idx] == 0)
+						++idx;
+
+					if (idx >= map->m_numSlots) { idx = 0; map = nullptr; }
+				}
+			}
+
+			friend FlatHashMap;
+		public:
+			const K& key() const { return map->m_keys[idx]; }
+
+			DataT& data() const { return map->m_data[idx]; }
+
+			operator bool () const { return map != nullptr; }
+
+			HandleT& operator ++ ()
+			{
+				++idx;
+				// Move forward while the element is empty.
+				while (idx < map->m_numSlots && map->m_control[idx] == 0)
+					++idx;
+				// Set to invalid handle?
+				if (idx >= map->m_numSlots) { idx = 0; map = nullptr; }
+				return *this;
+			}
+
+			bool operator == (const HandleT& _other) const { return map == _other.map && idx == _other.idx; }
+			bool operator != (const HandleT& _other) const { return map != _other.map || idx != _other.idx; }
+
+			// The dereference operator has no function other than making this handle compatible
+			// for range based loops.
+			const HandleT& operator * () const { return *this; }
+		};
+
+		typedef HandleT<FlatHashMap, T> Handle;
+		typedef HandleT<const FlatHashMap, const T> ConstHandle;
+
+		explicit FlatHashMap(uint32_t _expectedElementCount = 15)
+		{
+			allocate(estimateBuckets(_expectedElementCount));
+		}
+
+		FlatHashMap(FlatHashMap&& _other) noexcept :
+			m_bucketMask(_other.m_bucketMask),
+			m_shift(_other.m_shift),
+			m_numSlots(_other.m_numSlots),
+			m_maxSize(_other.m_maxSize),
+			m_size(_other.m_size),
+			m_control(_other.m_control),
+			m_keys(_other.m_keys),
+			m_data(_other.m_data)
+		{
+			_other.m_control = nullptr;
+			_other.m_keys = nullptr;
+			_other.m_data = nullptr;
+			_other.m_numSlots = 0;
+			_other.m_size = 0;
+		}
+
+		FlatHashMap& operator = (FlatHashMap&& _rhs) noexcept
+		{
+			this->~FlatHashMap();
+			new (this) FlatHashMap(std::move(_rhs));
+			return *this;
+		}
+
+		~FlatHashMap()
+		{
+			destroyElements();
+			free(m_control);
+			free(m_keys);
+			free(m_data);
+		}
+
+		// Add an element to the map.
+		// Overwrites the current value if the key already exists.
+		// KeyT is a template parameter to capture a forwarding reference.
+		template<class KeyT, class DataT>
+			requires (std::is_same_v<std::remove_cvref_t<KeyT>, K>)
+		Handle add(KeyT&& _key, DataT&& _data)
+		{
+			const uint64_t h = static_cast<uint64_t>(m_hash(_key));
+			const uint32_t found = findIndex(_key, h);
+			if (found != INVALID_INDEX)
+			{
+				m_data[found] = std::forward<DataT>(_data);
+				return Handle(this, found);
+			}
+
+			return Handle(this, insertUnique(h, std::forward<KeyT>(_key), std::forward<DataT>(_data)));
+		}
+
+		// Remove an element if it exists
+		template<typename KeyLike>
+		void remove(const KeyLike& _key)
+		{
+			remove(find(_key));
+		}
+
+		// Remove an existing element
+		void remove(const Handle& _element)
+		{
+			if (_element)
+				eraseIndex(_element.idx);
+		}
+
+		template<typename KeyLike>
+			requires (std::is_same_v<KeyLike, K> || details::transparent_lookup<Hash, Compare>)
+		Handle find(const KeyLike& _key) noexcept
+		{
+			const uint32_t idx = findIndex(_key, static_cast<uint64_t>(m_hash(_key)));
+			return idx != INVALID_INDEX ? Handle(this, idx) : Handle(nullptr);
+		}
+
+		template<typename KeyLike>
+			requires (std::is_same_v<KeyLike, K> || details::transparent_lookup<Hash, Compare>)
+		ConstHandle find(const KeyLike& _key) const noexcept
+		{
+			const uint32_t idx = findIndex(_key, static_cast<uint64_t>(m_hash(_key)));
+			return idx != INVALID_INDEX ? ConstHandle(this, idx) : ConstHandle(nullptr);
+		}
+
+		/// Get access to an element. If it was not in the map before it will be added with default construction.
+		T& operator [] (const K& _key)
+			requires std::is_default_constructible_v<T>
+		{
+			const uint64_t h = static_cast<uint64_t>(m_hash(_key));
+			const uint32_t found = findIndex(_key, h);
+			if (found != INVALID_INDEX)
+				return m_data[found];
+
+			return m_data[insertUnique(h, K(_key), T())];
+		}
+
+		/// Make sure that _expectedElementCount elements fit without a resize.
+		void reserve(uint32_t _expectedElementCount)
+		{
+			const uint32_t buckets = estimateBuckets(_expectedElementCount);
+			if (buckets > m_bucketMask + 1)
+				rehash(buckets);
+		}
+
+		/// Remove all elements from the set but keep the capacity.
+		void clear()
+		{
+			destroyElements();
+			memset(m_control, 0, m_numSlots);
+			m_size = 0;
+		}
+
+		uint32_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+		/// Number of elements which can be stored before the next resize.
+		uint32_t capacity() const { return m_maxSize; }
+
+		/// Returns the first element found in the map or an invalid handle when the map is empty.
+		Handle begin() { return Handle(m_size ? this : nullptr); }
+		ConstHandle begin() const { return ConstHandle(m_size ? this : nullptr); }
+
+		/// Return the invalid handle for range based for loops
+		Handle end() { return Handle(nullptr); }
+		ConstHandle end() const { return ConstHandle(nullptr); }
+
+	private:
+		constexpr static uint32_t INVALID_INDEX = ~0u;
+
+		uint32_t m_bucketMask = 0;
+		uint32_t m_shift = 0;    ///< 64 - log2(number of buckets)
+		uint32_t m_numSlots = 0; ///< buckets + overflow area
+		uint32_t m_maxSize = 0;
+		uint32_t m_size = 0;
+
+		uint8_t* m_control = nullptr;
+		K* m_keys = nullptr;
+		T* m_data = nullptr;
+		Hash m_hash;
+		Compare m_keyCompare;
+
+		static uint32_t estimateBuckets(uint32_t _expectedElementCount)
+		{
+			const uint32_t minBuckets = static_cast<uint32_t>(_expectedElementCount / MAX_LOAD_FACTOR) + 1;
+			return std::max(MIN_BUCKETS, std::bit_ceil(minBuckets));
+		}
+
+		/// Fibonacci hashing spreads weak hashes (e.g. std::hash<int>) across all buckets.
+		uint32_t homeBucket(uint64_t _hash) const
+		{
+			return static_cast<uint32_t>((_hash * 0x9E3779B97F4A7C15ull) >> m_shift);
+		}
+
+		void allocate(uint32_t _numBuckets)
+		{
+			m_bucketMask = _numBuckets - 1;
+			m_shift = 64 - std::countr_zero(_numBuckets);
+			// An element can be displaced at most MAX_CONTROL-1 slots from its home bucket.
+			m_numSlots = _numBuckets + std::min(_numBuckets, MAX_CONTROL - 1);
+			m_maxSize = static_cast<uint32_t>(_numBuckets * MAX_LOAD_FACTOR);
+			m_size = 0;
+
+			// The control bytes are padded by one group so that group loads never leave the buffer.
+			m_control = static_cast<uint8_t*>(calloc(m_numSlots + GROUP_SIZE, 1));
+			m_keys = static_cast<K*>(malloc(sizeof(K) * m_numSlots));
+			m_data = static_cast<T*>(malloc(sizeof(T) * m_numSlots));
+		}
+
+		void destroyElements()
+		{
+			if (!m_control) return;
+			for (uint32_t i = 0; i < m_numSlots; ++i)
+				if (m_control[i])
+				{
+					m_data[i].~T();
+					m_keys[i].~K();
+				}
+		}
+
+		/// Bitmask of slots in [_idx, _idx+16) which hold elements with the home bucket _idx - _dist
+		/// and the position of the first slot which ends the search (a poorer element or empty slot).
+		struct GroupMatch
+		{
+			uint32_t candidates;
+			uint32_t stop;
+		};
+
+		GroupMatch matchGroup(uint32_t _idx, uint32_t _dist) const
+		{
+#ifdef FLATHASHMAP_SSE2
+			const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_control + _idx));
+			// expected control values: dist+1, dist+2, ..., saturated at 255
+			const __m128i offsets = _mm_setr_epi8(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+			const __m128i expected = _mm_adds_epu8(offsets, _mm_set1_epi8(static_cast<char>(std::min(_dist, MAX_CONTROL))));
+			const __m128i eq = _mm_cmpeq_epi8(ctrl, expected);
+			// ctrl < expected <=> min(ctrl, expected) == ctrl && ctrl != expected
+			const __m128i le = _mm_cmpeq_epi8(_mm_min_epu8(ctrl, expected), ctrl);
+			const uint32_t eqMask = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+			const uint32_t ltMask = static_cast<uint32_t>(_mm_movemask_epi8(le)) & ~eqMask;
+#else
+			uint32_t eqMask = 0;
+			uint32_t ltMask = 0;
+			for (uint32_t i = 0; i < GROUP_SIZE; ++i)
+			{
+				const uint32_t expected = std::min(_dist + i + 1, MAX_CONTROL);
+				const uint32_t ctrl = m_control[_idx + i];
+				if (ctrl == expected) eqMask |= 1u << i;
+				else if (ctrl < expected) ltMask |= 1u << i;
+			}
+#endif
+			const uint32_t stop = ltMask ? std::countr_zero(ltMask) : GROUP_SIZE;
+			const uint32_t validMask = (1u << stop) - 1;
+			return { eqMask & validMask, stop };
+		}
+
+		template<typename KeyLike>
+		uint32_t findIndex(const KeyLike& _key, uint64_t _hash) const
+		{
+			uint32_t idx = homeBucket(_hash);
+			for (uint32_t dist = 0; dist < MAX_CONTROL; dist += GROUP_SIZE, idx += GROUP_SIZE)
+			{
+				GroupMatch match = matchGroup(idx, dist);
+				while (match.candidates)
+				{
+					const uint32_t i = idx + std::countr_zero(match.candidates);
+					if (m_keyCompare(m_keys[i], _key))
+						return i;
+					match.candidates &= match.candidates - 1;
+				}
+				if (match.stop < GROUP_SIZE)
+					break;
+			}
+			return INVALID_INDEX;
+		}
+
+		/// Insert an element which is known to not be in the map yet.
+		/// \returns The index of the new element.
+		template<typename KeyT, typename DataT>
+		uint32_t insertUnique(uint64_t _hash, KeyT&& _key, DataT&& _data)
+		{
+			while (true)
+			{
+				if (m_size < m_maxSize)
+				{
+					// Find the position where the new element is richer than the current one.
+					uint32_t idx = homeBucket(_hash);
+					uint32_t ctrl = 1;
+					while (ctrl <= m_control[idx])
+					{
+						++idx;
+						++ctrl;
+					}
+
+					// All elements up to the next empty slot are shifted by one.
+					// Check that this neither exceeds the maximum distance nor the overflow area.
+					uint32_t empty = idx;
+					bool fits = ctrl < MAX_CONTROL;
+					while (fits && m_control[empty])
+					{
+						fits = m_control[empty] + 1u < MAX_CONTROL;
+						++empty;
+					}
+
+					if (fits && empty < m_numSlots)
+					{
+						if (empty != idx)
+						{
+							new (&m_keys[empty]) K(std::move(m_keys[empty - 1]));
+							new (&m_data[empty]) T(std::move(m_data[empty - 1]));
+							m_control[empty] = m_control[empty - 1] + 1;
+							for (uint32_t i = empty - 1; i > idx; --i)
+							{
+								m_keys[i] = std::move(m_keys[i - 1]);
+								m_data[i] = std::move(m_data[i - 1]);
+								m_control[i] = m_control[i - 1] + 1;
+							}
+							m_keys[idx] = K(std::forward<KeyT>(_key));
+							m_data[idx] = T(std::forward<DataT>(_data));
+						}
+						else
+						{
+							new (&m_keys[idx]) K(std::forward<KeyT>(_key));
+							new (&m_data[idx]) T(std::forward<DataT>(_data));
+						}
+						m_control[idx] = static_cast<uint8_t>(ctrl);
+						++m_size;
+						return idx;
+					}
+				}
+
+				rehash((m_bucketMask + 1) * 2);
+			}
+		}
+
+		void eraseIndex(uint32_t _idx)
+		{
+			// Backward shift: move all following displaced elements one slot closer to their home.
+			uint32_t idx = _idx;
+			while (m_control[idx + 1] > 1)
+			{
+				m_keys[idx] = std::move(m_keys[idx + 1]);
+				m_data[idx] = std::move(m_data[idx + 1]);
+				m_control[idx] = m_control[idx + 1] - 1;
+				++idx;
+			}
+			m_keys[idx].~K();
+			m_data[idx].~T();
+			m_control[idx] = 0;
+			--m_size;
+		}
+
+		/// Move all elements into a table with _numBuckets buckets.
+		/// Since the old slots are sorted by home bucket, elements are reinserted in a single linear pass.
+		void rehash(uint32_t _numBuckets)
+		{
+			uint8_t* oldControl = m_control;
+			K* oldKeys = m_keys;
+			T* oldData = m_data;
+			const uint32_t oldSlots = m_numSlots;
+
+			allocate(_numBuckets);
+			for (uint32_t i = 0; i < oldSlots; ++i)
+			{
+				if (oldControl[i])
+				{
+					insertUnique(static_cast<uint64_t>(m_hash(oldKeys[i])), std::move(oldKeys[i]), std::move(oldData[i]));
+					oldKeys[i].~K();
+					oldData[i].~T();
+				}
+			}
+
+			free(oldControl);
+			free(oldKeys);
+			free(oldData);
+		}
+	};
+
+} // namespace utils
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <bit>
+#include <cinttypes>
+#include <algorithm>
+
+namespace utils {
+
+	/// Set of non-negative integers (e.g. entity ids) with one bit per element and a second level
+	/// with one bit per 64-bit word of the first level.
+	/// \details A summary bit is set iff the corresponding word contains any element. Iteration,
+	///		in particular over the intersection of multiple sets, uses the summary to skip
+	///		ranges of 4096 elements which are empty in at least one set with a single test.
+	class HierarchicalBitSet
+	{
+	public:
+		constexpr static uint32_t WORD_BITS = 64;
+		constexpr static uint32_t SUMMARY_RANGE = WORD_BITS * WORD_BITS;
+
+		HierarchicalBitSet() = default;
+
+		void set(uint32_t _index)
+		{
+			const uint32_t word = _index / WORD_BITS;
+			if (word >= m_words.size())
+			{
+				m_words.resize(word + 1, 0);
+				m_summary.resize(word / WORD_BITS + 1, 0);
+			}
+			m_words[word] |= bit(_index);
+			m_summary[word / WORD_BITS] |= bit(word);
+		}
+
+		void reset(uint32_t _index)
+		{
+			const uint32_t word = _index / WORD_BITS;
+			if (word >= m_words.size()) return;
+
+			m_words[word] &= ~bit(_index);
+			if (!m_words[word])
+				m_summary[word / WORD_BITS] &= ~bit(word);
+		}
+
+		bool test(uint32_t _index) const
+		{
+			const uint32_t word = _index / WORD_BITS;
+			return word < m_words.size() && (m_words[word] & bit(_index));
+		}
+
+		/// Remove all elements but keep the memory.
+		void clear()
+		{
+			std::fill(m_words.begin(), m_words.end(), 0);
+			std::fill(m_summary.begin(), m_summary.end(), 0);
+		}
+
+		bool empty() const
+		{
+			return std::none_of(m_summary.begin(), m_summary.end(), [](uint64_t _w) { return _w != 0; });
+		}
+
+		/// Call _fn(index) for each element in ascending order.
+		template<typename Fn>
+		void forEach(Fn&& _fn) const
+		{
+			const HierarchicalBitSet* self = this;
+			forEachIntersection(std::span(&self, 1), {}, _fn);
+		}
+
+		/// Call _fn(index) in ascending order for each element which is contained in all
+		/// _include sets and in none of the _exclude sets.
+		/// \details Sets can be modified by _fn, but changes in the current range of 64
+		///		elements may not be visible to the iteration.
+		template<typename Fn>
+		static void forEachIntersection(std::span<const HierarchicalBitSet* const> _include,
+			std::span<const HierarchicalBitSet* const> _exclude, Fn&& _fn)
+		{
+			if (_include.empty()) return;
+
+			size_t numSummary = _include[0]->m_summary.size();
+			for (const HierarchicalBitSet* set : _include)
+				numSummary = std::min(numSummary, set->m_summary.size());
+
+			for (size_t s = 0; s < numSummary; ++s)
+			{
+				uint64_t summary = ~uint64_t(0);
+				for (const HierarchicalBitSet* set : _include)
+					summary &= set->m_summary[s];
+
+				while (summary)
+				{
+					const size_t w = s * WORD_BITS + std::countr_zero(summary);
+					summary &= summary - 1;
+
+					uint64_t word = ~uint64_t(0);
+					for (const HierarchicalBitSet* set : _include)
+						word &= set->m_words[w];
+					for (const HierarchicalBitSet* set : _exclude)
+						if (w < set->m_words.size()) word &= ~set->m_words[w];
+
+					while (word)
+					{
+						_fn(static_cast<uint32_t>(w * WORD_BITS + std::countr_zero(word)));
+						word &= word - 1;
+					}
+				}
+			}
+		}
+
+	private:
+		static uint64_t bit(uint32_t _index) { return uint64_t(1) << (_index % WORD_BITS); }
+
+		std::vector<uint64_t> m_words;
+		std::vector<uint64_t> m_summary;
+	};
+}
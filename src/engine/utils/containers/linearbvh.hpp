@@ -0,0 +1,440 @@
+#pragma once
+
+#include "../threadpool.hpp"
+#include "../assert.hpp"
+#include "../../math/geometrictypes.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+#include <array>
+#include <span>
+#include <memory>
+#include <memory_resource>
+#include <atomic>
+#include <limits>
+#include <cmath>
+#include <bit>
+#include <cinttypes>
+
+namespace utils {
+
+	// Bounding volume hierarchy for axis aligned bounding boxes which is stored in flat arrays
+	// and rebuilt from scratch instead of being updated.
+	// The elements are sorted by the Morton code of their box centers. The hierarchy is the
+	// binary radix tree over these codes (Karras 2012): every internal node splits its range
+	// where the highest differing bit changes. Three levels of this tree correspond to one
+	// octree subdivision of the scene bounds, with empty octants left out.
+	// All build steps run in parallel on a ThreadPool and the result does not depend on the
+	// number of threads.
+	template<typename T, int Dim, typename FloatT>
+	class LinearBVH
+	{
+	public:
+		using AABB = math::AABB<Dim, FloatT>;
+		using VecT = glm::vec<Dim, FloatT, glm::defaultp>;
+
+		LinearBVH() = default;
+
+		/// @brief Replace the contents of the tree.
+		/// @param _boxes Bounding box of each element.
+		/// @param _elements The elements, _elements[i] belongs to _boxes[i].
+		/// @param _threadPool Threads used for the build.
+		void build(std::span<const AABB> _boxes, std::span<const T> _elements, ThreadPool& _threadPool = ThreadPool::get());
+
+		/// @brief Remove all elements but keep the memory.
+		void clear()
+		{
+			m_nodes.clear();
+			m_leafBoxes.clear();
+			m_leafElements.clear();
+		}
+
+		size_t size() const { return m_leafElements.size(); }
+		bool empty() const { return m_leafElements.empty(); }
+
+		/* Interface of the Processor, same as for SparseOctree
+			struct TreeProcessor
+			{
+				bool descend(const AABB& currentBox);
+				void process(const AABB& key, const T& el);
+			};
+		*/
+		template<class Processor>
+		void traverse(Processor& _proc) const
+		{
+			if (m_leafElements.empty()) return;
+
+			std::array<uint32_t, MAX_DEPTH> stack;
+			size_t stackSize = 0;
+			stack[stackSize++] = m_leafElements.size() == 1 ? (0 | LEAF_FLAG) : 0;
+			while (stackSize)
+			{
+				const uint32_t idx = stack[--stackSize];
+				if (idx & LEAF_FLAG)
+				{
+					const uint32_t leaf = idx & ~LEAF_FLAG;
+					_proc.process(m_leafBoxes[leaf], m_leafElements[leaf]);
+					continue;
+				}
+
+				const Node& node = m_nodes[idx];
+				if (!_proc.descend(node.box)) continue;
+				stack[stackSize++] = node.childs[1];
+				stack[stackSize++] = node.childs[0];
+			}
+		}
+
+		/// @brief Processor which retrieves all elements which overlap with the given AABB.
+		struct AABBQuery
+		{
+			AABBQuery(const AABB& _aabb, std::pmr::memory_resource* _resource = std::pmr::get_default_resource())
+				: aabb(_aabb), hits(_resource) {}
+
+			AABB aabb;
+			std::pmr::vector<T> hits;
+
+			bool descend(const AABB& currentBox) const
+			{
+				return aabb.intersect(currentBox);
+			}
+			void process(const AABB& key, const T& el)
+			{
+				if (aabb.intersect(key)) hits.push_back(el);
+			}
+		};
+
+		/// @brief Bounds of all elements. Only valid if the tree is not empty.
+		const AABB& getRootAABB() const { return m_nodes.empty() ? m_leafBoxes.front() : m_nodes.front().box; }
+
+	private:
+		constexpr static int BITS_PER_AXIS = std::min(64 / Dim, 32);
+		constexpr static uint32_t LEAF_FLAG = 1u << 31;
+		// Each level consumes at least one bit of the code or of the index used for ties.
+		constexpr static size_t MAX_DEPTH = 64 + 32 + 1;
+		constexpr static size_t MIN_CHUNK_SIZE = 1024;
+		constexpr static int RADIX_BITS = 8;
+		constexpr static uint32_t RADIX_SIZE = 1u << RADIX_BITS;
+
+		struct Node
+		{
+			AABB box;
+			uint32_t childs[2]; ///< index into m_nodes or leaf index with LEAF_FLAG
+		};
+
+		static uint64_t spreadBits(uint64_t _x);
+		static uint64_t mortonCode(const std::array<uint32_t, Dim>& _coords);
+
+		// Number of common leading bits of the sorted codes i and j where equal codes are
+		// distinguished by their index. -1 if j is out of range.
+		int commonPrefix(int64_t _i, int64_t _j) const
+		{
+			if (_j < 0 || _j >= static_cast<int64_t>(m_codes.size())) return -1;
+			const uint64_t a = m_codes[_i];
+			const uint64_t b = m_codes[_j];
+			if (a == b) return 64 + std::countl_zero(static_cast<uint32_t>(_i ^ _j));
+			return std::countl_zero(a ^ b);
+		}
+
+		void computeCodes(std::span<const AABB> _boxes, ThreadPool& _threadPool);
+		void sortCodes(ThreadPool& _threadPool);
+		void buildHierarchy(ThreadPool& _threadPool);
+		void computeBounds(ThreadPool& _threadPool);
+
+		// Number of fixed chunks to split n elements into for multi pass algorithms.
+		static size_t numChunks(size_t _n, const ThreadPool& _threadPool)
+		{
+			return std::max<size_t>(1, std::min<size_t>(_threadPool.numThreads(), _n / MIN_CHUNK_SIZE));
+		}
+
+		std::vector<Node> m_nodes;
+		std::vector<AABB> m_leafBoxes;
+		std::vector<T> m_leafElements;
+
+		// temporary build data which is kept to avoid allocations
+		std::vector<uint64_t> m_codes;
+		std::vector<uint64_t> m_codesTmp;
+		std::vector<uint32_t> m_indices;
+		std::vector<uint32_t> m_indicesTmp;
+		std::vector<uint32_t> m_parents; ///< internal nodes followed by the leafs
+		std::unique_ptr<std::atomic<uint32_t>[]> m_visits;
+		size_t m_visitsCapacity = 0;
+	};
+
+	template<typename T, int Dim, typename FloatT>
+	void LinearBVH<T, Dim, FloatT>::build(std::span<const AABB> _boxes, std::span<const T> _elements, ThreadPool& _threadPool)
+	{
+		ASSERT(_boxes.size() == _elements.size(), "Each element needs a bounding box.");
+		ASSERT(_boxes.size() < LEAF_FLAG, "Too many elements.");
+
+		clear();
+		const size_t n = _boxes.size();
+		if (!n) return;
+
+		computeCodes(_boxes, _threadPool);
+		sortCodes(_threadPool);
+
+		m_leafBoxes.resize(n);
+		m_leafElements.resize(n);
+		_threadPool.parallelFor(0, n, [&](size_t _begin, size_t _end)
+		{
+			for (size_t i = _begin; i < _end; ++i)
+			{
+				m_leafBoxes[i] = _boxes[m_indices[i]];
+				m_leafElements[i] = _elements[m_indices[i]];
+			}
+		}, MIN_CHUNK_SIZE);
+
+		if (n == 1) return;
+		buildHierarchy(_threadPool);
+		computeBounds(_threadPool);
+	}
+
+	template<typename T, int Dim, typename FloatT>
+	uint64_t LinearBVH<T, Dim, FloatT>::spreadBits(uint64_t _x)
+	{
+		if constexpr (Dim == 3)
+		{
+			_x &= 0x1fffff;
+			_x = (_x | _x << 32) & 0x1f00000000ffffull;
+			_x = (_x | _x << 16) & 0x1f0000ff0000ffull;
+			_x = (_x | _x << 8) & 0x100f00f00f00f00full;
+			_x = (_x | _x << 4) & 0x10c30c30c30c30c3ull;
+			_x = (_x | _x << 2) & 0x1249249249249249ull;
+		}
+		else if constexpr (Dim == 2)
+		{
+			_x &= 0xffffffff;
+			_x = (_x | _x << 16) & 0x0000ffff0000ffffull;
+			_x = (_x | _x << 8) & 0x00ff00ff00ff00ffull;
+			_x = (_x | _x << 4) & 0x0f0f0f0f0f0f0f0full;
+			_x = (_x | _x << 2) & 0x3333333333333333ull;
+			_x = (_x | _x << 1) & 0x5555555555555555ull;
+		}
+		else
+		{
+			uint64_t result = 0;
+			for (int b = 0; b < BITS_PER_AXIS; ++b)
+				result |= ((_x >> b) & 1) << (b * Dim);
+			_x = result;
+		}
+		return _x;
+	}
+
+	template<typename T, int Dim, typename FloatT>
+	uint64_t LinearBVH<T, Dim, FloatT>::mortonCode(const std::array<uint32_t, Dim>& _coords)
+	{
+		uint64_t code = 0;
+		for (int d = 0; d < Dim; ++d)
+			code |= spreadBits(_coords[d]) << (Dim - 1 - d);
+		return code;
+	}
+
+	template<typename T, int Dim, typename FloatT>
+	void LinearBVH<T, Dim, FloatT>::computeCodes(std::span<const AABB> _boxes, ThreadPool& _threadPool)
+	{
+		const size_t n = _boxes.size();
+
+		// bounds of the centers
+		const size_t chunks = numChunks(n, _threadPool);
+		std::vector<AABB> chunkBounds(chunks);
+		_threadPool.parallelFor(0, chunks, [&](size_t _begin, size_t _end)
+		{
+			for (size_t c = _begin; c < _end; ++c)
+			{
+				AABB bounds;
+				bounds.min = VecT(std::numeric_limits<FloatT>::max());
+				bounds.max = VecT(std::numeric_limits<FloatT>::lowest());
+				for (size_t i = n * c / chunks; i < n * (c + 1) / chunks; ++i)
+				{
+					const VecT center = (_boxes[i].min + _boxes[i].max) * static_cast<FloatT>(0.5);
+					bounds.min = glm::min(bounds.min, center);
+					bounds.max = glm::max(bounds.max, center);
+				}
+				chunkBounds[c] = bounds;
+			}
+		});
+		AABB bounds = chunkBounds[0];
+		for (const AABB& box : chunkBounds)
+		{
+			bounds.min = glm::min(bounds.min, box.min);
+			bounds.max = glm::max(bounds.max, box.max);
+		}
+
+		// 2^32 - 1 is not representable as float and would round up, so use the largest
+		// value below 2^BITS_PER_AXIS which still truncates to a valid coordinate.
+		const FloatT maxCoord = std::nextafter(static_cast<FloatT>(uint64_t(1) << BITS_PER_AXIS), static_cast<FloatT>(0));
+		VecT scale;
+		for (int d = 0; d < Dim; ++d)
+		{
+			const FloatT extent = bounds.max[d] - bounds.min[d];
+			scale[d] = extent > 0 ? maxCoord / extent : 0;
+		}
+
+		m_codes.resize(n);
+		m_indices.resize(n);
+		_threadPool.parallelFor(0, n, [&](size_t _begin, size_t _end)
+		{
+			for (size_t i = _begin; i < _end; ++i)
+			{
+				const VecT center = (_boxes[i].min + _boxes[i].max) * static_cast<FloatT>(0.5);
+				const VecT quantized = glm::clamp((center - bounds.min) * scale, VecT(0), VecT(maxCoord));
+				std::array<uint32_t, Dim> coords;
+				for (int d = 0; d < Dim; ++d)
+					coords[d] = static_cast<uint32_t>(quantized[d]);
+				m_codes[i] = mortonCode(coords);
+				m_indices[i] = static_cast<uint32_t>(i);
+			}
+		}, MIN_CHUNK_SIZE);
+	}
+
+	// Parallel least significant digit radix sort of the (code, index) pairs.
+	// Each chunk counts its digits, then every chunk scatters to its own precomputed offsets
+	// which keeps the sort stable.
+	template<typename T, int Dim, typename FloatT>
+	void LinearBVH<T, Dim, FloatT>::sortCodes(ThreadPool& _threadPool)
+	{
+		const size_t n = m_codes.size();
+		const size_t chunks = numChunks(n, _threadPool);
+		m_codesTmp.resize(n);
+		m_indicesTmp.resize(n);
+		std::vector<std::array<uint32_t, RADIX_SIZE>> offsets(chunks);
+
+		constexpr int NUM_BITS = BITS_PER_AXIS * Dim;
+		for (int shift = 0; shift < NUM_BITS; shift += RADIX_BITS)
+		{
+			_threadPool.parallelFor(0, chunks, [&](size_t _begin, size_t _end)
+			{
+				for (size_t c = _begin; c < _end; ++c)
+				{
+					offsets[c].fill(0);
+					for (size_t i = n * c / chunks; i < n * (c + 1) / chunks; ++i)
+						++offsets[c][(m_codes[i] >> shift) & (RADIX_SIZE - 1)];
+				}
+			});
+
+			// Passes where all codes have the same digit do not change the order.
+			uint32_t sum = 0;
+			bool isSorted = false;
+			for (uint32_t digit = 0; digit < RADIX_SIZE; ++digit)
+			{
+				uint32_t digitCount = 0;
+				for (size_t c = 0; c < chunks; ++c)
+				{
+					const uint32_t count = offsets[c][digit];
+					offsets[c][digit] = sum;
+					sum += count;
+					digitCount += count;
+				}
+				isSorted |= digitCount == n;
+			}
+			if (isSorted) continue;
+
+			_threadPool.parallelFor(0, chunks, [&](size_t _begin, size_t _end)
+			{
+				for (size_t c = _begin; c < _end; ++c)
+				{
+					std::array<uint32_t, RADIX_SIZE>& offset = offsets[c];
+					for (size_t i = n * c / chunks; i < n * (c + 1) / chunks; ++i)
+					{
+						const uint32_t target = offset[(m_codes[i] >> shift) & (RADIX_SIZE - 1)]++;
+						m_codesTmp[target] = m_codes[i];
+						m_indicesTmp[target] = m_indices[i];
+					}
+				}
+			});
+			m_codes.swap(m_codesTmp);
+			m_indices.swap(m_indicesTmp);
+		}
+	}
+
+	// Every internal node is found independently of the others: node i starts or ends at
+	// leaf i and extends in the direction of the larger common prefix as long as the prefix
+	// stays longer than the one to the other neighbour.
+	template<typename T, int Dim, typename FloatT>
+	void LinearBVH<T, Dim, FloatT>::buildHierarchy(ThreadPool& _threadPool)
+	{
+		const int64_t n = static_cast<int64_t>(m_codes.size());
+		m_nodes.resize(n - 1);
+		m_parents.resize(2 * n - 1);
+		m_parents[0] = std::numeric_limits<uint32_t>::max();
+
+		_threadPool.parallelFor(0, n - 1, [&](size_t _begin, size_t _end)
+		{
+			for (int64_t i = static_cast<int64_t>(_begin); i < static_cast<int64_t>(_end); ++i)
+			{
+				const int64_t d = commonPrefix(i, i + 1) > commonPrefix(i, i - 1) ? 1 : -1;
+
+				// find the other end of the range
+				const int minPrefix = commonPrefix(i, i - d);
+				int64_t maxLength = 2;
+				while (commonPrefix(i, i + maxLength * d) > minPrefix) maxLength *= 2;
+				int64_t length = 0;
+				for (int64_t t = maxLength / 2; t >= 1; t /= 2)
+					if (commonPrefix(i, i + (length + t) * d) > minPrefix) length += t;
+				const int64_t j = i + length * d;
+
+				// find the split position
+				const int nodePrefix = commonPrefix(i, j);
+				int64_t split = 0;
+				for (int64_t div = 2, t = length; t > 1; div *= 2)
+				{
+					t = (length + div - 1) / div;
+					if (commonPrefix(i, i + (split + t) * d) > nodePrefix) split += t;
+				}
+				const int64_t gamma = i + split * d + std::min<int64_t>(d, 0);
+
+				Node& node = m_nodes[i];
+				const uint32_t left = static_cast<uint32_t>(gamma);
+				const uint32_t right = static_cast<uint32_t>(gamma + 1);
+				const bool leftIsLeaf = std::min(i, j) == gamma;
+				const bool rightIsLeaf = std::max(i, j) == gamma + 1;
+				node.childs[0] = leftIsLeaf ? (left | LEAF_FLAG) : left;
+				node.childs[1] = rightIsLeaf ? (right | LEAF_FLAG) : right;
+				m_parents[leftIsLeaf ? n - 1 + left : left] = static_cast<uint32_t>(i);
+				m_parents[rightIsLeaf ? n - 1 + right : right] = static_cast<uint32_t>(i);
+			}
+		}, MIN_CHUNK_SIZE);
+	}
+
+	// Bottom-up from each leaf; the second visitor of a node computes its box, so each node
+	// is processed exactly once after both childs are done.
+	template<typename T, int Dim, typename FloatT>
+	void LinearBVH<T, Dim, FloatT>::computeBounds(ThreadPool& _threadPool)
+	{
+		const size_t n = m_leafBoxes.size();
+		if (m_visitsCapacity < n - 1)
+		{
+			m_visits = std::make_unique<std::atomic<uint32_t>[]>(n - 1);
+			m_visitsCapacity = n - 1;
+		}
+		_threadPool.parallelFor(0, n - 1, [&](size_t _begin, size_t _end)
+		{
+			for (size_t i = _begin; i < _end; ++i)
+				m_visits[i].store(0, std::memory_order_relaxed);
+		}, MIN_CHUNK_SIZE);
+
+		auto childBox = [&](uint32_t _child) -> const AABB&
+		{
+			return (_child & LEAF_FLAG) ? m_leafBoxes[_child & ~LEAF_FLAG] : m_nodes[_child].box;
+		};
+
+		_threadPool.parallelFor(0, n, [&](size_t _begin, size_t _end)
+		{
+			for (size_t leaf = _begin; leaf < _end; ++leaf)
+			{
+				uint32_t node = m_parents[n - 1 + leaf];
+				while (node != std::numeric_limits<uint32_t>::max())
+				{
+					if (m_visits[node].fetch_add(1, std::memory_order_acq_rel) == 0)
+						break;
+
+					Node& current = m_nodes[node];
+					const AABB& left = childBox(current.childs[0]);
+					const AABB& right = childBox(current.childs[1]);
+					current.box.min = glm::min(left.min, right.min);
+					current.box.max = glm::max(left.max, right.max);
+					node = m_parents[node];
+				}
+			}
+		}, MIN_CHUNK_SIZE);
+	}
+}
@@ -2,15 +2,27 @@
 
 #include "../blockalloc.hpp"
 #include "../../math/geometrictypes.hpp"
+#include "../../math/intersection.hpp"
 #include <glm/glm.hpp>
 #include <memory>
+#include <memory_resource>
 #include <vector>
 #include <concepts>
 #include <array>
+#include <span>
+#include <tuple>
+#include <limits>
+#include <optional>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
 
 namespace utils {
 
 	// Sparse octree for axis aligned bounding boxes.
+	// Optionally the octree is loose: The bounds of each node are extended by a factor of
+	// its size on each side, so that elements close to the split planes can still be stored
+	// in the child nodes and small movements do not require an element to change its node.
 	template<typename T, int Dim, typename FloatT>
 	class SparseOctree
 	{
@@ -20,7 +32,13 @@ namespace utils {
 		
 		/// @brief Construct a sparse octree with a single node.
 		/// @param _rootSize The initial size of the outer bounding box.
-		SparseOctree(FloatT _rootSize = 1.f) : m_size(_rootSize) { initRoot(_rootSize); }
+		/// @param _looseness Each node accepts elements which exceed its bounds by up to
+		///		_looseness * node size on each side. 0 creates a regular octree.
+		SparseOctree(FloatT _rootSize = 1.f, FloatT _looseness = 0.f)
+			: m_size(_rootSize), m_looseness(_looseness)
+		{
+			initRoot(_rootSize);
+		}
 
 		/// @brief Insert a new element into the tree. Does not check for duplicates.
 		/// @details If the box lies outside the current tree the root is expanded first.
@@ -33,6 +51,17 @@ namespace utils {
 		/// @param _el The element to remove.
 		/// @return True if the element was found.
 		bool remove(const AABB& _boundingBox, const T& _el);
+
+		/// @brief Change the bounding box of an element.
+		/// @details The element is only moved if an insert of the new box would end in a
+		///		different node. Otherwise just the stored box is replaced. In a loose tree
+		///		elements are placed by their center, so they stay in their node while the center
+		///		does not cross the node's bounds.
+		/// @param _oldBox The box which was used for the last insert/update of the element.
+		/// @param _newBox The new bounding box.
+		/// @param _el The element to update.
+		/// @return True if the element was found.
+		bool update(const AABB& _oldBox, const AABB& _newBox, const T& _el);
 		
 		/// @brief Remove all elements from the tree.
 		void clear()
@@ -44,6 +73,7 @@ namespace utils {
 		/* Interface of the Processor
 			struct TreeProcessor
 			{
+				// currentBox includes the looseness of the node
 				bool descend(const AABB& currentBox);
 				void process(const AABB& key, T& el);
 			};
@@ -53,13 +83,26 @@ namespace utils {
 		{
 			m_rootNode->traverse(proc);
 		}
+
+		/// @brief Find all elements which overlap any of the query boxes in a single traversal.
+		/// @details The set of queries is pushed down the tree together and partitioned at each
+		///		node, so that every node is visited once for all queries which reach it instead
+		///		of once per query.
+		/// @param _queries The boxes to search for.
+		/// @param _fn Called as _fn(queryIndex, key, el) for each query box which overlaps an element.
+		/// @param _resource Memory for temporary data, e.g. utils::FrameArena::get().
+		template<typename Fn>
+		void traverseBatch(std::span<const AABB> _queries, Fn&& _fn,
+			std::pmr::memory_resource* _resource = std::pmr::get_default_resource()) const;
 		/// @brief Processor which retrieves all elements which overlap with the given AABB.
+		/// @param _resource Memory for the hits, e.g. utils::FrameArena::get() for a per-tick query.
 		struct AABBQuery
 		{
-			AABBQuery(const AABB& _aabb) : aabb(_aabb) {}
+			AABBQuery(const AABB& _aabb, std::pmr::memory_resource* _resource = std::pmr::get_default_resource())
+				: aabb(_aabb), hits(_resource) {}
 
 			AABB aabb;
-			std::vector<T> hits;
+			std::pmr::vector<T> hits;
 
 			bool descend(const AABB& currentBox) const
 			{
@@ -71,11 +114,126 @@ namespace utils {
 			}
 		};
 
+
+		/// @brief Element with its distance to a ray origin or query point.
+		struct Hit
+		{
+			FloatT distance;
+			T element;
+		};
+
+		/// @brief Processor which retrieves all elements whose box is hit by a ray.
+		/// @details Distances are in multiples of the ray direction. The hits are not sorted.
+		struct RayQuery
+		{
+			RayQuery(const math::Ray<Dim, FloatT>& _ray, FloatT _maxDistance = std::numeric_limits<FloatT>::max(),
+				std::pmr::memory_resource* _resource = std::pmr::get_default_resource())
+				: origin(_ray.origin), invDirection(VecT(1) / _ray.direction), maxDistance(_maxDistance), hits(_resource) {}
+
+			VecT origin;
+			VecT invDirection;
+			FloatT maxDistance;
+			std::pmr::vector<Hit> hits;
+
+			bool descend(const AABB& currentBox) const
+			{
+				return math::intersect<Dim, FloatT>(origin, invDirection, currentBox, maxDistance).has_value();
+			}
+			void process(const AABB& key, const T& el)
+			{
+				if (auto t = math::intersect<Dim, FloatT>(origin, invDirection, key, maxDistance))
+					hits.push_back({ *t, el });
+			}
+		};
+
+		/// @brief Processor which retrieves all elements hit by a box moving along a displacement,
+		///		for continuous collision detection of fast objects.
+		/// @details Hit::distance is the time of impact in [0, 1], 0 for elements which overlap the
+		///		box at the start. The hits are not sorted.
+		struct SweepQuery
+		{
+			SweepQuery(const AABB& _box, const VecT& _displacement,
+				std::pmr::memory_resource* _resource = std::pmr::get_default_resource())
+				: box(_box), displacement(_displacement), hits(_resource) {}
+
+			AABB box;
+			VecT displacement;
+			std::pmr::vector<Hit> hits;
+
+			bool descend(const AABB& currentBox) const
+			{
+				return math::sweep<Dim, FloatT>(box, displacement, currentBox).has_value();
+			}
+			void process(const AABB& key, const T& el)
+			{
+				if (auto t = math::sweep<Dim, FloatT>(box, displacement, key))
+					hits.push_back({ *t, el });
+			}
+		};
+
+		/// @brief Processor which retrieves all elements whose box is within a radius of a point.
+		struct RadiusQuery
+		{
+			RadiusQuery(const VecT& _center, FloatT _radius, std::pmr::memory_resource* _resource = std::pmr::get_default_resource())
+				: center(_center), radiusSq(_radius * _radius), hits(_resource) {}
+
+			VecT center;
+			FloatT radiusSq;
+			std::pmr::vector<T> hits;
+
+			bool descend(const AABB& currentBox) const
+			{
+				return math::distanceSq<Dim, FloatT>(center, currentBox) <= radiusSq;
+			}
+			void process(const AABB& key, const T& el)
+			{
+				if (math::distanceSq<Dim, FloatT>(center, key) <= radiusSq) hits.push_back(el);
+			}
+		};
+
+		/// @brief Find the closest element whose box is hit by the ray.
+		/// @details Childs are visited front to back and nodes behind the current closest hit
+		///		are skipped.
+		/// @param _maxDistance Maximum distance in multiples of the ray direction.
+		std::optional<Hit> rayCast(const math::Ray<Dim, FloatT>& _ray, FloatT _maxDistance = std::numeric_limits<FloatT>::max()) const;
+
+		/// @brief Find the _k elements whose boxes are closest to a point.
+		/// @param _result Receives up to _k elements sorted by distance. Previous content is removed.
+		/// @param _maxDistance Only elements within this distance are considered.
+		void nearest(const VecT& _point, size_t _k, std::pmr::vector<Hit>& _result,
+			FloatT _maxDistance = std::numeric_limits<FloatT>::max()) const;
+
 		const AABB& getRootAABB() const { return m_rootNode->box; }
 	
 	private:
 		constexpr static FloatT MIN_SIZE = 1.0 / (2 << 3);
 
+		// Bit mask of the child indices which are in the upper half of the given axis.
+		constexpr static std::array<uint32_t, Dim> computeUpperChilds()
+		{
+			std::array<uint32_t, Dim> masks{};
+			for (int a = 0; a < Dim; ++a)
+				for (int c = 0; c < (1 << Dim); ++c)
+					if (c & (1 << a)) masks[a] |= 1u << c;
+			return masks;
+		}
+		constexpr static std::array<uint32_t, Dim> UPPER_CHILDS = computeUpperChilds();
+
+		// Adapter for a single query of traverseBatch.
+		template<typename Fn>
+		struct SingleQuery
+		{
+			const AABB& query;
+			uint32_t queryIdx;
+			Fn& fn;
+
+			bool descend(const AABB& currentBox) const { return query.intersect(currentBox); }
+			void process(const AABB& key, const T& el)
+			{
+				if (query.intersect(key)) fn(queryIdx, key, el);
+			}
+		};
+
 		void initRoot(FloatT _size)
 		{
 			AABB box;
@@ -85,101 +243,144 @@ namespace utils {
 				box.max[i] = _size;
 			}
 
-			m_rootNode = m_allocator.create(box);
+			m_rootNode = m_allocator.create(box, m_looseness);
 		}
 
 		struct Node
 		{
-			explicit Node(const AABB& _box) noexcept
-				: box{_box}, childs{}
+			explicit Node(const AABB& _box, FloatT _looseness) noexcept
+				: box{_box}, looseBox{_box}, childs{}
 			{
+				const VecT margin = (box.max - box.min) * _looseness;
+				looseBox.min -= margin;
+				looseBox.max += margin;
 			}
 
-			template<typename Alloc>
-			void insert(const AABB& _boundingBox, const T& el, Alloc& _allocator)
+			// Determine the child which should hold the given box.
+			// Returns -1 if the box should be stored in this node.
+			int childIndex(const AABB& _boundingBox, FloatT _looseness, AABB& _childBox) const
 			{
 				if (box.max[0] - box.min[0] <= MIN_SIZE)
-				{
-					elements.emplace_back(_boundingBox, el);
-					return;
-				}
+					return -1;
 
 				const VecT center = box.min + (box.max - box.min) * static_cast<FloatT>(0.5);
-				AABB newBox;
 				int index = 0;
 				for (int i = 0; i < Dim; ++i)
 				{
-					if (_boundingBox.min[i] < center[i] && _boundingBox.max[i] > center[i])
-					{
-						elements.emplace_back(_boundingBox, el);
-						return;
-					}
-					
-					if (_boundingBox.min[i] >= center[i])
+					// A regular octree sorts by the lower bound, so that boxes touching the
+					// center from below still go into the lower child.
+					const bool upper = _looseness > 0
+						? (_boundingBox.min[i] + _boundingBox.max[i]) * static_cast<FloatT>(0.5) >= center[i]
+						: _boundingBox.min[i] >= center[i];
+					if (upper)
 					{
 						index += 1 << i;
-						newBox.min[i] = center[i];
-						newBox.max[i] = box.max[i];
+						_childBox.min[i] = center[i];
+						_childBox.max[i] = box.max[i];
 					}
 					else
 					{
-						newBox.min[i] = box.min[i];
-						newBox.max[i] = center[i];
+						_childBox.min[i] = box.min[i];
+						_childBox.max[i] = center[i];
 					}
+
+					const FloatT margin = (_childBox.max[i] - _childBox.min[i]) * _looseness;
+					if (_boundingBox.min[i] < _childBox.min[i] - margin || _boundingBox.max[i] > _childBox.max[i] + margin)
+						return -1;
 				}
 
-				if (!childs[index]) childs[index] = _allocator.create(newBox);
-				childs[index]->insert(_boundingBox, el, _allocator);
+				return index;
 			}
 
-			// Search in the tree rooted at this node and remove the element if found.
-			bool remove(const AABB& _boundingBox, const T& el)
+			template<typename Alloc>
+			void insert(const AABB& _boundingBox, const T& el, FloatT _looseness, Alloc& _allocator)
 			{
-				if (box.max[0] - box.min[0] <= MIN_SIZE)
+				Node* node = this;
+				AABB childBox;
+				int index;
+				while ((index = node->childIndex(_boundingBox, _looseness, childBox)) >= 0)
 				{
-					return remove(el);
+					if (!node->childs[index]) node->childs[index] = _allocator.create(childBox, _looseness);
+					node = node->childs[index];
 				}
+				node->elements.emplace_back(_boundingBox, el);
+			}
 
-				const VecT center = box.min + (box.max - box.min) * static_cast<FloatT>(0.5);
-				int index = 0;
-				for (int i = 0; i < Dim; ++i)
+			// Search the element along the path an insert of the box would take.
+			Node* find(const AABB& _boundingBox, const T& el, FloatT _looseness, size_t& _idx)
+			{
+				Node* node = this;
+				AABB childBox;
+				while (node)
 				{
-					if (_boundingBox.min[i] < center[i] && _boundingBox.max[i] >= center[i])
+					for (size_t i = 0; i < node->elements.size(); ++i)
 					{
-						return remove(el);
+						if (node->elements[i].second == el)
+						{
+							_idx = i;
+							return node;
+						}
 					}
 
-					if (_boundingBox.min[i] >= center[i])
-					{
-						index += 1 << i;
-					}
+					const int index = node->childIndex(_boundingBox, _looseness, childBox);
+					node = index >= 0 ? node->childs[index] : nullptr;
 				}
+				return nullptr;
+			}
 
-				if (childs[index]) 
-					return childs[index]->remove(_boundingBox, el);
+			// Follow the path an insert of the box would take as far as the nodes exist.
+			// Returns true if the box would be stored in the returned node.
+			bool findTarget(const AABB& _boundingBox, FloatT _looseness, Node*& _target)
+			{
+				_target = this;
+				AABB childBox;
+				int index;
+				while ((index = _target->childIndex(_boundingBox, _looseness, childBox)) >= 0)
+				{
+					if (!_target->childs[index]) return false;
+					_target = _target->childs[index];
+				}
+				return true;
+			}
 
-				return false;
+			// Remove the element at the given position from this node.
+			void erase(size_t _idx)
+			{
+				if (_idx + 1 < elements.size())
+					elements[_idx] = std::move(elements.back());
+				elements.pop_back();
 			}
 
-			// Remove element from this node.
-			bool remove(const T& el)
+			// Check whether an insert of the box would end in this node.
+			// Requires that the box would be routed into this node by the parent.
+			bool isTarget(const AABB& _boundingBox, FloatT _looseness) const
 			{
-				auto it = std::find_if(elements.begin(), elements.end(), [&](const std::pair<AABB, T>& _el)
+				for (int i = 0; i < Dim; ++i)
 				{
-					return _el.second == el;
-				});
-
-				if (it == elements.end())
-					return false;
+					if (_boundingBox.min[i] < looseBox.min[i] || _boundingBox.max[i] > looseBox.max[i])
+						return false;
+				}
+				AABB childBox;
+				return childIndex(_boundingBox, _looseness, childBox) < 0;
+			}
 
-				elements.erase(it);
+			// Check whether the point which determines the child index of a box is in this node.
+			static bool routesTo(const AABB& _boundingBox, FloatT _looseness, const AABB& _box)
+			{
+				for (int i = 0; i < Dim; ++i)
+				{
+					const FloatT p = _looseness > 0
+						? (_boundingBox.min[i] + _boundingBox.max[i]) * static_cast<FloatT>(0.5)
+						: _boundingBox.min[i];
+					if (p < _box.min[i] || p >= _box.max[i]) return false;
+				}
 				return true;
 			}
 
 			template<typename Proc>
 			void traverse(Proc& _proc) const
 			{
-				if (!_proc.descend(box)) return;
+				if (!_proc.descend(looseBox)) return;
 
 				for (auto& [key, val] : elements)
 					_proc.process(key, val);
@@ -189,6 +390,7 @@ namespace utils {
 
 			std::vector< std::pair<AABB, T> > elements;
 			AABB box;
+			AABB looseBox;
 			Node* childs[1 << Dim];
 		};
 
@@ -201,9 +403,11 @@ namespace utils {
 			return true;
 		}
 
-		BlockAllocator<Node, 128> m_allocator;
+		// Trees are typically rebuilt every frame, so keep the blocks cached for the next build.
+		BlockAllocator<Node, 128, true> m_allocator;
 		Node* m_rootNode;
 		FloatT m_size; // initial root size
+		FloatT m_looseness;
 	};
 
 
@@ -230,18 +434,250 @@ namespace utils {
 				else
 					curBox.max[i] += dif[i];
 			}
-			Node* newRoot = m_allocator.create(curBox);
+			Node* newRoot = m_allocator.create(curBox, m_looseness);
 			newRoot->childs[index] = m_rootNode;
 			m_rootNode = newRoot;
 		}
-		m_rootNode->insert(_boundingBox, el, m_allocator);
+		m_rootNode->insert(_boundingBox, el, m_looseness, m_allocator);
+	}
+
+	template<typename T, int Dim, typename FloatT>
+	template<typename Fn>
+	void SparseOctree<T, Dim, FloatT>::traverseBatch(std::span<const AABB> _queries, Fn&& _fn,
+		std::pmr::memory_resource* _resource) const
+	{
+		constexpr int NUM_CHILDS = 1 << Dim;
+
+		// The indices of the queries which reach a node are a range in this buffer. The range
+		// of the node on top of the stack is always at the end, so the buffer works as a stack, too.
+		std::pmr::vector<uint32_t> queries(_resource);
+		std::pmr::vector<uint32_t> childMasks(_resource);
+		std::pmr::vector<std::tuple<const Node*, size_t, size_t>> stack(_resource);
+
+		for (uint32_t i = 0; i < _queries.size(); ++i)
+			if (_queries[i].intersect(m_rootNode->looseBox)) queries.push_back(i);
+		if (queries.empty()) return;
+		stack.emplace_back(m_rootNode, 0, queries.size());
+
+		while (!stack.empty())
+		{
+			const auto [node, begin, end] = stack.back();
+			stack.pop_back();
+			queries.resize(end);
+
+			// Deeper in the tree most queries are alone, where partitioning has no benefit.
+			if (end - begin == 1)
+			{
+				const uint32_t queryIdx = queries[begin];
+				SingleQuery<Fn> proc{ _queries[queryIdx], queryIdx, _fn };
+				for (const auto& [key, val] : node->elements)
+					proc.process(key, val);
+				for (const Node* child : node->childs)
+					if (child) child->traverse(proc);
+				continue;
+			}
+
+			for (const auto& [key, val] : node->elements)
+			{
+				for (size_t i = begin; i < end; ++i)
+					if (_queries[queries[i]].intersect(key)) _fn(queries[i], key, val);
+			}
+
+			// The loose boxes of all childs on the same side of an axis share the same interval.
+			// With the intervals the overlapped childs of a query are found by comparing each
+			// axis once instead of testing each child box.
+			uint32_t existing = 0;
+			AABB lower, upper;
+			for (int i = 0; i < Dim; ++i)
+			{
+				lower.min[i] = upper.min[i] = std::numeric_limits<FloatT>::max();
+				lower.max[i] = upper.max[i] = std::numeric_limits<FloatT>::lowest();
+			}
+			for (int c = 0; c < NUM_CHILDS; ++c)
+			{
+				const Node* child = node->childs[c];
+				if (!child) continue;
+				existing |= 1u << c;
+				for (int i = 0; i < Dim; ++i)
+				{
+					AABB& side = (c & (1 << i)) ? upper : lower;
+					side.min[i] = std::min(side.min[i], child->looseBox.min[i]);
+					side.max[i] = std::max(side.max[i], child->looseBox.max[i]);
+				}
+			}
+			if (!existing) continue;
+
+			childMasks.resize(end - begin);
+			for (size_t i = begin; i < end; ++i)
+			{
+				const AABB& query = _queries[queries[i]];
+				uint32_t mask = existing;
+				for (int a = 0; a < Dim; ++a)
+				{
+					if (query.min[a] > lower.max[a] || query.max[a] < lower.min[a]) mask &= UPPER_CHILDS[a];
+					if (query.min[a] > upper.max[a] || query.max[a] < upper.min[a]) mask &= ~UPPER_CHILDS[a];
+				}
+				childMasks[i - begin] = mask;
+			}
+
+			for (int c = NUM_CHILDS - 1; c >= 0; --c)
+			{
+				if (!(existing & (1u << c))) continue;
+
+				const size_t childBegin = queries.size();
+				for (size_t i = begin; i < end; ++i)
+					if (childMasks[i - begin] & (1u << c)) queries.push_back(queries[i]);
+				if (queries.size() > childBegin)
+					stack.emplace_back(node->childs[c], childBegin, queries.size());
+			}
+		}
+	}
+
+	template<typename T, int Dim, typename FloatT>
+	std::optional<typename SparseOctree<T, Dim, FloatT>::Hit> SparseOctree<T, Dim, FloatT>::rayCast(
+		const math::Ray<Dim, FloatT>& _ray, FloatT _maxDistance) const
+	{
+		const VecT invDirection = VecT(1) / _ray.direction;
+		std::optional<Hit> closest;
+		FloatT maxDistance = _maxDistance;
+
+		std::array<std::byte, 4096> buffer;
+		std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size());
+		std::pmr::vector<std::pair<FloatT, const Node*>> stack(&resource);
+
+		if (auto t = math::intersect<Dim, FloatT>(_ray.origin, invDirection, m_rootNode->looseBox, maxDistance))
+			stack.emplace_back(*t, m_rootNode);
+		while (!stack.empty())
+		{
+			const auto [entry, node] = stack.back();
+			stack.pop_back();
+			if (entry > maxDistance) continue;
+
+			for (const auto& [key, val] : node->elements)
+			{
+				if (auto t = math::intersect<Dim, FloatT>(_ray.origin, invDirection, key, maxDistance))
+				{
+					maxDistance = *t;
+					closest = Hit{ *t, val };
+				}
+			}
+
+			// push in reverse order so that the closest child is visited first
+			const size_t first = stack.size();
+			for (const Node* child : node->childs)
+			{
+				if (!child) continue;
+				if (auto t = math::intersect<Dim, FloatT>(_ray.origin, invDirection, child->looseBox, maxDistance))
+					stack.emplace_back(*t, child);
+			}
+			std::sort(stack.begin() + first, stack.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+		}
+
+		return closest;
+	}
+
+	template<typename T, int Dim, typename FloatT>
+	void SparseOctree<T, Dim, FloatT>::nearest(const VecT& _point, size_t _k, std::pmr::vector<Hit>& _result,
+		FloatT _maxDistance) const
+	{
+		_result.clear();
+		if (!_k) return;
+
+		// Best first search: nodes are processed by the distance of their box, until the
+		// closest remaining node is further away than the k-th closest element found so far.
+		using NodeEntry = std::pair<FloatT, const Node*>;
+		auto closerNode = [](const NodeEntry& a, const NodeEntry& b) { return a.first > b.first; };
+		auto closerHit = [](const Hit& a, const Hit& b) { return a.distance < b.distance; };
+		std::pmr::vector<NodeEntry> queue(_result.get_allocator().resource());
+
+		// squared distances until the end
+		FloatT maxDistSq = _maxDistance < std::sqrt(std::numeric_limits<FloatT>::max())
+			? _maxDistance * _maxDistance : std::numeric_limits<FloatT>::max();
+		queue.emplace_back(math::distanceSq<Dim, FloatT>(_point, m_rootNode->looseBox), m_rootNode);
+		while (!queue.empty())
+		{
+			std::pop_heap(queue.begin(), queue.end(), closerNode);
+			const auto [nodeDist, node] = queue.back();
+			queue.pop_back();
+			if (nodeDist > maxDistSq) break;
+
+			for (const auto& [key, val] : node->elements)
+			{
+				const FloatT dist = math::distanceSq<Dim, FloatT>(_point, key);
+				if (dist > maxDistSq) continue;
+
+				// _result is a max heap of the k closest elements
+				_result.push_back({ dist, val });
+				std::push_heap(_result.begin(), _result.end(), closerHit);
+				if (_result.size() > _k)
+				{
+					std::pop_heap(_result.begin(), _result.end(), closerHit);
+					_result.pop_back();
+				}
+				if (_result.size() == _k)
+					maxDistSq = _result.front().distance;
+			}
+
+			for (const Node* child : node->childs)
+			{
+				if (!child) continue;
+				const FloatT dist = math::distanceSq<Dim, FloatT>(_point, child->looseBox);
+				if (dist > maxDistSq) continue;
+				queue.emplace_back(dist, child);
+				std::push_heap(queue.begin(), queue.end(), closerNode);
+			}
+		}
+
+		std::sort_heap(_result.begin(), _result.end(), closerHit);
+		for (Hit& hit : _result)
+			hit.distance = std::sqrt(hit.distance);
 	}
 
 	template<typename T, int Dim, typename FloatT>
 	bool SparseOctree<T, Dim, FloatT>::remove(const AABB& _boundingBox, const T& el)
 	{
-		return m_rootNode->remove(_boundingBox, el);
+		size_t idx;
+		Node* node = m_rootNode->find(_boundingBox, el, m_looseness, idx);
+		if (!node) return false;
+
+		node->erase(idx);
+		return true;
+	}
+
+	template<typename T, int Dim, typename FloatT>
+	bool SparseOctree<T, Dim, FloatT>::update(const AABB& _oldBox, const AABB& _newBox, const T& el)
+	{
+		size_t idx;
+		Node* node = m_rootNode->find(_oldBox, el, m_looseness, idx);
+		if (!node) return false;
+
+		// The root has to grow first.
+		if (!isIn(_newBox, m_rootNode->box))
+		{
+			node->erase(idx);
+			insert(_newBox, el);
+			return true;
+		}
+
+		// Fast path: The element stays in its node. Since the node boxes are nested, all
+		// parents route the box to the same node if the routing point is still inside it.
+		if (Node::routesTo(_newBox, m_looseness, node->box) && node->isTarget(_newBox, m_looseness))
+		{
+			node->elements[idx].first = _newBox;
+			return true;
+		}
+
+		Node* target;
+		if (m_rootNode->findTarget(_newBox, m_looseness, target) && target == node)
+		{
+			node->elements[idx].first = _newBox;
+			return true;
+		}
+
+		node->erase(idx);
+		target->insert(_newBox, el, m_looseness, m_allocator);
+		return true;
 	}
 
 
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,352 @@
+#pragma once
+
+#include "../assert.hpp"
+#include "../../math/geometrictypes.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+#include <array>
+#include <span>
+#include <memory_resource>
+#include <limits>
+#include <bit>
+#include <cmath>
+#include <cinttypes>
+
+namespace utils {
+
+	// Uniform grid for axis aligned bounding boxes with the cells stored in a hash table.
+	// Each element is stored once, in the cell which contains the minimum corner of its box.
+	// Cells are therefore loose: a cell contains boxes that reach up to the largest element
+	// size beyond its upper bounds. The grid is built from arrays in one pass and suits many
+	// objects of similar size; for very different sizes SparseOctree is the better choice.
+	//
+	// The occupied cells are stored in an open addressing table with linear probing and
+	// their elements in one array, ordered by cell.
+	// traverse() uses the same Processor interface as SparseOctree. It descends through an
+	// implicit binary tree which halves the range of cell coordinates, so that queries
+	// only look up the cells which can overlap them.
+	template<typename T, int Dim, typename FloatT = float>
+	class SpatialHashGrid
+	{
+	public:
+		using AABB = math::AABB<Dim, FloatT>;
+		using VecT = glm::vec<Dim, FloatT, glm::defaultp>;
+
+		/// @param _cellSize Edge length of the cells, see suggestCellSize().
+		explicit SpatialHashGrid(FloatT _cellSize = 1) : m_cellSize(_cellSize) {}
+
+		/// @brief A good cell size for the given boxes: twice the average of their largest extent.
+		static FloatT suggestCellSize(std::span<const AABB> _boxes)
+		{
+			if (_boxes.empty()) return 1;
+			FloatT sum = 0;
+			for (const AABB& box : _boxes)
+			{
+				const VecT size = box.max - box.min;
+				FloatT extent = size[0];
+				for (int d = 1; d < Dim; ++d)
+					extent = std::max(extent, size[d]);
+				sum += extent;
+			}
+			const FloatT cellSize = 2 * sum / static_cast<FloatT>(_boxes.size());
+			return cellSize > 0 ? cellSize : 1;
+		}
+
+		/// @brief Change the cell size. Takes effect with the next build.
+		void setCellSize(FloatT _cellSize) { m_cellSize = _cellSize; }
+		FloatT getCellSize() const { return m_cellSize; }
+
+		/// @brief Replace the contents of the grid.
+		/// @param _boxes Bounding box of each element.
+		/// @param _elements The elements, _elements[i] belongs to _boxes[i].
+		void build(std::span<const AABB> _boxes, std::span<const T> _elements);
+
+		/// @brief Remove all elements but keep the memory.
+		void clear()
+		{
+			m_cells.clear();
+			m_boxes.clear();
+			m_elements.clear();
+			m_numCells = 0;
+		}
+
+		size_t size() const { return m_elements.size(); }
+		bool empty() const { return m_elements.empty(); }
+		size_t numCells() const { return m_numCells; }
+
+		/* Interface of the Processor, same as for SparseOctree
+			struct TreeProcessor
+			{
+				// currentBox includes the looseness of the cells
+				bool descend(const AABB& currentBox);
+				void process(const AABB& key, const T& el);
+			};
+		*/
+		template<class Processor>
+		void traverse(Processor& _proc) const;
+
+		/// @brief Call _fn(key, el) for each element whose box overlaps _box.
+		/// @details Faster than traverse() with an AABBQuery because the range of cells to look
+		///		up follows directly from the box.
+		template<typename Fn>
+		void query(const AABB& _box, Fn&& _fn) const;
+
+		/// @brief Processor which retrieves all elements which overlap with the given AABB.
+		struct AABBQuery
+		{
+			AABBQuery(const AABB& _aabb, std::pmr::memory_resource* _resource = std::pmr::get_default_resource())
+				: aabb(_aabb), hits(_resource) {}
+
+			AABB aabb;
+			std::pmr::vector<T> hits;
+
+			bool descend(const AABB& currentBox) const
+			{
+				return aabb.intersect(currentBox);
+			}
+			void process(const AABB& key, const T& el)
+			{
+				if (aabb.intersect(key)) hits.push_back(el);
+			}
+		};
+
+	private:
+		using CellCoord = std::array<int32_t, Dim>;
+		constexpr static uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+		// Ranges of at most this many cells are looked up directly.
+		constexpr static int64_t MAX_LEAF_CELLS = 8;
+
+		struct Cell
+		{
+			CellCoord coord;
+			uint32_t begin = EMPTY; ///< index of the first element; EMPTY for unused slots
+			uint32_t count = 0;
+		};
+
+		CellCoord cellOf(const VecT& _point) const
+		{
+			CellCoord coord;
+			for (int d = 0; d < Dim; ++d)
+				coord[d] = static_cast<int32_t>(std::floor(_point[d] / m_cellSize));
+			return coord;
+		}
+
+		static size_t hash(const CellCoord& _coord)
+		{
+			uint64_t h = 0;
+			for (int d = 0; d < Dim; ++d)
+				h = (h ^ static_cast<uint32_t>(_coord[d])) * 0x9E3779B97F4A7C15ull;
+			return static_cast<size_t>(h ^ (h >> 32));
+		}
+
+		// Index of the slot of the cell or of the empty slot where it would be inserted.
+		size_t findSlot(const CellCoord& _coord) const
+		{
+			const size_t mask = m_cells.size() - 1;
+			size_t slot = hash(_coord) & mask;
+			while (m_cells[slot].begin != EMPTY && m_cells[slot].coord != _coord)
+				slot = (slot + 1) & mask;
+			return slot;
+		}
+
+		// Box which contains all elements of the cells in the range.
+		AABB rangeBox(const CellCoord& _lo, const CellCoord& _hi) const
+		{
+			AABB box;
+			for (int d = 0; d < Dim; ++d)
+			{
+				box.min[d] = static_cast<FloatT>(_lo[d]) * m_cellSize;
+				box.max[d] = static_cast<FloatT>(_hi[d] + 1) * m_cellSize + m_maxSize[d];
+			}
+			return box;
+		}
+
+		FloatT m_cellSize;
+		std::vector<Cell> m_cells; ///< open addressing table, size is a power of two
+		size_t m_numCells = 0;
+		std::vector<AABB> m_boxes; ///< boxes ordered by cell
+		std::vector<T> m_elements; ///< elements in the same order as m_boxes
+		std::vector<uint32_t> m_elementSlots; ///< temporary for build
+		CellCoord m_lo; ///< smallest occupied cell coordinates
+		CellCoord m_hi; ///< largest occupied cell coordinates
+		VecT m_maxSize; ///< largest size of any box on each axis
+	};
+
+	template<typename T, int Dim, typename FloatT>
+	void SpatialHashGrid<T, Dim, FloatT>::build(std::span<const AABB> _boxes, std::span<const T> _elements)
+	{
+		ASSERT(_boxes.size() == _elements.size(), "Each element needs a bounding box.");
+
+		const size_t n = _boxes.size();
+		m_numCells = 0;
+		m_boxes.resize(n);
+		m_elements.resize(n);
+		if (!n)
+		{
+			m_cells.clear();
+			return;
+		}
+
+		// There are at most n cells, so the table never needs to grow during the build.
+		m_cells.assign(std::bit_ceil(2 * n), Cell{});
+		m_elementSlots.resize(n);
+		m_lo.fill(std::numeric_limits<int32_t>::max());
+		m_hi.fill(std::numeric_limits<int32_t>::min());
+		m_maxSize = VecT(0);
+
+		// count the elements per cell
+		for (size_t i = 0; i < n; ++i)
+		{
+			const CellCoord coord = cellOf(_boxes[i].min);
+			for (int d = 0; d < Dim; ++d)
+			{
+				m_lo[d] = std::min(m_lo[d], coord[d]);
+				m_hi[d] = std::max(m_hi[d], coord[d]);
+			}
+			m_maxSize = glm::max(m_maxSize, _boxes[i].max - _boxes[i].min);
+
+			const size_t slot = findSlot(coord);
+			Cell& cell = m_cells[slot];
+			if (cell.begin == EMPTY)
+			{
+				cell.coord = coord;
+				cell.begin = 0;
+				++m_numCells;
+			}
+			++cell.count;
+			m_elementSlots[i] = static_cast<uint32_t>(slot);
+		}
+
+		// prefix sum, after that begin is used as insertion position
+		uint32_t offset = 0;
+		for (Cell& cell : m_cells)
+		{
+			if (cell.begin == EMPTY) continue;
+			cell.begin = offset;
+			offset += cell.count;
+		}
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			Cell& cell = m_cells[m_elementSlots[i]];
+			m_boxes[cell.begin] = _boxes[i];
+			m_elements[cell.begin] = _elements[i];
+			++cell.begin;
+		}
+		for (Cell& cell : m_cells)
+			if (cell.begin != EMPTY) cell.begin -= cell.count;
+	}
+
+	template<typename T, int Dim, typename FloatT>
+	template<class Processor>
+	void SpatialHashGrid<T, Dim, FloatT>::traverse(Processor& _proc) const
+	{
+		if (m_elements.empty()) return;
+
+		// Each level halves the longest axis, so the depth is bounded by the bits of the
+		// coordinates on all axes.
+		std::array<std::pair<CellCoord, CellCoord>, 32 * Dim + 1> stack;
+		size_t stackSize = 0;
+		stack[stackSize++] = { m_lo, m_hi };
+		while (stackSize)
+		{
+			const auto [lo, hi] = stack[--stackSize];
+			if (!_proc.descend(rangeBox(lo, hi))) continue;
+
+			int64_t numCells = 1;
+			int longest = 0;
+			for (int d = 0; d < Dim; ++d)
+			{
+				numCells *= static_cast<int64_t>(hi[d]) - lo[d] + 1;
+				if (hi[d] - lo[d] > hi[longest] - lo[longest]) longest = d;
+			}
+
+			if (numCells > MAX_LEAF_CELLS)
+			{
+				const int32_t mid = lo[longest] + (hi[longest] - lo[longest]) / 2;
+				CellCoord upperLo = lo;
+				CellCoord lowerHi = hi;
+				upperLo[longest] = mid + 1;
+				lowerHi[longest] = mid;
+				stack[stackSize++] = { upperLo, hi };
+				stack[stackSize++] = { lo, lowerHi };
+				continue;
+			}
+
+			// look up each cell of the range
+			CellCoord coord = lo;
+			while (true)
+			{
+				const Cell& cell = m_cells[findSlot(coord)];
+				if (cell.begin != EMPTY && _proc.descend(rangeBox(coord, coord)))
+				{
+					for (uint32_t i = cell.begin; i < cell.begin + cell.count; ++i)
+						_proc.process(m_boxes[i], m_elements[i]);
+				}
+
+				int d = 0;
+				for (; d < Dim; ++d)
+				{
+					if (coord[d] < hi[d])
+					{
+						++coord[d];
+						break;
+					}
+					coord[d] = lo[d];
+				}
+				if (d == Dim) break;
+			}
+		}
+	}
+
+	template<typename T, int Dim, typename FloatT>
+	template<typename Fn>
+	void SpatialHashGrid<T, Dim, FloatT>::query(const AABB& _box, Fn&& _fn) const
+	{
+		if (m_elements.empty()) return;
+
+		// Boxes are stored in the cell of their min corner, so cells up to the largest size
+		// below the query can contain overlapping boxes.
+		CellCoord lo = cellOf(_box.min - m_maxSize);
+		CellCoord hi = cellOf(_box.max);
+		int64_t numCells = 1;
+		for (int d = 0; d < Dim; ++d)
+		{
+			lo[d] = std::max(lo[d], m_lo[d]);
+			hi[d] = std::min(hi[d], m_hi[d]);
+			if (lo[d] > hi[d]) return;
+			numCells *= static_cast<int64_t>(hi[d]) - lo[d] + 1;
+		}
+
+		// large queries are cheaper by iterating over all occupied cells
+		if (numCells > static_cast<int64_t>(m_numCells))
+		{
+			for (size_t i = 0; i < m_boxes.size(); ++i)
+				if (_box.intersect(m_boxes[i])) _fn(m_boxes[i], m_elements[i]);
+			return;
+		}
+
+		CellCoord coord = lo;
+		while (true)
+		{
+			const Cell& cell = m_cells[findSlot(coord)];
+			if (cell.begin != EMPTY)
+			{
+				for (uint32_t i = cell.begin; i < cell.begin + cell.count; ++i)
+					if (_box.intersect(m_boxes[i])) _fn(m_boxes[i], m_elements[i]);
+			}
+
+			int d = 0;
+			for (; d < Dim; ++d)
+			{
+				if (coord[d] < hi[d])
+				{
+					++coord[d];
+					break;
+				}
+				coord[d] = lo[d];
+			}
+			if (d == Dim) break;
+		}
+	}
+}
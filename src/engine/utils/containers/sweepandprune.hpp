@@ -0,0 +1,226 @@
+#pragma once
+
+#include "../assert.hpp"
+#include "../../math/geometrictypes.hpp"
+#include "../../math/aabbarray.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cinttypes>
+#include <bit>
+
+namespace utils {
+
+	/// Broad phase which finds all overlapping pairs of axis aligned bounding boxes.
+	/// \details The boxes are kept sorted by their minimum on one axis. Overlapping pairs
+	///		are found by sweeping along this axis and only testing boxes whose intervals on
+	///		it overlap. Between frames objects move little, so the order from the last frame
+	///		is restored with an insertion sort in close to linear time.
+	///
+	///		By default the sweep axis is the one with the largest variance of the box centers,
+	///		which avoids many false candidates in scenes where objects are clustered along
+	///		an axis, e.g. a flat disc of planets.
+	template<typename T, int Dim, typename FloatT>
+	class SweepAndPrune
+	{
+	public:
+		using AABB = math::AABB<Dim, FloatT>;
+		using Pair = std::pair<T, T>;
+		using ProxyId = uint32_t;
+
+		/// @param _sweepAxis Fixed axis to sweep along or -1 to choose the axis each frame.
+		explicit SweepAndPrune(int _sweepAxis = -1)
+			: m_fixedAxis(_sweepAxis), m_axis(_sweepAxis < 0 ? 0 : _sweepAxis)
+		{
+			ASSERT(_sweepAxis < Dim, "Invalid sweep axis.");
+		}
+
+		/// @brief Add an element.
+		/// @return Id to update or remove the element.
+		ProxyId add(const AABB& _box, const T& _el)
+		{
+			ProxyId id;
+			if (m_freeProxies.empty())
+			{
+				id = static_cast<ProxyId>(m_proxies.size());
+				m_proxies.push_back({ _box, _el, true });
+			}
+			else
+			{
+				id = m_freeProxies.back();
+				m_freeProxies.pop_back();
+				m_proxies[id] = { _box, _el, true };
+			}
+			m_sorted.push_back({ _box, id });
+			++m_numAdded;
+			return id;
+		}
+
+		/// @brief Change the bounding box of an element.
+		void update(ProxyId _id, const AABB& _box)
+		{
+			ASSERT(m_proxies[_id].alive, "Trying to update a removed element.");
+			m_proxies[_id].box = _box;
+		}
+
+		void remove(ProxyId _id)
+		{
+			ASSERT(m_proxies[_id].alive, "Trying to remove an element twice.");
+			m_proxies[_id].alive = false;
+			// Ids are reused only after the sorted list is cleaned up in the next sweep.
+			m_removedProxies.push_back(_id);
+		}
+
+		void clear()
+		{
+			m_proxies.clear();
+			m_freeProxies.clear();
+			m_removedProxies.clear();
+			m_sorted.clear();
+			m_boxes.clear();
+			m_pairs.clear();
+			m_numAdded = 0;
+		}
+
+		const AABB& getBox(ProxyId _id) const { return m_proxies[_id].box; }
+		const T& getElement(ProxyId _id) const { return m_proxies[_id].element; }
+
+		size_t size() const { return m_proxies.size() - m_freeProxies.size() - m_removedProxies.size(); }
+
+		int getSweepAxis() const { return m_axis; }
+
+		/// @brief Call _fn(a, b) once for each pair of elements with overlapping boxes.
+		/// \details The elements must not be added, updated or removed from _fn.
+		template<typename Fn>
+		void forEachPair(Fn&& _fn)
+		{
+			prepare();
+
+			// The candidates are tested in blocks with the SIMD kernel of AABBArray.
+			constexpr size_t LANES = math::AABBArray<Dim, FloatT>::LANES;
+			const size_t n = m_sorted.size();
+			const FloatT* sweepMin = m_boxes.min(m_axis);
+			for (size_t i = 0; i < n; ++i)
+			{
+				const AABB& box = m_sorted[i].box;
+				const FloatT max = box.max[m_axis];
+				for (size_t first = (i + 1) / LANES * LANES; first < n; first += LANES)
+				{
+					if (sweepMin[std::max(first, i + 1)] > max) break;
+
+					uint32_t mask = m_boxes.intersectMask(box, first);
+					if (first <= i) mask &= ~((1u << (i + 1 - first)) - 1);
+					while (mask)
+					{
+						const size_t j = first + std::countr_zero(mask);
+						mask &= mask - 1;
+						_fn(m_proxies[m_sorted[i].proxy].element, m_proxies[m_sorted[j].proxy].element);
+					}
+				}
+			}
+		}
+
+		/// @brief Find all pairs of elements with overlapping boxes.
+		/// @return Buffer which is reused by the next call.
+		const std::vector<Pair>& findPairs()
+		{
+			m_pairs.clear();
+			forEachPair([this](const T& _a, const T& _b) { m_pairs.emplace_back(_a, _b); });
+			return m_pairs;
+		}
+
+	private:
+		struct Proxy
+		{
+			AABB box;
+			T element;
+			bool alive;
+		};
+
+		// Copy of the box, so that the sweep only reads sequential memory.
+		struct Entry
+		{
+			AABB box;
+			ProxyId proxy;
+		};
+
+		void prepare()
+		{
+			if (!m_removedProxies.empty())
+			{
+				std::erase_if(m_sorted, [this](const Entry& _entry) { return !m_proxies[_entry.proxy].alive; });
+				m_freeProxies.insert(m_freeProxies.end(), m_removedProxies.begin(), m_removedProxies.end());
+				m_removedProxies.clear();
+			}
+
+			for (Entry& entry : m_sorted)
+				entry.box = m_proxies[entry.proxy].box;
+
+			bool fullSort = m_numAdded > m_sorted.size() / 4;
+			m_numAdded = 0;
+			if (m_fixedAxis < 0)
+			{
+				const int axis = chooseAxis();
+				fullSort |= axis != m_axis;
+				m_axis = axis;
+			}
+
+			const int axis = m_axis;
+			auto less = [axis](const Entry& _a, const Entry& _b) { return _a.box.min[axis] < _b.box.min[axis]; };
+			if (fullSort)
+				std::sort(m_sorted.begin(), m_sorted.end(), less);
+
+			else
+			{
+				for (size_t i = 1; i < m_sorted.size(); ++i)
+				{
+					if (!less(m_sorted[i], m_sorted[i - 1])) continue;
+					Entry entry = m_sorted[i];
+					size_t j = i;
+					for (; j > 0 && less(entry, m_sorted[j - 1]); --j)
+						m_sorted[j] = m_sorted[j - 1];
+					m_sorted[j] = entry;
+				}
+			}
+
+			m_boxes.resize(m_sorted.size());
+			for (size_t i = 0; i < m_sorted.size(); ++i)
+				m_boxes.set(i, m_sorted[i].box);
+		}
+
+		// Axis with the largest variance of the centers. Only changes if the variance
+		// is clearly larger, so that similar axes do not cause a full sort every frame.
+		int chooseAxis() const
+		{
+			if (m_sorted.empty()) return m_axis;
+
+			using VecT = typename AABB::VecT;
+			VecT sum(0);
+			VecT sumSq(0);
+			for (const Entry& entry : m_sorted)
+			{
+				const VecT center = (entry.box.min + entry.box.max) * static_cast<FloatT>(0.5);
+				sum += center;
+				sumSq += center * center;
+			}
+			const FloatT n = static_cast<FloatT>(m_sorted.size());
+			const VecT variance = sumSq / n - (sum / n) * (sum / n);
+
+			int best = 0;
+			for (int d = 1; d < Dim; ++d)
+				if (variance[d] > variance[best]) best = d;
+			return variance[best] > variance[m_axis] * static_cast<FloatT>(1.2) ? best : m_axis;
+		}
+
+		std::vector<Proxy> m_proxies;
+		std::vector<ProxyId> m_freeProxies;
+		std::vector<ProxyId> m_removedProxies;
+		std::vector<Entry> m_sorted;
+		math::AABBArray<Dim, FloatT> m_boxes; ///< boxes of m_sorted in the same order
+		std::vector<Pair> m_pairs;
+		size_t m_numAdded = 0;
+		int m_fixedAxis;
+		int m_axis;
+	};
+}
@@ -0,0 +1,96 @@
+#include "framearena.hpp"
+#include <algorithm>
+#include <new>
+
+namespace utils {
+
+	constexpr size_t CHUNK_ALIGNMENT = alignof(std::max_align_t);
+
+	static std::byte* newChunk(size_t _size)
+	{
+		return static_cast<std::byte*>(::operator new(_size, std::align_val_t(CHUNK_ALIGNMENT)));
+	}
+
+	static void deleteChunk(std::byte* _memory)
+	{
+		::operator delete(_memory, std::align_val_t(CHUNK_ALIGNMENT));
+	}
+
+	FrameArena::FrameArena(size_t _initialSize)
+	{
+		for (Buffer& buffer : m_buffers)
+			buffer.chunks.push_back({ newChunk(_initialSize), _initialSize });
+	}
+
+	FrameArena::~FrameArena()
+	{
+		for (Buffer& buffer : m_buffers)
+			for (Chunk& chunk : buffer.chunks)
+				deleteChunk(chunk.memory);
+	}
+
+	FrameArena& FrameArena::get()
+	{
+		static FrameArena arena;
+		return arena;
+	}
+
+	void FrameArena::nextFrame()
+	{
+		m_lastFrameBytes = m_buffers[m_current].usedBytes;
+		m_peakFrameBytes = std::max(m_peakFrameBytes, m_lastFrameBytes);
+
+		m_current = 1 - m_current;
+		reset(m_buffers[m_current]);
+	}
+
+	size_t FrameArena::capacity() const
+	{
+		size_t bytes = 0;
+		for (const Buffer& buffer : m_buffers)
+			for (const Chunk& chunk : buffer.chunks)
+				bytes += chunk.size;
+		return bytes;
+	}
+
+	void* FrameArena::do_allocate(size_t _bytes, size_t _alignment)
+	{
+		Buffer& buffer = m_buffers[m_current];
+		Chunk& chunk = buffer.chunks.back();
+		const uintptr_t begin = reinterpret_cast<uintptr_t>(chunk.memory);
+		const uintptr_t ptr = (begin + buffer.offset + _alignment - 1) & ~(uintptr_t(_alignment) - 1);
+		const size_t end = ptr - begin + _bytes;
+		if (end > chunk.size)
+			return allocateChunk(buffer, _bytes, _alignment);
+
+		buffer.usedBytes += end - buffer.offset;
+		buffer.offset = end;
+		return reinterpret_cast<void*>(ptr);
+	}
+
+	void* FrameArena::allocateChunk(Buffer& _buffer, size_t _bytes, size_t _alignment)
+	{
+		const size_t size = std::max(_buffer.chunks.back().size * 2, _bytes + _alignment);
+		_buffer.chunks.push_back({ newChunk(size), size });
+		_buffer.offset = 0;
+		return do_allocate(_bytes, _alignment);
+	}
+
+	void FrameArena::reset(Buffer& _buffer)
+	{
+		// Merge all chunks into one, so that the next frame of similar size only needs a single chunk.
+		if (_buffer.chunks.size() > 1)
+		{
+			size_t size = 0;
+			for (Chunk& chunk : _buffer.chunks)
+			{
+				size += chunk.size;
+				deleteChunk(chunk.memory);
+			}
+			_buffer.chunks.clear();
+			_buffer.chunks.push_back({ newChunk(size), size });
+		}
+		_buffer.offset = 0;
+		_buffer.usedBytes = 0;
+	}
+}
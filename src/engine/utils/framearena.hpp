@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+#include <cinttypes>
+
+namespace utils {
+
+	/// Linear allocator for temporaries which only live for one tick.
+	/// \details Allocation is a pointer bump and deallocation is a no-op. All memory of a
+	///		frame is released at once by nextFrame(). The arena is double-buffered: memory
+	///		allocated in one frame stays valid during the following frame, so results of an
+	///		update can still be read while drawing.
+	///		If a frame does not fit into one chunk, additional chunks are allocated and merged
+	///		into a single larger chunk when the buffer is reused. After a few frames the
+	///		arena does not allocate any memory anymore.
+	///
+	///		Use it through the std::pmr interface, e.g.
+	///			std::pmr::vector<int> temp(&FrameArena::get());
+	///		The arena is not thread-safe and meant to be used from the main thread only.
+	class FrameArena : public std::pmr::memory_resource
+	{
+	public:
+		explicit FrameArena(size_t _initialSize = 1 << 16);
+		~FrameArena() override;
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		/// The arena which is reset by the GameStateManager at the start of each tick.
+		static FrameArena& get();
+
+		/// Start a new frame. Releases everything allocated two frames ago.
+		void nextFrame();
+
+		/// Allocate uninitialized memory for _count objects of type T.
+		template<typename T>
+		T* allocate(size_t _count) { return static_cast<T*>(allocate(_count * sizeof(T), alignof(T))); }
+		using std::pmr::memory_resource::allocate;
+
+		/// Number of bytes allocated in the current frame.
+		size_t frameBytes() const { return m_buffers[m_current].usedBytes; }
+		/// Number of bytes allocated in the last completed frame.
+		size_t lastFrameBytes() const { return m_lastFrameBytes; }
+		/// Maximum number of bytes allocated in a single frame since construction.
+		size_t peakFrameBytes() const { return m_peakFrameBytes; }
+		/// Total number of bytes currently reserved from the system.
+		size_t capacity() const;
+
+	private:
+		void* do_allocate(size_t _bytes, size_t _alignment) override;
+		void do_deallocate(void*, size_t, size_t) override {}
+		bool do_is_equal(const std::pmr::memory_resource& _other) const noexcept override { return this == &_other; }
+
+		struct Chunk
+		{
+			std::byte* memory;
+			size_t size;
+		};
+
+		struct Buffer
+		{
+			std::vector<Chunk> chunks;
+			size_t offset = 0;    ///< Position in the last chunk.
+			size_t usedBytes = 0; ///< Including padding.
+		};
+
+		void* allocateChunk(Buffer& _buffer, size_t _bytes, size_t _alignment);
+		void reset(Buffer& _buffer);
+
+		Buffer m_buffers[2];
+		int m_current = 0;
+		size_t m_lastFrameBytes = 0;
+		size_t m_peakFrameBytes = 0;
+	};
+}
@@ -2,6 +2,7 @@
 
 #include <typeindex>
 #include <vector>
+#include <array>
 
 namespace utils {
 
@@ -15,6 +16,12 @@ namespace utils {
         indexVector = {getTypeIndex<Ts>()...};
     }
 
+    // Same as gatherTypeIDs, but without a heap allocation.
+    template<typename ...Ts>
+    static std::array<std::type_index, sizeof...(Ts)> getTypeIndices() {
+        return {getTypeIndex<Ts>()...};
+    }
+
     /**
      * @tparam Functor auto-deduced Type that overrides the call operator 'operator()'
      * @tparam Args auto-deduced call parameter Types
@@ -0,0 +1,11 @@
+#include "random.hpp"
+#include <random>
+
+namespace utils {
+
+	Random& Random::get()
+	{
+		static Random random((static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}());
+		return random;
+	}
+}
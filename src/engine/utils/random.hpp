@@ -0,0 +1,75 @@
+#pragma once
+
+#include <limits>
+#include <cinttypes>
+
+namespace utils {
+
+	/// Pseudo random number generator which produces the same numbers on all platforms.
+	/// \details xoshiro256** (Blackman and Vigna, "Scrambled Linear Pseudorandom Number
+	///		Generators", 2018), seeded with SplitMix64. The results of the std distributions
+	///		are implementation defined, so the helpers uniformInt() and uniformFloat() should be
+	///		used where a replay has to produce the same values.
+	///		It also satisfies UniformRandomBitGenerator for use with the std distributions.
+	class Random
+	{
+	public:
+		using result_type = uint64_t;
+
+		explicit Random(uint64_t _seed = 0) { seed(_seed); }
+
+		/// Generator shared by the engine and the game states.
+		/// Seeded from std::random_device unless it is seeded explicitly, e.g. by the
+		/// deterministic mode of the GameStateManager.
+		static Random& get();
+
+		void seed(uint64_t _seed)
+		{
+			for (uint64_t& s : m_state)
+			{
+				_seed += 0x9e3779b97f4a7c15ull;
+				uint64_t z = _seed;
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+				s = z ^ (z >> 31);
+			}
+		}
+
+		uint64_t operator()()
+		{
+			const uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+			const uint64_t t = m_state[1] << 17;
+			m_state[2] ^= m_state[0];
+			m_state[3] ^= m_state[1];
+			m_state[1] ^= m_state[2];
+			m_state[0] ^= m_state[3];
+			m_state[2] ^= t;
+			m_state[3] = rotl(m_state[3], 45);
+			return result;
+		}
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+		/// Uniform integer in [_min, _max].
+		int uniformInt(int _min, int _max)
+		{
+			// multiply-shift maps the 32 high bits to the range, the bias is negligible for small ranges
+			const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(_max) - _min) + 1;
+			return static_cast<int>(_min + static_cast<int64_t>(((*this)() >> 32) * range >> 32));
+		}
+
+		/// Uniform float in [_min, _max).
+		float uniformFloat(float _min, float _max)
+		{
+			// 24 random bits fill the mantissa
+			const float unit = static_cast<float>((*this)() >> 40) * (1.f / static_cast<float>(1u << 24));
+			return _min + (_max - _min) * unit;
+		}
+
+	private:
+		static uint64_t rotl(uint64_t _x, int _k) { return (_x << _k) | (_x >> (64 - _k)); }
+
+		uint64_t m_state[4];
+	};
+}
@@ -1,8 +1,9 @@
 #pragma once
 
-#include "containers/hashmap.hpp"
+#include "containers/concurrenthashmap.hpp"
 #include <spdlog/spdlog.h>
 #include <string>
+#include <string_view>
 #include <cinttypes>
 #include <functional>
 #include <utility>
@@ -15,6 +16,8 @@ namespace utils {
 	///		Then you can access resources TexMan::get("bla.png"). You don't need to unload
 	///		resources, but if you want to, there is a clear.
 	///		TODO: if a resource is changed during runtime it is reloaded automatically.
+	///		get() can be called from multiple threads. Each resource is loaded exactly once,
+	///		other threads requesting the same resource wait until it is loaded.
 	/// \tparam TLoader a type which must have a static load(string...), a static
 	///		unload(handle) method and an inner type definition for the handle type:
 	///		TLoader::Handle.
@@ -39,6 +42,7 @@ namespace utils {
 		static typename TLoader::Handle get(const char* _name, Args&&... _args);
 		
 		/// Call to unload all resources. Should always be done on shut-down!
+		/// Must not run concurrently to get().
 		static void clear();
 		
 		~ResourceManager();
@@ -50,12 +54,16 @@ namespace utils {
 		static ResourceManager& inst();
 		
 		/// Compute a hash for a string
+		/// \details Transparent, so that lookups with the plain resource name do not have to
+		///		construct a std::string.
 		struct FastStringHash
 		{
-			uint32_t operator () (const std::string& _string);
+			using is_transparent = void;
+			uint32_t operator () (std::string_view _string) const;
 		};
 
-		utils::HashMap<std::string, typename TLoader::Handle, FastStringHash> m_resourceMap;
+		/// Maps the resource name (without RESOURCE_PATH) to the loaded resource.
+		utils::ConcurrentHashMap<std::string, typename TLoader::Handle, FastStringHash, std::equal_to<>> m_resourceMap;
 	};
 
 #define RESOURCE_PATH "../resources/"s
@@ -87,36 +95,28 @@ namespace utils {
 	typename TLoader::Handle ResourceManager<TLoader, Register>::get(const char* _name, Args&&... _args)
 	{
 		using namespace std::string_literals;
-		std::string name(RESOURCE_PATH + _name);
-		// Search in hash map
-		auto handle = inst().m_resourceMap.find(name);
-		if(handle) {
-		//	pa::logPedantic("Reusing resource '", _name, "'.");
-			return handle.data();
-		}
-
-		// Add/Load new element
-		handle = inst().m_resourceMap.add(move(name), 
-			TLoader::load(name.c_str(), 
-				std::forward<Args>(_args)...));
-		return handle.data();
+		// Search in hash map and add/load the element if it does not exist yet.
+		return inst().m_resourceMap.getOrAdd(std::string_view(_name), [&]() {
+			const std::string path(RESOURCE_PATH + _name);
+			return TLoader::load(path.c_str(), std::forward<Args>(_args)...);
+		});
 	}
 
 	template<typename TLoader, resource_register Register>
 	void ResourceManager<TLoader, Register>::clear()
 	{
-		for(auto it : inst().m_resourceMap)
+		// The handles are released before clear() locks the shards exclusively.
+		for(const auto& it : inst().m_resourceMap)
 			TLoader::unload(it.data());
 		inst().m_resourceMap.clear();
 	}
 
 	template<typename TLoader, resource_register Register>
-	uint32_t ResourceManager<TLoader, Register>::FastStringHash::operator () (const std::string& _string)
+	uint32_t ResourceManager<TLoader, Register>::FastStringHash::operator () (std::string_view _string) const
 	{
 		uint32_t hashvalue = 208357;
 
-		const char* string = _string.c_str();
-		while(int c = *string++)
+		for(const char c : _string)
 			hashvalue = ((hashvalue << 5) + (hashvalue << 1) + hashvalue) ^ c; 
 
 		return hashvalue;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <type_traits>
+#include <cstddef>
+#include <cinttypes>
+
+namespace utils {
+
+	/// Order dependent 64 bit hash (FNV-1a) over the bytes of values.
+	/// \details Two runs of a deterministic simulation produce the same hash as long as their
+	///		states are bitwise equal, so comparing the hashes of each tick finds the first tick
+	///		in which they diverge. Only add types without padding, e.g. floats and glm vectors,
+	///		since the padding bytes are undefined.
+	class StateHash
+	{
+	public:
+		template<typename T>
+		void add(const T& _value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Only the bytes of trivially copyable types can be hashed.");
+			const auto* bytes = reinterpret_cast<const std::byte*>(&_value);
+			for (size_t i = 0; i < sizeof(T); ++i)
+			{
+				m_hash ^= static_cast<uint64_t>(bytes[i]);
+				m_hash *= PRIME;
+			}
+		}
+
+		uint64_t value() const { return m_hash; }
+
+	private:
+		constexpr static uint64_t PRIME = 0x100000001b3ull;
+		uint64_t m_hash = 0xcbf29ce484222325ull;
+	};
+}
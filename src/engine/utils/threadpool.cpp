@@ -0,0 +1,56 @@
+#include "threadpool.hpp"
+
+namespace utils {
+
+	ThreadPool::ThreadPool(uint32_t _numThreads)
+	{
+		for (uint32_t i = 1; i < _numThreads; ++i)
+			m_workers.emplace_back([this]() { workerLoop(); });
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_shutdown = true;
+		}
+		m_condition.notify_all();
+		for (std::thread& worker : m_workers)
+			worker.join();
+	}
+
+	ThreadPool& ThreadPool::get()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	bool ThreadPool::runPendingTask()
+	{
+		std::function<void()> task;
+		{
+			std::scoped_lock lock(m_mutex);
+			if (m_tasks.empty()) return false;
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+		return true;
+	}
+
+	void ThreadPool::workerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock lock(m_mutex);
+				m_condition.wait(lock, [this]() { return m_shutdown || !m_tasks.empty(); });
+				if (m_shutdown && m_tasks.empty()) return;
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <cinttypes>
+
+namespace utils {
+
+	/// Fixed number of worker threads which execute parallel loops.
+	/// \details parallelFor splits a range into as many equally sized chunks as there are
+	///		threads. The chunk boundaries only depend on the range and the number of threads,
+	///		so loops which write results per index are deterministic.
+	///		The calling thread takes part in the work, so a pool with a single thread has
+	///		no workers and executes everything inline.
+	class ThreadPool
+	{
+	public:
+		/// @param _numThreads Number of threads including the calling thread.
+		explicit ThreadPool(uint32_t _numThreads = std::max(1u, std::thread::hardware_concurrency()));
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/// Pool shared by the engine systems with one thread per core.
+		static ThreadPool& get();
+
+		uint32_t numThreads() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+		/// Call _fn(begin, end) for disjoint chunks which cover [_begin, _end) and wait until
+		/// all of them are done.
+		/// @param _minChunkSize Ranges are not split into chunks smaller than this.
+		template<typename Fn>
+		void parallelFor(size_t _begin, size_t _end, Fn&& _fn, size_t _minChunkSize = 1)
+		{
+			if (_end <= _begin) return;
+			const size_t count = _end - _begin;
+			const size_t numChunks = std::min<size_t>(numThreads(), (count + _minChunkSize - 1) / _minChunkSize);
+			if (numChunks <= 1)
+			{
+				_fn(_begin, _end);
+				return;
+			}
+
+			std::atomic<size_t> remaining = numChunks - 1;
+			auto chunkBegin = [&](size_t _chunk) { return _begin + count * _chunk / numChunks; };
+			{
+				std::scoped_lock lock(m_mutex);
+				for (size_t c = 1; c < numChunks; ++c)
+				{
+					m_tasks.emplace_back([&, c]()
+					{
+						_fn(chunkBegin(c), chunkBegin(c + 1));
+						remaining.fetch_sub(1, std::memory_order_release);
+					});
+				}
+			}
+			m_condition.notify_all();
+
+			_fn(chunkBegin(0), chunkBegin(1));
+			// Help with other tasks instead of blocking, so that nested loops cannot dead-lock.
+			while (remaining.load(std::memory_order_acquire) > 0)
+			{
+				if (!runPendingTask())
+					std::this_thread::yield();
+			}
+		}
+
+	private:
+		bool runPendingTask();
+		void workerLoop();
+
+		std::vector<std::thread> m_workers;
+		std::deque<std::function<void()>> m_tasks;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_shutdown = false;
+	};
+}
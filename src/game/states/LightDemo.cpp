@@ -1,4 +1,5 @@
 ﻿#include "LightDemo.h"
+#include <engine/utils/random.hpp>
 
 namespace gameState {
 
@@ -99,13 +100,10 @@ namespace gameState {
     }
 
     static glm::vec3 getRandomColor() {
-        std::random_device randomDevice;
-        std::mt19937 gen(randomDevice());
-        std::uniform_int_distribution<> colorDistribution(0, 255);
-
-        float red = static_cast<float>(colorDistribution(gen)) / 255.0f;
-        float green = static_cast<float>(colorDistribution(gen)) / 255.0f;
-        float blue = static_cast<float>(colorDistribution(gen)) / 255.0f;
+        utils::Random &random = utils::Random::get();
+        float red = static_cast<float>(random.uniformInt(0, 255)) / 255.0f;
+        float green = static_cast<float>(random.uniformInt(0, 255)) / 255.0f;
+        float blue = static_cast<float>(random.uniformInt(0, 255)) / 255.0f;
 
         return {red, green, blue};
     }
@@ -162,12 +160,13 @@ namespace gameState {
 
         initializeHotkeys();
         cameraControls.update(deltaMicroseconds);
+        components::ComposeTransformSystem(registry).execute();
         meshRenderer.update();
         graphics::LightManager::LightSystem(registry).execute();
     }
 
-    void LightDemo::draw(const long long &deltaMicroseconds) {
-        meshRenderer.present(program.getID());
+    void LightDemo::draw(const long long &deltaMicroseconds, float interpolation) {
+        meshRenderer.present(program.getID(), interpolation);
     }
 
     void LightDemo::onResume() {
@@ -21,7 +21,6 @@
 #include <spdlog/spdlog.h>
 #include <engine/entity/entityregistry.h>
 #include <iostream>
-#include <random>
 
 namespace gameState {
     class LightDemo : public gameState::BaseGameState {
@@ -30,7 +29,7 @@ namespace gameState {
 
         void update(const long long int &deltaMicroseconds) override;
 
-        void draw(const long long int &deltaMicroseconds) override;
+        void draw(const long long int &deltaMicroseconds, float interpolation) override;
 
         void onResume() override;
 
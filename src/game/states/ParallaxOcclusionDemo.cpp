@@ -157,12 +157,13 @@ namespace gameState {
 
         initializeHotkeys();
         cameraControls.update(deltaMicroseconds);
+        components::ComposeTransformSystem(registry).execute();
         meshRenderer.update();
         graphics::LightManager::LightSystem(registry).execute();
     }
 
-    void ParallaxOcclusionDemo::draw(const long long &deltaMicroseconds) {
-        meshRenderer.present(program.getID());
+    void ParallaxOcclusionDemo::draw(const long long &deltaMicroseconds, float interpolation) {
+        meshRenderer.present(program.getID(), interpolation);
     }
 
     void ParallaxOcclusionDemo::onResume() {
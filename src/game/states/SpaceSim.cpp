@@ -23,8 +23,20 @@ namespace gameState {
     static constexpr auto shipVelocityDampFactor = 2.0f;
 
     static constexpr auto projectileVelocity = 100.0f;
-    static constexpr auto projectileLifetime = 1.25;
-    static constexpr auto projectileLightIntensity = 3.0f;
+    static constexpr auto projectileLifetime = 1.25f;
+    static constexpr auto projectileRadius = 0.1f;
+    static constexpr auto projectileColor = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+    // 2 cannons, a shot every 0.1 seconds
+    static constexpr size_t maxProjectiles = 2 * 16;
+
+    static constexpr auto exhaustRatePerThrottle = 40.0f;
+    static constexpr auto exhaustOffset = glm::vec3(0.0f, 0.0f, -5.0f);
+    static constexpr auto exhaustSpeed = 8.0f;
+    static constexpr auto exhaustSpread = 0.5f;
+    static constexpr auto exhaustLifetime = 0.5f;
+    static constexpr auto exhaustColor = glm::vec4(1.0f, 0.5f, 0.1f, 1.0f);
+    static constexpr auto exhaustParticleSize = 0.3f;
+    static constexpr size_t maxExhaustParticles = 256;
 
     static void printControls() {
         spdlog::info("SpaceSim Controls:");
@@ -112,7 +124,9 @@ namespace gameState {
                 ),
                 components::RotationalVelocity(glm::vec3(0.0f, 0.0f, 0.0f)),
                 components::Velocity(glm::vec3(0.0f, 0.0f, 5.5f)),
-                components::OrbitalObject(10.0)
+                components::OrbitalObject(10.0),
+                components::ParticleEmitter(&exhaustPool, 0.0f, glm::vec3(0.0f, 0.0f, -1.0f), exhaustSpeed, exhaustSpread,
+                                            exhaustLifetime, exhaustColor, exhaustOffset)
         );
         meshRenderer.registerMesh(playerShipEntity);
         camera1.trackEntity(playerShipEntity);
@@ -139,7 +153,8 @@ namespace gameState {
                 components::Velocity(glm::vec3(0.0f, 0.0f, 0.0f)),
                 components::OrbitalObject(100'000'000.0),
                 components::RotationalVelocity(glm::vec3(0.0f, 0.0f, 0.0f)),
-                components::Light::point(glm::vec3(0.0f, 0.0f, 0.0f), 2000.0f, glm::vec3(1.0f, 0.0f, 0.0f), 1.0f)
+                components::Light::point(glm::vec3(0.0f, 0.0f, 0.0f), 2000.0f, glm::vec3(1.0f, 0.0f, 0.0f), 1.0f),
+                components::Sleepable() // falls asleep and stays the fixed center of the system
         );
         meshRenderer.registerMesh(planetEntity);
         solarSystemEntities.push_back(planetEntity);
@@ -279,7 +294,10 @@ namespace gameState {
               ),
               activeFollowCamera(&camera1),
               ambientLightData({1.4f, 1.4f, 1.4f}),
-              meshRenderer(graphics::MeshRenderer()) {
+              meshRenderer(graphics::MeshRenderer()),
+              particleSprite(0.5f, 0.5f, texManager::get("textures/particle.png", *linearMirrorSampler())),
+              projectilePool(maxProjectiles),
+              exhaustPool(maxExhaustParticles) {
 
         initializeHotkeys();
         initializeShaders();
@@ -337,6 +355,7 @@ namespace gameState {
             } else {
                 spdlog::info("throttle set to {}", currentPlayerThrottle);
             }
+            setExhaustRate();
         }
         if (!throttleKeyIsDown && input::InputManager::isKeyPressed(input::Key::F)) {
             currentPlayerThrottle--;
@@ -346,6 +365,7 @@ namespace gameState {
             } else {
                 spdlog::info("throttle set to {}", currentPlayerThrottle);
             }
+            setExhaustRate();
         }
         if (currentPlayerThrottle != 0) {
             shipVelocity.velocity += (shipTransform.getRotation() *
@@ -376,22 +396,37 @@ namespace gameState {
         }
     }
 
+    void SpaceSim::setExhaustRate() {
+        entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+        components::ParticleEmitter exhaust = registry.getComponentData<components::ParticleEmitter>(playerShipEntity).value();
+        exhaust.rate = exhaustRatePerThrottle * static_cast<float>(std::max(currentPlayerThrottle, 0));
+        registry.addOrSetComponent(playerShipEntity, exhaust);
+    }
+
     void SpaceSim::spawnProjectile(const components::Transform &shipTransform, const glm::vec3 &spawnOffset, const glm::vec3 &velocity) {
-        activeProjectiles.emplace_back(
-                entity::EntityRegistry::getInstance().createEntity(
-                        components::Mesh(sphereInvertedMeshData),
-                        components::Transform(shipTransform.getPosition() + (shipTransform.getRotation() * spawnOffset),
-                                              shipTransform.getRotation(),
-                                              glm::vec3(0.1f, 0.1f, 1.0f)
-                        ),
-                        components::Velocity(velocity),
-                        components::RotationalVelocity(glm::vec3(0.0f, 0.0f, glm::radians(45.0f))),
-                        components::Light::point(glm::vec3(0.0f, 0.0f, 0.0f), 50.0f, glm::vec3(1.0f, 1.0f, 0.0f), 3.0f),
-                        components::ScaleVelocity(glm::vec3(0.0f, 0.0f, 25.0f))
-                ),
-                projectileLifetime
-        );
-        meshRenderer.registerMesh(activeProjectiles.back().projectileEntity);
+        projectilePool.emit(shipTransform.getPosition() + (shipTransform.getRotation() * spawnOffset), velocity, projectileLifetime, projectileColor);
+    }
+
+    bool SpaceSim::hitsPlanet(const glm::vec3 &position, const glm::vec3 &velocity, double deltaSeconds) const {
+        entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+
+        // A projectile moves more than 3 units per tick, so testing only its end position would miss thin targets.
+        // Instead its movement during the tick is swept against each planet, relative to the planet's movement.
+        for (const entity::EntityReference *planetEntity: solarSystemEntities) {
+            const std::optional<components::Transform> planetTransform = registry.getComponentData<components::Transform>(planetEntity);
+            const std::optional<components::Velocity> planetVelocity = registry.getComponentData<components::Velocity>(planetEntity);
+            if (!planetTransform || !planetVelocity) {
+                continue;
+            }
+
+            const glm::vec3 displacement = (velocity - planetVelocity->velocity) * static_cast<float>(deltaSeconds);
+            const math::HyperSphere<3, float> projectile(position - displacement, projectileRadius);
+            const math::HyperSphere<3, float> planet(planetTransform->getPosition(), planetTransform->getScale().x);
+            if (math::sweep(projectile, displacement, planet)) {
+                return true;
+            }
+        }
+        return false;
     }
 
     void SpaceSim::update(const long long int &deltaMicroseconds) {
@@ -405,9 +440,10 @@ namespace gameState {
 
         entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
 
-        components::ApplyVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).execute();
-        components::OrbitalSystem(registry, deltaSeconds, deltaSecondsSquared).execute();
-        components::ApplyRotationalVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).execute();
+        components::SleepSystem(registry, deltaSeconds).execute();
+        components::ApplyVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).executeExcluding<components::OrbitalObject, components::Sleeping>();
+        components::OrbitalSystem(registry, deltaSeconds, deltaSecondsSquared).integrate(math::Integrator::Leapfrog);
+        components::ApplyRotationalVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).executeExcluding<components::Sleeping>();
         components::ApplyScaleVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).execute();
 
         registry.execute([&registry](const entity::EntityReference *entity, components::Light light, components::Transform transform) {
@@ -415,29 +451,32 @@ namespace gameState {
             registry.addOrSetComponent(entity, light);
         });
 
-        for (int i = static_cast<int>(activeProjectiles.size()) - 1; i >= 0; i--) {
-            ProjectileData &projectile = activeProjectiles[i];
-            projectile.remainingLifeTime -= deltaSeconds;
-            if (projectile.remainingLifeTime < 0.0) {
-                meshRenderer.removeMesh(projectile.projectileEntity);
-                graphics::LightManager::getInstance().removeLight(projectile.projectileEntity);
-                registry.eraseEntity(projectile.projectileEntity);
-                delete projectile.projectileEntity;
-                activeProjectiles.erase(activeProjectiles.begin() + i);
-            } else {
-                components::Light light = registry.getComponentData<components::Light>(projectile.projectileEntity).value();
-                light.setIntensity(projectileLightIntensity * static_cast<float>(projectile.remainingLifeTime / projectileLifetime));
-                registry.addOrSetComponent(projectile.projectileEntity, light);
+        math::ParticlePool<float> *const particlePools[] = {&projectilePool, &exhaustPool};
+        components::ParticleSystem(registry, particlePools, deltaSeconds).execute();
+        for (size_t i = 0; i < projectilePool.size(); i++) {
+            if (hitsPlanet(projectilePool.position(i), projectilePool.velocity(i), deltaSeconds)) {
+                projectilePool.kill(i);
             }
         }
+        projectilePool.compact();
 
         activeFollowCamera->update(deltaSeconds);
+        components::ComposeTransformSystem(registry).execute();
         meshRenderer.update();
         graphics::LightManager::LightSystem(registry).execute();
     }
 
-    void SpaceSim::draw(const long long int &deltaMicroseconds) {
-        meshRenderer.present(program.getID());
+    void SpaceSim::draw(const long long int &deltaMicroseconds, float interpolation) {
+        meshRenderer.present(program.getID(), interpolation);
+
+        spriteRenderer.clear();
+        spriteRenderer.draw(particleSprite, projectilePool, glm::vec2(2.0f * projectileRadius));
+        spriteRenderer.draw(particleSprite, exhaustPool, glm::vec2(exhaustParticleSize));
+        if (!spriteRenderer.isEmpty()) {
+            spriteRenderer.present(cameraInstance, true);
+            // the camera and lights are bound to the mesh program during update
+            program.use();
+        }
     }
 
     void SpaceSim::onResume() {
@@ -456,6 +495,9 @@ namespace gameState {
         spdlog::info("exiting SpaceSim");
 
         meshRenderer.clear();
+        spriteRenderer.clear();
+        projectilePool.clear();
+        exhaustPool.clear();
         entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
         graphics::LightManager &lightManager = graphics::LightManager::getInstance();
 
@@ -8,6 +8,7 @@
 #include <engine/graphics/core/sampler.hpp>
 #include <engine/graphics/renderer/mesh.hpp>
 #include <engine/graphics/renderer/meshrenderer.hpp>
+#include <engine/graphics/renderer/spriterenderer.hpp>
 #include <engine/graphics/resources.hpp>
 #include <engine/input/inputmanager.hpp>
 #include <engine/gamestate/gamestatemanager.h>
@@ -18,7 +19,11 @@
 #include <engine/components/OrbitalObject.h>
 #include <engine/components/RotationalVelocity.h>
 #include <engine/components/ScaleVelocity.h>
+#include <engine/components/sleep.h>
+#include <engine/components/ParticleEmitter.h>
 #include <engine/graphics/LightManager.h>
+#include <engine/math/intersection.hpp>
+#include <engine/math/particlepool.hpp>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <spdlog/spdlog.h>
@@ -28,21 +33,12 @@
 namespace gameState {
     class SpaceSim : public gameState::BaseGameState {
 
-    private:
-        struct ProjectileData {
-            ProjectileData(entity::EntityReference *projectileEntity, double remainingLifeTime)
-                    : projectileEntity(projectileEntity), remainingLifeTime(remainingLifeTime) {}
-
-            entity::EntityReference *projectileEntity;
-            double remainingLifeTime;
-        };
-
     public:
         SpaceSim();
 
         void update(const long long int &deltaMicroseconds) override;
 
-        void draw(const long long int &deltaMicroseconds) override;
+        void draw(const long long int &deltaMicroseconds, float interpolation) override;
 
         void onResume() override;
 
@@ -51,10 +47,14 @@ namespace gameState {
     private:
         glm::vec3 ambientLightData;
         graphics::MeshRenderer meshRenderer;
+        graphics::SpriteRenderer spriteRenderer;
+        graphics::Sprite particleSprite;
+
+        math::ParticlePool<float> projectilePool;
+        math::ParticlePool<float> exhaustPool;
 
         std::vector<entity::EntityReference *> solarSystemEntities = {};
         entity::EntityReference *playerShipEntity = nullptr;
-        std::vector<ProjectileData> activeProjectiles = {};
         entity::EntityReference *skyboxEntity = nullptr;
 
         graphics::Program program = graphics::Program();
@@ -99,8 +99,12 @@ namespace gameState {
 
         void handleFlightControls(double deltaSeconds, double deltaSecondsSquared);
 
+        void setExhaustRate();
+
         void spawnProjectile(const components::Transform &shipTransform, const glm::vec3 &spawnOffset, const glm::vec3 &velocity);
 
+        bool hitsPlanet(const glm::vec3 &position, const glm::vec3 &velocity, double deltaSeconds) const;
+
         void onExit();
 
     };
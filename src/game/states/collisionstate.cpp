@@ -1,49 +1,37 @@
 #include "collisionstate.h"
+#include <engine/utils/framearena.hpp>
+#include <engine/utils/random.hpp>
+#include <engine/math/narrowphase.hpp>
+#include <engine/math/intersection.hpp>
+#include <memory_resource>
+#include <unordered_map>
 
 namespace gameState {
 
-    struct CollisionState_TreeProcessor {
-        CollisionState_TreeProcessor(const math::AABB<3, float> &bullet,
-                                     std::vector<entity::EntityReference *> &_planetVec,
-                                     graphics::MeshRenderer &_meshRenderer)
-                : m_bullet(bullet), planetVec(_planetVec), meshRenderer(_meshRenderer) {}
-
-        const math::AABB<3, float> &m_bullet;
-
-        std::vector<entity::EntityReference *> &planetVec;
-        graphics::MeshRenderer &meshRenderer;
-
-        bool descend(const math::AABB<3, float> &aabb) {
-            return aabb.intersect(m_bullet);
-        }
-
-        void process(const math::AABB<3, float> &aabb, const entity::EntityReference *planet) {
-            if (aabb.intersect(m_bullet)) {
-                meshRenderer.removeMesh(planet);
-                const int planetID = planet->getReferenceID();
-                for (unsigned int i = planetVec.size() - 1; i >= 0; i--) {
-                    entity::EntityReference *storedPlanet = planetVec[i];
-                    if (storedPlanet->getReferenceID() == planetID) {
-                        entity::EntityRegistry::getInstance().eraseEntity(storedPlanet);
-                        planetVec.erase(planetVec.begin() + i);
-                        delete storedPlanet;
-                        break;
-                    }
-                }
-            }
-        }
-    };
-
     static constexpr auto defaultPlanetScale = glm::vec3(1.0f, 1.0f, 1.0f);
     static constexpr auto defaultBulletScale = glm::vec3(0.1f, 0.1f, 0.1f);
     static constexpr float defaultBulletVelocity = 10.0f;
+    static constexpr float hitScanRange = 100.0f;
     static constexpr float boxSize = 20.0f;
+    static constexpr float planetMass = 1.0f;
+    static constexpr float planetFriction = 0.2f;
+    // planets bounce off each other and the walls without losing speed
+    static constexpr float planetRestitution = 1.0f;
+    // planets may leave their octree node by half its size before they are moved to another node
+    static constexpr float collisionTreeLooseness = 0.5f;
+
+    // planets and bullets are scaled unit spheres
+    static math::HyperSphere<3, float> getSphere(const entity::EntityReference *entity) {
+        const components::Transform transform = entity::EntityRegistry::getInstance().getComponentData<components::Transform>(entity).value();
+        return {transform.getPosition(), transform.getScale().x};
+    }
 
     static void printControls() {
         spdlog::info("Spring Demo Controls:");
         spdlog::info("- WASD + EQ = Camera Movement");
         spdlog::info("- Mouse = Camera Yaw/Pitch");
         spdlog::info("- LeftClick to spawn a projectile in view direction");
+        spdlog::info("- RightClick to destroy the planet in view direction");
         spdlog::info("- press [1] to exit this state");
     }
 
@@ -105,7 +93,7 @@ namespace gameState {
             cameraControls(graphics::Camera(90.0f, 0.1f, 300.0f), glm::vec3(0.0f, 0.0f, -7.0f), 0.0f, 0.0f, 0.0f),
             ambientLightData({1.4f, 1.4f, 1.4f}),
             meshRenderer(graphics::MeshRenderer()),
-            collisionTree(1.0f) {
+            collisionTree(1.0f, collisionTreeLooseness) {
 
         initializeHotkeys();
         cameraControls.initializeCursorPosition();
@@ -128,18 +116,13 @@ namespace gameState {
         if (nextPlanetSpawnSeconds <= 0) {
             nextPlanetSpawnSeconds = 1.0;
 
-            std::random_device randomDevice;
-            std::mt19937 gen(randomDevice());
-            std::uniform_int_distribution<> positionDistribution(0, 9);
-            std::uniform_int_distribution<> directionDistribution(0, 8);
-            std::uniform_real_distribution<> angularVelocityDistribution(-1, 1);
-
-            glm::vec3 position = glm::vec3(positionDistribution(gen), positionDistribution(gen), positionDistribution(gen));
-            glm::vec3 direction = glm::vec3(directionDistribution(gen) - 4, directionDistribution(gen) - 4, directionDistribution(gen) - 4);
+            utils::Random &random = utils::Random::get();
+            glm::vec3 position = glm::vec3(random.uniformInt(0, 9), random.uniformInt(0, 9), random.uniformInt(0, 9));
+            glm::vec3 direction = glm::vec3(random.uniformInt(-4, 4), random.uniformInt(-4, 4), random.uniformInt(-4, 4));
             glm::vec3 angularVelocity = glm::vec3(
-                    static_cast<float>(angularVelocityDistribution(gen)),
-                    static_cast<float>(angularVelocityDistribution(gen)),
-                    static_cast<float>(angularVelocityDistribution(gen))
+                    random.uniformFloat(-1.0f, 1.0f),
+                    random.uniformFloat(-1.0f, 1.0f),
+                    random.uniformFloat(-1.0f, 1.0f)
             );
             entity::EntityReference *planetEntity = entity::EntityRegistry::getInstance().createEntity(
                     components::Transform(position,
@@ -152,10 +135,79 @@ namespace gameState {
                     ),
                     components::Velocity(direction),
                     components::RotationalVelocity(angularVelocity),
-                    components::AABBCollider()
+                    components::AABBCollider(),
+                    components::Sleepable(),
+                    components::RigidBody::sphere(planetMass, defaultPlanetScale.x, planetFriction, planetRestitution)
             );
             meshRenderer.registerMesh(planetEntity);
             planetVec.push_back(planetEntity);
+
+            entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+            const math::AABB<3, float> planetBox = registry.getComponentData<components::AABBCollider>(planetEntity).value().getAABB(
+                    registry.getComponentData<components::Transform>(planetEntity).value());
+            collisionTree.insert(planetBox, planetEntity);
+            planetBoxes.push_back(planetBox);
+            planetProxies.push_back(planetBroadPhase.add(planetBox, planetEntity));
+        }
+    }
+
+    void CollisionState::updateCollisionTree() {
+        entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+        utils::FrameArena &arena = utils::FrameArena::get();
+        std::pmr::unordered_map<const entity::EntityReference *, size_t> planetIndices(&arena);
+        for (size_t i = 0; i < planetVec.size(); i++) {
+            planetIndices.emplace(planetVec[i], i);
+        }
+
+        // sleeping planets do not move, their boxes are still up to date
+        std::pmr::vector<components::AABBColliderSystem::ColliderBox> colliderBoxes(&arena);
+        components::AABBColliderSystem(registry, colliderBoxes).executeExcluding<components::Sleeping>();
+        for (const auto &[entity, planetBox]: colliderBoxes) {
+            // the bullets have colliders as well
+            const auto it = planetIndices.find(entity);
+            if (it == planetIndices.end()) {
+                continue;
+            }
+            const size_t i = it->second;
+            if (planetBox != planetBoxes[i]) {
+                collisionTree.update(planetBoxes[i], planetBox, planetVec[i]);
+                planetBroadPhase.update(planetProxies[i], planetBox);
+                planetBoxes[i] = planetBox;
+            }
+        }
+    }
+
+    void CollisionState::destroyPlanet(const entity::EntityReference *planet) {
+        // a planet can be hit by multiple bullets in the same tick
+        const auto it = std::find(planetVec.begin(), planetVec.end(), planet);
+        if (it == planetVec.end()) {
+            return;
+        }
+
+        const auto index = it - planetVec.begin();
+        collisionTree.remove(planetBoxes[index], planet);
+        planetBroadPhase.remove(planetProxies[index]);
+        meshRenderer.removeMesh(planet);
+        entity::EntityRegistry::getInstance().eraseEntity(*it);
+        delete *it;
+        planetVec.erase(it);
+        planetBoxes.erase(planetBoxes.begin() + index);
+        planetProxies.erase(planetProxies.begin() + index);
+    }
+
+    void CollisionState::addWallContacts(const entity::EntityReference *planet, std::pmr::vector<components::EntityContact> &contacts) {
+        const math::HyperSphere<3, float> sphere = getSphere(planet);
+        for (int axis = 0; axis < 3; axis++) {
+            for (const float side: {-1.0f, 1.0f}) {
+                const float depth = sphere.center[axis] * side + sphere.radius - boxSize;
+                if (depth > 0.0f) {
+                    // the walls are the static world, the normal points from the planet into the wall
+                    glm::vec3 normal(0.0f);
+                    normal[axis] = side;
+                    const glm::vec3 point = sphere.center + normal * (sphere.radius - depth * 0.5f);
+                    contacts.push_back({planet, nullptr, {point, normal, depth}});
+                }
+            }
         }
     }
 
@@ -170,11 +222,15 @@ namespace gameState {
 
         entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
 
-        components::ApplyVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).execute();
-        components::ApplyRotationalVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).execute();
+        components::SleepSystem(registry, deltaSeconds).execute();
+        components::ApplyVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).executeExcluding<components::Sleeping>();
+        components::ApplyRotationalVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).executeExcluding<components::Sleeping>();
+        // all movement of this tick is done, the collider bounds and the renderer use the matrices
+        components::ComposeTransformSystem(registry).execute();
 
         if (!planetVec.empty()) {
-            registry.execute([deltaSeconds, &registry]
+            // bullets are reflected at the walls, planets collide with them
+            registry.executeExcluding<components::Sleeping, components::RigidBody>([deltaSeconds, &registry]
                                      (const entity::EntityReference *entity, components::Transform transform, components::Velocity velocity) {
                 glm::vec3 pos = transform.getPosition();
                 if (pos.x < -boxSize || pos.x > boxSize) velocity.velocity.x = -velocity.velocity.x;
@@ -183,20 +239,61 @@ namespace gameState {
                 registry.addOrSetComponent(entity, velocity);
             });
 
-            for (const entity::EntityReference *planetEntity: planetVec) {
-                components::AABBCollider planetCollider = registry.getComponentData<components::AABBCollider>(planetEntity).value();
-                components::Transform planetTransform = registry.getComponentData<components::Transform>(planetEntity).value();
-                collisionTree.insert(planetCollider.getAABB(planetTransform), planetEntity);
+            updateCollisionTree();
+            std::pmr::vector<components::EntityContact> contacts(&utils::FrameArena::get());
+            // the broad phase only finds overlapping boxes, the spheres decide about the collision
+            for (const auto &[planetA, planetB]: planetBroadPhase.findPairs()) {
+                // two sleeping planets stay in contact without moving
+                if (components::SleepSystem::isSleeping(registry, planetA) && components::SleepSystem::isSleeping(registry, planetB)) {
+                    continue;
+                }
+                if (const auto contact = math::collide(getSphere(planetA), getSphere(planetB))) {
+                    components::SleepSystem::wake(registry, planetA);
+                    components::SleepSystem::wake(registry, planetB);
+                    contacts.push_back({planetA, planetB, *contact});
+                }
             }
+            for (const entity::EntityReference *planet: planetVec) {
+                if (!components::SleepSystem::isSleeping(registry, planet)) {
+                    addWallContacts(planet, contacts);
+                }
+            }
+            components::RigidBodySystem(registry, contactSolver, deltaSeconds).solve(contacts);
 
+            // Bullets move far compared to their size, so instead of their end position the volume
+            // swept during the tick is tested. The planets are treated as static during the tick.
+            // They are destroyed after the traversals, since the tree must not change during them.
+            std::pmr::vector<const entity::EntityReference *> hitPlanets(&utils::FrameArena::get());
             for (const entity::EntityReference *bulletEntity: bulletVec) {
                 components::AABBCollider bulletCollider = registry.getComponentData<components::AABBCollider>(bulletEntity).value();
                 components::Transform bulletTransform = registry.getComponentData<components::Transform>(bulletEntity).value();
-                CollisionState_TreeProcessor treeProc(bulletCollider.getAABB(bulletTransform), planetVec, meshRenderer);
-                collisionTree.traverse(treeProc);
+                const glm::vec3 displacement = registry.getComponentData<components::Velocity>(bulletEntity).value().velocity
+                                               * static_cast<float>(deltaSeconds);
+                const math::AABB<3, float> endBox = bulletCollider.getAABB(bulletTransform);
+                const math::AABB<3, float> startBox(endBox.min - displacement, endBox.max - displacement);
+                const math::HyperSphere<3, float> startSphere(bulletTransform.getPosition() - displacement, bulletTransform.getScale().x);
+
+                decltype(collisionTree)::SweepQuery query(startBox, displacement, &utils::FrameArena::get());
+                collisionTree.traverse(query);
+
+                // the sphere which is hit first
+                std::optional<float> firstImpact;
+                const entity::EntityReference *firstPlanet = nullptr;
+                for (const auto &hit: query.hits) {
+                    const std::optional<float> impact = math::sweep(startSphere, displacement, getSphere(hit.element));
+                    if (impact && (!firstImpact || *impact < *firstImpact)) {
+                        firstImpact = impact;
+                        firstPlanet = hit.element;
+                    }
+                }
+                if (firstPlanet) {
+                    hitPlanets.push_back(firstPlanet);
+                }
             }
 
-            collisionTree.clear();
+            for (const entity::EntityReference *planet: hitPlanets) {
+                destroyPlanet(planet);
+            }
         }
 
         createPlanets(deltaSeconds);
@@ -208,14 +305,21 @@ namespace gameState {
         } else if (input::InputManager::isButtonPressed(input::MouseButton::LEFT)) {
             bulletCoolDownSeconds = 1.0;
             createBullet();
+        } else if (input::InputManager::isButtonPressed(input::MouseButton::RIGHT)) {
+            bulletCoolDownSeconds = 1.0;
+            // hit-scan: the ray is tested against the planet boxes in the tree
+            const math::Ray<3, float> ray(cameraControls.camera.getPosition(), cameraControls.camera.forwardVector());
+            if (const auto hit = collisionTree.rayCast(ray, hitScanRange)) {
+                destroyPlanet(hit->element);
+            }
         }
 
         meshRenderer.update();
         graphics::LightManager::LightSystem(registry).execute();
     }
 
-    void CollisionState::draw(const long long &deltaMicroseconds) {
-        meshRenderer.present(program.getID());
+    void CollisionState::draw(const long long &deltaMicroseconds, float interpolation) {
+        meshRenderer.present(program.getID(), interpolation);
     }
 
     void CollisionState::onResume() {
@@ -247,6 +351,10 @@ namespace gameState {
             delete entity;
         }
         planetVec.clear();
+        planetBoxes.clear();
+        planetProxies.clear();
+        collisionTree.clear();
+        planetBroadPhase.clear();
 
         graphics::LightManager::getInstance().removeLight(lightSource);
         entity::EntityRegistry::getInstance().eraseEntity(lightSource);
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <time.h>
 #include <engine/utils/containers/octree.hpp>
+#include <engine/utils/containers/sweepandprune.hpp>
 #include <thread>
 #include<engine/entity/componentregistry.h>
 #include <iostream>
@@ -26,6 +27,9 @@
 #include <engine/components/AABBCollider.h>
 #include <engine/components/velocity.h>
 #include <engine/components/RotationalVelocity.h>
+#include <engine/components/sleep.h>
+#include <engine/components/RigidBody.h>
+#include <engine/math/contactsolver.hpp>
 #include <engine/entity/entityregistry.h>
 
 namespace gameState {
@@ -36,7 +40,7 @@ namespace gameState {
 
         void update(const long long int &deltaMicroseconds) override;
 
-        void draw(const long long int &deltaMicroseconds) override;
+        void draw(const long long int &deltaMicroseconds, float interpolation) override;
 
         void onResume() override;
 
@@ -50,9 +54,15 @@ namespace gameState {
 
         entity::EntityReference *lightSource = nullptr;
         std::vector<entity::EntityReference *> planetVec;
+        std::vector<math::AABB<3, float>> planetBoxes; // box of each planet in collisionTree, same order as planetVec
         std::vector<entity::EntityReference *> bulletVec;
 
         utils::SparseOctree<const entity::EntityReference *, 3, float> collisionTree;
+        // planet vs planet collisions
+        utils::SweepAndPrune<const entity::EntityReference *, 3, float> planetBroadPhase;
+        std::vector<uint32_t> planetProxies; // proxy of each planet in planetBroadPhase, same order as planetVec
+        // keeps the contact impulses between ticks
+        math::ContactSolver<float> contactSolver;
 
         double nextPlanetSpawnSeconds = 0.0;
         double bulletCoolDownSeconds = 0.0;
@@ -74,6 +84,12 @@ namespace gameState {
 
         void createPlanets(const double &deltaSeconds);
 
+        void updateCollisionTree();
+
+        void destroyPlanet(const entity::EntityReference *planet);
+
+        void addWallContacts(const entity::EntityReference *planet, std::pmr::vector<components::EntityContact> &contacts);
+
         void bindLighting();
 
         void onExit();
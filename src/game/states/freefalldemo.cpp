@@ -1,4 +1,5 @@
 ﻿#include "freefalldemo.h"
+#include <engine/utils/random.hpp>
 
 namespace gameState {
     static constexpr auto defaultPlanetVelocity = glm::vec3(0.0f, 0.0f, 0.0f);
@@ -68,13 +69,9 @@ namespace gameState {
             nextPlanetSpawnSeconds = 0.25;
 
 
-            std::random_device randomDevice;
-            std::mt19937 gen(randomDevice());
-            std::uniform_real_distribution<> positionDistribution(-4, 4);
-            std::uniform_real_distribution<> scaleDistribution(0.1, 1.5);
-
-            glm::vec3 position = glm::vec3(positionDistribution(gen), 15, positionDistribution(gen));
-            glm::vec3 scale = glm::vec3(1.0f, 1.0f, 1.0f) * static_cast<float>(scaleDistribution(gen));
+            utils::Random &random = utils::Random::get();
+            glm::vec3 position = glm::vec3(random.uniformFloat(-4.0f, 4.0f), 15, random.uniformFloat(-4.0f, 4.0f));
+            glm::vec3 scale = glm::vec3(1.0f, 1.0f, 1.0f) * random.uniformFloat(0.1f, 1.5f);
 
             entity::EntityReference *planetEntity = entity::EntityRegistry::getInstance().createEntity(
                     components::Transform(position,
@@ -136,13 +133,14 @@ namespace gameState {
 
         createObjects(deltaSeconds);
 
+        components::ComposeTransformSystem(registry).execute();
         meshRenderer.update();
         graphics::LightManager::LightSystem(registry).execute();
     }
 
 
-    void FreeFallDemoState::draw(const long long &deltaMicroseconds) {
-        meshRenderer.present(program.getID());
+    void FreeFallDemoState::draw(const long long &deltaMicroseconds, float interpolation) {
+        meshRenderer.present(program.getID(), interpolation);
     }
 
     void FreeFallDemoState::onResume() {
@@ -35,7 +35,7 @@ namespace gameState {
 
         void update(const long long int &deltaMicroseconds) override;
 
-        void draw(const long long int &deltaMicroseconds) override;
+        void draw(const long long int &deltaMicroseconds, float interpolation) override;
 
         void onResume() override;
 
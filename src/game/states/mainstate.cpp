@@ -90,7 +90,7 @@ namespace gameState {
         initializeControls();
     }
 
-    void MainGameState::draw(const long long int &deltaMicroseconds) {}
+    void MainGameState::draw(const long long int &deltaMicroseconds, float interpolation) {}
 
     void MainGameState::onResume() {
         printInfo();
@@ -196,8 +196,8 @@ namespace gameState {
 
         double deltaSeconds = (double) deltaMicroseconds / 1'000'000.0;
         double deltaSecondsSquared = deltaSeconds * deltaSeconds;
-        components::ApplyVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).execute();
-        components::OrbitalSystem(registry, deltaSeconds, deltaSecondsSquared).execute();
+        components::ApplyVelocitySystem(registry, deltaSeconds, deltaSecondsSquared).executeExcluding<components::OrbitalObject>();
+        components::OrbitalSystem(registry, deltaSeconds, deltaSecondsSquared).integrate(math::Integrator::Leapfrog);
 
         components::Transform sunPosition = registry.getComponentData<components::Transform>(sunEntity).value();
         lightComponent.setPosition(sunPosition.getPosition());
@@ -206,12 +206,13 @@ namespace gameState {
         lightTransform.setPosition(sunPosition.getPosition());
         registry.addOrSetComponent(lightSource, lightTransform);
 
+        components::ComposeTransformSystem(registry).execute();
         meshRenderer.update();
         graphics::LightManager::LightSystem(registry).execute();
     }
 
-    void OrbitDemoState::draw(const long long &deltaMicroseconds) {
-        meshRenderer.present(program.getID());
+    void OrbitDemoState::draw(const long long &deltaMicroseconds, float interpolation) {
+        meshRenderer.present(program.getID(), interpolation);
     }
 
     void OrbitDemoState::onResume() {
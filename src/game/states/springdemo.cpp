@@ -2,6 +2,8 @@
 
 namespace gameState {
     static constexpr auto defaultPlanetPosition = glm::vec3(-2.0f, 0.0f, 0.0f);
+    static constexpr float springConstant = 10.0f;
+    static constexpr float sphereMass = 50.0f;
 
     static constexpr auto defaultLightPosition = glm::vec3(0.0f, 0.0f, -3.0f);
     static constexpr auto defaultLightDirection = glm::vec3(0.0f, 0.0f, 1.0f);
@@ -95,7 +97,11 @@ namespace gameState {
         planetTransform.setPosition(defaultPlanetPosition);
         registry.addOrSetComponent(planetEntity, planetTransform);
 
-        planetVelocity = 0.0f;
+        springNetwork.clear();
+        const uint32_t anchorParticle = springNetwork.addParticle(glm::vec3(0.0f, 0.0f, 0.0f), 0.0f);
+        const uint32_t planetParticle = springNetwork.addParticle(defaultPlanetPosition, sphereMass);
+        springNetwork.addSpring(anchorParticle, planetParticle, springConstant, 0.0f);
+        registry.addOrSetComponent(planetEntity, components::SpringParticle(&springNetwork, planetParticle));
     }
 
     void SpringDemoState::bindLighting() {
@@ -172,31 +178,17 @@ namespace gameState {
         }
         registry.addOrSetComponent(lightSource, lightComponent);
 
-        // Note: this calculation still isn't exactly correct, as the acceleration would change continuously
-        //  whereas this approach assumes constant acceleration during every update step
-        components::Transform planetTransform = registry.getComponentData<components::Transform>(planetEntity).value();
-        glm::vec3 planetPosition = planetTransform.getPosition();
-        static constexpr float springConstant = 10.0f;
-        static constexpr float sphereMass = 50.0f;
-        double deltaSeconds = (double) deltaMicroseconds / 1'000'000.0;
-        double deltaSecondsSquared = deltaSeconds * deltaSeconds;
-        float xDisplacement = planetPosition.x;
-        double displacementForce = 0.0 - (springConstant * xDisplacement);
-        double displacementAcceleration = displacementForce / sphereMass; // is in `units / pow(seconds, 2)`
-        double displacementVelocity = displacementAcceleration * deltaSeconds;
-        double accelerationDistance = displacementAcceleration * deltaSecondsSquared / 2; // extra distance travelled due to gained velocity by accelerating
-        double totalTravelDistance = (planetVelocity * deltaSeconds) + accelerationDistance;
-        planetPosition += glm::vec3(1.0f, 0.0f, 0.0f) * (float) totalTravelDistance;
-        planetVelocity += (float) displacementVelocity;
-        planetTransform.setPosition(planetPosition);
-        registry.addOrSetComponent(planetEntity, planetTransform);
+        const double deltaSeconds = (double) deltaMicroseconds / 1'000'000.0;
+        math::SpringNetwork<float> *springNetworks[] = {&springNetwork};
+        components::SpringNetworkSystem(registry, springNetworks, deltaSeconds).execute();
 
+        components::ComposeTransformSystem(registry).execute();
         meshRenderer.update();
         graphics::LightManager::LightSystem(registry).execute();
     }
 
-    void SpringDemoState::draw(const long long &deltaMicroseconds) {
-        meshRenderer.present(program.getID());
+    void SpringDemoState::draw(const long long &deltaMicroseconds, float interpolation) {
+        meshRenderer.present(program.getID(), interpolation);
     }
 
     void SpringDemoState::onResume() {
@@ -12,6 +12,8 @@
 #include <engine/gamestate/gamestatemanager.h>
 #include <game/camera/defaultcameracontrols.h>
 #include "mainstate.h"
+#include <engine/components/SpringParticle.h>
+#include <engine/math/springnetwork.hpp>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <spdlog/spdlog.h>
@@ -24,7 +26,7 @@ namespace gameState {
 
         void update(const long long int &deltaMicroseconds) override;
 
-        void draw(const long long int &deltaMicroseconds) override;
+        void draw(const long long int &deltaMicroseconds, float interpolation) override;
 
         void onResume() override;
 
@@ -47,7 +49,8 @@ namespace gameState {
         bool hotkey_mainState_isDown = false;
         bool hotkey_exit_isDown = false;
 
-        float planetVelocity = 0.0f;
+        // the planet hangs on a spring from a fixed anchor at the origin
+        math::SpringNetwork<float> springNetwork;
 
         void initializeHotkeys();
 
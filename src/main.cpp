@@ -10,6 +10,7 @@
 #include "game/states/mainstate.h"
 
 #include <thread>
+#include <string>
 
 // CRT's memory leak detection
 #ifndef NDEBUG
@@ -41,6 +42,10 @@ int main(int argc, char *argv[]) {
     graphics::glCall(glClearColor, 0.05f, 0.0f, 0.05f, 1.f);
 
     gameState::GameStateManager &stateManager = gameState::GameStateManager::getInstance();
+    // --seed <n> runs the simulation in the deterministic lockstep mode
+    if (argc >= 3 && std::string(argv[1]) == "--seed") {
+        stateManager.setDeterministic(std::stoull(argv[2]));
+    }
     stateManager.startGameState(new gameState::MainGameState());
 
     while (!glfwWindowShouldClose(window) && !input::InputManager::isKeyPressed(input::Key::ESCAPE)) {
@@ -0,0 +1,191 @@
+#include <engine/utils/containers/octree.hpp>
+#include <engine/utils/containers/linearbvh.hpp>
+#include <engine/utils/containers/spatialhashgrid.hpp>
+#include <engine/utils/containers/sweepandprune.hpp>
+
+#include <spdlog/fmt/fmt.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+
+namespace chrono = std::chrono;
+
+using AABB = math::AABB<3, float>;
+
+// Objects of similar size move inside a box with constant density and bounce off its walls.
+struct World
+{
+	World(int _numObjects)
+		: size(std::cbrt(static_cast<float>(_numObjects)) * 3.f)
+	{
+		std::default_random_engine rng(2468u);
+		std::uniform_real_distribution<float> position(-size, size);
+		std::uniform_real_distribution<float> velocity(-1.f, 1.f);
+		std::uniform_real_distribution<float> radius(0.5f, 1.f);
+		for (int i = 0; i < _numObjects; ++i)
+		{
+			positions.emplace_back(position(rng), position(rng), position(rng));
+			velocities.emplace_back(velocity(rng), velocity(rng), velocity(rng));
+			radii.push_back(radius(rng));
+			elements.push_back(i);
+		}
+		boxes.resize(_numObjects);
+		updateBoxes();
+	}
+
+	void move(float _deltaTime)
+	{
+		for (size_t i = 0; i < positions.size(); ++i)
+		{
+			positions[i] += velocities[i] * _deltaTime;
+			for (int d = 0; d < 3; ++d)
+				if (positions[i][d] < -size || positions[i][d] > size) velocities[i][d] = -velocities[i][d];
+		}
+		updateBoxes();
+	}
+
+	void updateBoxes()
+	{
+		for (size_t i = 0; i < positions.size(); ++i)
+			boxes[i] = AABB(positions[i] - glm::vec3(radii[i]), positions[i] + glm::vec3(radii[i]));
+	}
+
+	float size;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> velocities;
+	std::vector<float> radii;
+	std::vector<AABB> boxes;
+	std::vector<int> elements;
+};
+
+struct Result
+{
+	float update = 0.f;
+	float pairs = 0.f;
+	size_t numPairs = 0;
+};
+
+// Find all pairs by querying the box of each object. Only pairs (i, j) with i < j are counted.
+template<typename Tree>
+size_t queryPairs(const Tree& _tree, const World& _world)
+{
+	size_t numPairs = 0;
+	for (int i = 0; i < static_cast<int>(_world.boxes.size()); ++i)
+	{
+		typename Tree::AABBQuery query(_world.boxes[i]);
+		_tree.traverse(query);
+		for (int el : query.hits)
+			numPairs += el > i;
+	}
+	return numPairs;
+}
+
+template<typename UpdateFn, typename PairsFn>
+Result run(int _numObjects, int _numTicks, UpdateFn&& _update, PairsFn&& _pairs)
+{
+	World world(_numObjects);
+	Result result;
+	for (int tick = 0; tick < _numTicks; ++tick)
+	{
+		world.move(1.f / 30.f);
+		auto start = chrono::high_resolution_clock::now();
+		_update(world);
+		auto end = chrono::high_resolution_clock::now();
+		result.update += chrono::duration<float, std::milli>(end - start).count();
+
+		start = chrono::high_resolution_clock::now();
+		result.numPairs += _pairs(world);
+		end = chrono::high_resolution_clock::now();
+		result.pairs += chrono::duration<float, std::milli>(end - start).count();
+	}
+	result.update /= _numTicks;
+	result.pairs /= _numTicks;
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	int numTicks = 20;
+	if (argc >= 2)
+		numTicks = std::stoi(argv[1]);
+
+	fmt::print("ticks: {}; times in ms per tick\n", numTicks);
+	fmt::print("{:<8} {:<12} {:<10} {:<10} {:<10}\n", "objects", "variant", "update", "pairs", "num pairs");
+	for (int numObjects : { 1000, 10000, 50000 })
+	{
+		std::vector<std::pair<std::string, Result>> results;
+
+		{
+			utils::SpatialHashGrid<int, 3, float> grid;
+			results.emplace_back("grid", run(numObjects, numTicks,
+				[&](const World& _world)
+				{
+					if (grid.empty()) grid.setCellSize(decltype(grid)::suggestCellSize(_world.boxes));
+					grid.build(_world.boxes, _world.elements);
+				},
+				[&](const World& _world)
+				{
+					size_t numPairs = 0;
+					for (int i = 0; i < static_cast<int>(_world.boxes.size()); ++i)
+						grid.query(_world.boxes[i], [&](const AABB&, int _el) { numPairs += _el > i; });
+					return numPairs;
+				}));
+		}
+		{
+			utils::SparseOctree<int, 3, float> tree(1.f, 0.5f);
+			std::vector<AABB> treeBoxes;
+			results.emplace_back("octree", run(numObjects, numTicks,
+				[&](const World& _world)
+				{
+					for (size_t i = 0; i < _world.boxes.size(); ++i)
+					{
+						if (i >= treeBoxes.size())
+						{
+							tree.insert(_world.boxes[i], static_cast<int>(i));
+							treeBoxes.push_back(_world.boxes[i]);
+						}
+						else
+						{
+							tree.update(treeBoxes[i], _world.boxes[i], static_cast<int>(i));
+							treeBoxes[i] = _world.boxes[i];
+						}
+					}
+				},
+				[&](const World& _world) { return queryPairs(tree, _world); }));
+		}
+		{
+			utils::LinearBVH<int, 3, float> bvh;
+			results.emplace_back("linear bvh", run(numObjects, numTicks,
+				[&](const World& _world) { bvh.build(_world.boxes, _world.elements); },
+				[&](const World& _world) { return queryPairs(bvh, _world); }));
+		}
+		{
+			utils::SweepAndPrune<int, 3, float> sap;
+			std::vector<uint32_t> proxies;
+			results.emplace_back("sap", run(numObjects, numTicks,
+				[&](const World& _world)
+				{
+					for (size_t i = 0; i < _world.boxes.size(); ++i)
+					{
+						if (i >= proxies.size()) proxies.push_back(sap.add(_world.boxes[i], static_cast<int>(i)));
+						else sap.update(proxies[i], _world.boxes[i]);
+					}
+				},
+				[&](const World&) { return sap.findPairs().size(); }));
+		}
+
+		for (const auto& [name, result] : results)
+		{
+			fmt::print("{:<8} {:<12} {:<10.3f} {:<10.3f} {:<10}\n", numObjects, name, result.update, result.pairs, result.numPairs);
+			if (result.numPairs != results.front().second.numPairs)
+			{
+				fmt::print("{} found a different number of pairs.\n", name);
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,102 @@
+#include <engine/utils/containers/concurrenthashmap.hpp>
+#include <engine/utils/containers/flathashmap.hpp>
+
+#include <spdlog/fmt/fmt.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <functional>
+
+namespace chrono = std::chrono;
+
+struct StringHash
+{
+	using is_transparent = void;
+	size_t operator()(std::string_view _str) const { return std::hash<std::string_view>{}(_str); }
+};
+
+// Baseline: one map with a single lock, which is what a straight forward
+// thread-safe ResourceManager would look like.
+class LockedHashMap
+{
+public:
+	template<typename Factory>
+	int getOrAdd(std::string_view _key, Factory&& _create)
+	{
+		std::scoped_lock lock(m_mutex);
+		auto handle = m_map.find(_key);
+		if (handle) return handle.data();
+		return m_map.add(std::string(_key), _create()).data();
+	}
+
+private:
+	std::mutex m_mutex;
+	utils::FlatHashMap<std::string, int, StringHash, std::equal_to<>> m_map;
+};
+
+using ShardedHashMap = utils::ConcurrentHashMap<std::string, int, StringHash, std::equal_to<>>;
+
+// Each thread performs _numOps lookups. Most keys exist already, every 16th lookup
+// is (likely) a new key which has to be inserted.
+template<typename Map>
+float benchmark(int _numThreads, int _numOps, const std::vector<std::string>& _keys)
+{
+	Map map;
+	for (size_t i = 0; i < _keys.size() / 2; ++i)
+		map.getOrAdd(_keys[i], [i]() { return static_cast<int>(i); });
+
+	std::vector<std::thread> threads;
+	threads.reserve(_numThreads);
+	std::vector<int> checksums(_numThreads);
+
+	const auto start = chrono::high_resolution_clock::now();
+	for (int t = 0; t < _numThreads; ++t)
+		threads.emplace_back([&, t]()
+		{
+			std::minstd_rand rng(t + 1);
+			int sum = 0;
+			for (int i = 0; i < _numOps; ++i)
+			{
+				const size_t idx = i % 16 ? rng() % (_keys.size() / 2) : rng() % _keys.size();
+				sum += map.getOrAdd(_keys[idx], [idx]() { return static_cast<int>(idx); });
+			}
+			checksums[t] = sum;
+		});
+	for (auto& thread : threads)
+		thread.join();
+	const auto end = chrono::high_resolution_clock::now();
+
+	// Million operations per second.
+	return static_cast<float>(_numThreads) * _numOps / chrono::duration<float, std::micro>(end - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+	int numKeys = 1 << 14;
+	int numOps = 1 << 18;
+	if (argc >= 3)
+	{
+		numKeys = std::stoi(argv[1]);
+		numOps = std::stoi(argv[2]);
+	}
+
+	std::vector<std::string> keys;
+	keys.reserve(numKeys);
+	for (int i = 0; i < numKeys; ++i)
+		keys.push_back("textures/planet_" + std::to_string(i) + ".png");
+
+	fmt::print("num keys: {}; ops per thread: {}; hardware threads: {}\n", numKeys, numOps, std::thread::hardware_concurrency());
+	fmt::print("{:<8} {:<14} {:<14} {:<8}\n", "threads", "locked Mops/s", "sharded Mops/s", "speedup");
+	for (int numThreads = 1; numThreads <= 32; numThreads *= 2)
+	{
+		const float locked = benchmark<LockedHashMap>(numThreads, numOps, keys);
+		const float sharded = benchmark<ShardedHashMap>(numThreads, numOps, keys);
+		fmt::print("{:<8} {:<14.2f} {:<14.2f} {:<8.2f}\n", numThreads, locked, sharded, sharded / locked);
+	}
+
+	return 0;
+}
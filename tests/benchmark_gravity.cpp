@@ -0,0 +1,88 @@
+#include <engine/math/gravity.hpp>
+
+#include <spdlog/fmt/fmt.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+
+namespace chrono = std::chrono;
+
+// Bodies in a Plummer-like cluster, dense in the center.
+template<typename FloatT>
+struct Cluster
+{
+	using VecT = glm::vec<3, FloatT, glm::defaultp>;
+
+	Cluster(int _numBodies)
+	{
+		std::default_random_engine rng(1357u);
+		std::normal_distribution<FloatT> position(0, 100);
+		std::uniform_real_distribution<FloatT> mass(1, 10);
+		for (int i = 0; i < _numBodies; ++i)
+		{
+			positions.emplace_back(position(rng), position(rng), position(rng));
+			masses.push_back(mass(rng));
+		}
+	}
+
+	std::vector<VecT> positions;
+	std::vector<FloatT> masses;
+};
+
+// Average time in ms to build the solver and compute all accelerations.
+template<typename Solver>
+float run(Solver& _solver, int _numBodies, int _numTicks)
+{
+	using VecT = typename Solver::VecT;
+	using FloatT = typename VecT::value_type;
+	const Cluster<FloatT> cluster(_numBodies);
+	std::vector<VecT> accelerations(_numBodies);
+
+	float total = 0.f;
+	for (int tick = 0; tick < _numTicks; ++tick)
+	{
+		const auto start = chrono::high_resolution_clock::now();
+		_solver.build(cluster.positions, cluster.masses);
+		_solver.computeAccelerations(accelerations);
+		const auto end = chrono::high_resolution_clock::now();
+		total += chrono::duration<float, std::milli>(end - start).count();
+	}
+	return total / _numTicks;
+}
+
+int main(int argc, char* argv[])
+{
+	int numTicks = 5;
+	if (argc >= 2)
+		numTicks = std::stoi(argv[1]);
+
+	fmt::print("ticks: {}; threads: {}; interactions are n^2 per tick for all solvers\n", numTicks, utils::ThreadPool::get().numThreads());
+	fmt::print("{:<8} {:<16} {:<10} {:<14}\n", "bodies", "variant", "ms", "interactions/s");
+	for (int numBodies : { 500, 2000, 8000, 50000 })
+	{
+		std::vector<std::pair<std::string, float>> results;
+		// the exact sums are too slow for the largest size
+		if (numBodies <= 8000)
+		{
+			math::DirectSum<float> vectorized;
+			results.emplace_back("direct simd", run(vectorized, numBodies, numTicks));
+			math::DirectSum<float> scalar(0.f, false);
+			results.emplace_back("direct scalar", run(scalar, numBodies, numTicks));
+			math::DirectSum<double> doubleSum;
+			results.emplace_back("direct double", run(doubleSum, numBodies, numTicks));
+		}
+		for (float theta : { 0.5f, 1.f })
+		{
+			math::BarnesHut<float> tree(theta);
+			results.emplace_back(fmt::format("barnes-hut {}", theta), run(tree, numBodies, numTicks));
+		}
+
+		const double interactions = static_cast<double>(numBodies) * numBodies;
+		for (const auto& [name, ms] : results)
+			fmt::print("{:<8} {:<16} {:<10.3f} {:<14.3e}\n", numBodies, name, ms, interactions / (ms * 1e-3));
+	}
+
+	return 0;
+}
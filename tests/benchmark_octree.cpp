@@ -0,0 +1,273 @@
+#include <engine/utils/containers/octree.hpp>
+#include <engine/utils/containers/linearbvh.hpp>
+
+#include <spdlog/fmt/fmt.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+
+namespace chrono = std::chrono;
+
+using TreeT = utils::SparseOctree<int, 3, float>;
+using LinearTreeT = utils::LinearBVH<int, 3, float>;
+
+struct MovingObject
+{
+	glm::vec3 position;
+	glm::vec3 velocity;
+	float radius;
+
+	TreeT::AABB box() const { return { position - glm::vec3(radius), position + glm::vec3(radius) }; }
+};
+
+// Objects move inside a box with constant density and bounce off its walls.
+// Only the first _movingFraction of the objects have a velocity.
+std::vector<MovingObject> createObjects(int _numObjects, float _worldSize, float _movingFraction)
+{
+	std::default_random_engine rng(13567u);
+	std::uniform_real_distribution<float> position(-_worldSize, _worldSize);
+	std::uniform_real_distribution<float> velocity(-1.f, 1.f);
+	std::uniform_real_distribution<float> radius(0.2f, 1.f);
+
+	std::vector<MovingObject> objects;
+	objects.reserve(_numObjects);
+	for (int i = 0; i < _numObjects; ++i)
+		objects.push_back({ glm::vec3(position(rng), position(rng), position(rng)),
+			glm::vec3(velocity(rng), velocity(rng), velocity(rng)), radius(rng) });
+	for (int i = static_cast<int>(_numObjects * _movingFraction); i < _numObjects; ++i)
+		objects[i].velocity = glm::vec3(0.f);
+	return objects;
+}
+
+void move(std::vector<MovingObject>& _objects, float _worldSize, float _deltaTime)
+{
+	for (MovingObject& obj : _objects)
+	{
+		obj.position += obj.velocity * _deltaTime;
+		for (int i = 0; i < 3; ++i)
+			if (obj.position[i] < -_worldSize || obj.position[i] > _worldSize) obj.velocity[i] = -obj.velocity[i];
+	}
+}
+
+// Returns the number of hits so that all variants can be compared.
+template<typename Tree>
+size_t query(const Tree& _tree, const std::vector<MovingObject>& _objects)
+{
+	size_t hits = 0;
+	for (size_t i = 0; i < _objects.size(); i += 97)
+	{
+		typename Tree::AABBQuery q(_objects[i].box());
+		_tree.traverse(q);
+		hits += q.hits.size();
+	}
+	return hits;
+}
+
+struct Result
+{
+	float update;
+	float query;
+	size_t hits;
+};
+
+Result benchmarkRebuild(int _numObjects, int _numTicks, float _looseness, float _movingFraction)
+{
+	const float worldSize = std::cbrt(static_cast<float>(_numObjects)) * 4.f;
+	std::vector<MovingObject> objects = createObjects(_numObjects, worldSize, _movingFraction);
+	TreeT tree(1.f, _looseness);
+
+	Result result{};
+	for (int tick = 0; tick < _numTicks; ++tick)
+	{
+		move(objects, worldSize, 1.f / 30.f);
+		auto start = chrono::high_resolution_clock::now();
+		tree.clear();
+		for (int i = 0; i < _numObjects; ++i)
+			tree.insert(objects[i].box(), i);
+		auto end = chrono::high_resolution_clock::now();
+		result.update += chrono::duration<float, std::milli>(end - start).count();
+
+		start = chrono::high_resolution_clock::now();
+		result.hits += query(tree, objects);
+		end = chrono::high_resolution_clock::now();
+		result.query += chrono::duration<float, std::milli>(end - start).count();
+	}
+	result.update /= _numTicks;
+	result.query /= _numTicks;
+	return result;
+}
+
+// Only objects which moved are updated.
+Result benchmarkIncremental(int _numObjects, int _numTicks, float _looseness, float _movingFraction)
+{
+	const float worldSize = std::cbrt(static_cast<float>(_numObjects)) * 4.f;
+	std::vector<MovingObject> objects = createObjects(_numObjects, worldSize, _movingFraction);
+	TreeT tree(1.f, _looseness);
+	std::vector<TreeT::AABB> boxes;
+	boxes.reserve(_numObjects);
+	for (int i = 0; i < _numObjects; ++i)
+	{
+		boxes.push_back(objects[i].box());
+		tree.insert(boxes[i], i);
+	}
+
+	Result result{};
+	for (int tick = 0; tick < _numTicks; ++tick)
+	{
+		move(objects, worldSize, 1.f / 30.f);
+		auto start = chrono::high_resolution_clock::now();
+		for (int i = 0; i < _numObjects; ++i)
+		{
+			const TreeT::AABB box = objects[i].box();
+			if (box == boxes[i]) continue;
+			tree.update(boxes[i], box, i);
+			boxes[i] = box;
+		}
+		auto end = chrono::high_resolution_clock::now();
+		result.update += chrono::duration<float, std::milli>(end - start).count();
+
+		start = chrono::high_resolution_clock::now();
+		result.hits += query(tree, objects);
+		end = chrono::high_resolution_clock::now();
+		result.query += chrono::duration<float, std::milli>(end - start).count();
+	}
+	result.update /= _numTicks;
+	result.query /= _numTicks;
+	return result;
+}
+
+// The linear tree is rebuilt in parallel from the array of boxes.
+Result benchmarkLinear(int _numObjects, int _numTicks, float _movingFraction)
+{
+	const float worldSize = std::cbrt(static_cast<float>(_numObjects)) * 4.f;
+	std::vector<MovingObject> objects = createObjects(_numObjects, worldSize, _movingFraction);
+	LinearTreeT tree;
+	std::vector<LinearTreeT::AABB> boxes(_numObjects);
+	std::vector<int> elements(_numObjects);
+	for (int i = 0; i < _numObjects; ++i)
+		elements[i] = i;
+
+	Result result{};
+	for (int tick = 0; tick < _numTicks; ++tick)
+	{
+		move(objects, worldSize, 1.f / 30.f);
+		auto start = chrono::high_resolution_clock::now();
+		for (int i = 0; i < _numObjects; ++i)
+			boxes[i] = objects[i].box();
+		tree.build(boxes, elements);
+		auto end = chrono::high_resolution_clock::now();
+		result.update += chrono::duration<float, std::milli>(end - start).count();
+
+		start = chrono::high_resolution_clock::now();
+		result.hits += query(tree, objects);
+		end = chrono::high_resolution_clock::now();
+		result.query += chrono::duration<float, std::milli>(end - start).count();
+	}
+	result.update /= _numTicks;
+	result.query /= _numTicks;
+	return result;
+}
+
+// Many small query boxes, e.g. projectiles, against the same tree.
+// The queries are spread over a cube of _queryRange * world size.
+// Returns the time in ms for single queries and for one batched query.
+std::pair<float, float> benchmarkBatchQuery(int _numObjects, int _numQueries, float _queryRange, int _numTicks)
+{
+	const float worldSize = std::cbrt(static_cast<float>(_numObjects)) * 4.f;
+	std::vector<MovingObject> objects = createObjects(_numObjects, worldSize, 1.f);
+	TreeT tree(1.f, 0.5f);
+	for (int i = 0; i < _numObjects; ++i)
+		tree.insert(objects[i].box(), i);
+
+	std::vector<TreeT::AABB> queries;
+	std::default_random_engine rng(97u);
+	std::uniform_real_distribution<float> position(-worldSize * _queryRange, worldSize * _queryRange);
+	for (int i = 0; i < _numQueries; ++i)
+	{
+		const glm::vec3 center(position(rng), position(rng), position(rng));
+		queries.push_back({ center - glm::vec3(0.1f), center + glm::vec3(0.1f) });
+	}
+
+	size_t singleHits = 0;
+	auto start = chrono::high_resolution_clock::now();
+	for (int tick = 0; tick < _numTicks; ++tick)
+	{
+		for (const TreeT::AABB& box : queries)
+		{
+			TreeT::AABBQuery q(box);
+			tree.traverse(q);
+			singleHits += q.hits.size();
+		}
+	}
+	auto end = chrono::high_resolution_clock::now();
+	const float single = chrono::duration<float, std::milli>(end - start).count() / _numTicks;
+
+	size_t batchHits = 0;
+	start = chrono::high_resolution_clock::now();
+	for (int tick = 0; tick < _numTicks; ++tick)
+		tree.traverseBatch(queries, [&](size_t, const TreeT::AABB&, int) { ++batchHits; });
+	end = chrono::high_resolution_clock::now();
+	const float batch = chrono::duration<float, std::milli>(end - start).count() / _numTicks;
+
+	if (singleHits != batchHits)
+		fmt::print("Batched query returned different results.\n");
+	return { single, batch };
+}
+
+int main(int argc, char* argv[])
+{
+	int numTicks = 30;
+	if (argc >= 2)
+		numTicks = std::stoi(argv[1]);
+
+	fmt::print("ticks: {}; threads: {}; times in ms per tick\n", numTicks, utils::ThreadPool::get().numThreads());
+	fmt::print("{:<8} {:<7} {:<6} {:<12} {:<10} {:<10} {:<10}\n", "objects", "moving", "loose", "variant", "update", "query", "hits");
+	for (int numObjects : { 1000, 10000, 100000 })
+	{
+		for (float movingFraction : { 1.f, 0.1f })
+		{
+			size_t rebuildHits = 0;
+			for (float looseness : { 0.f, 0.5f })
+			{
+				const Result rebuild = benchmarkRebuild(numObjects, numTicks, looseness, movingFraction);
+				const Result incremental = benchmarkIncremental(numObjects, numTicks, looseness, movingFraction);
+				fmt::print("{:<8} {:<7} {:<6} {:<12} {:<10.3f} {:<10.3f} {:<10}\n", numObjects, movingFraction, looseness, "rebuild",
+					rebuild.update, rebuild.query, rebuild.hits);
+				fmt::print("{:<8} {:<7} {:<6} {:<12} {:<10.3f} {:<10.3f} {:<10}\n", numObjects, movingFraction, looseness, "incremental",
+					incremental.update, incremental.query, incremental.hits);
+				if (incremental.hits != rebuild.hits)
+				{
+					fmt::print("Incremental update returned different results.\n");
+					return 1;
+				}
+				rebuildHits = rebuild.hits;
+			}
+
+			const Result linear = benchmarkLinear(numObjects, numTicks, movingFraction);
+			fmt::print("{:<8} {:<7} {:<6} {:<12} {:<10.3f} {:<10.3f} {:<10}\n", numObjects, movingFraction, "-", "linear bvh",
+				linear.update, linear.query, linear.hits);
+			if (linear.hits != rebuildHits)
+			{
+				fmt::print("Linear BVH returned different results.\n");
+				return 1;
+			}
+		}
+	}
+
+	fmt::print("\n{:<8} {:<8} {:<6} {:<10} {:<10}\n", "objects", "queries", "range", "single", "batch");
+	for (int numObjects : { 1000, 10000, 100000 })
+	{
+		for (int numQueries : { 100, 1000 })
+		{
+			for (float queryRange : { 1.f, 0.1f })
+			{
+				const auto [single, batch] = benchmarkBatchQuery(numObjects, numQueries, queryRange, numTicks);
+				fmt::print("{:<8} {:<8} {:<6} {:<10.3f} {:<10.3f}\n", numObjects, numQueries, queryRange, single, batch);
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+#include "testutils.hpp"
+
+#include <engine/math/aabbarray.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+
+template<unsigned Dim, typename FloatT>
+bool matchesScalar(int _numBoxes, unsigned _seed)
+{
+	using ArrayT = math::AABBArray<Dim, FloatT>;
+	using BoxT = typename ArrayT::BoxT;
+	using VecT = typename BoxT::VecT;
+
+	std::default_random_engine rng(_seed);
+	std::uniform_real_distribution<FloatT> position(-10, 10);
+	std::uniform_real_distribution<FloatT> size(0, 3);
+	auto randomBox = [&]()
+	{
+		VecT min, max;
+		for (unsigned d = 0; d < Dim; ++d)
+		{
+			min[d] = position(rng);
+			max[d] = min[d] + size(rng);
+		}
+		return BoxT(min, max);
+	};
+
+	std::vector<BoxT> boxes;
+	ArrayT array;
+	for (int i = 0; i < _numBoxes; ++i)
+	{
+		boxes.push_back(randomBox());
+		array.push_back(boxes.back());
+	}
+
+	bool match = array.size() == boxes.size();
+	for (int q = 0; q < 100; ++q)
+	{
+		const BoxT query = randomBox();
+		std::vector<size_t> expected;
+		for (size_t i = 0; i < boxes.size(); ++i)
+			if (query.intersect(boxes[i])) expected.push_back(i);
+
+		std::vector<size_t> found;
+		array.forEachIntersection(query, [&](size_t _idx) { found.push_back(_idx); });
+		match &= found == expected;
+
+		// sub range which does not start at a block boundary
+		const size_t begin = boxes.size() / 3;
+		const size_t end = boxes.size() - 5;
+		std::vector<size_t> expectedRange;
+		for (size_t idx : expected)
+			if (idx >= begin && idx < end) expectedRange.push_back(idx);
+		found.clear();
+		array.forEachIntersection(query, [&](size_t _idx) { found.push_back(_idx); }, begin, end);
+		match &= found == expectedRange;
+	}
+	return match;
+}
+
+int main()
+{
+	EXPECT((matchesScalar<3, float>(1001, 11u)), "SIMD test of 3D float boxes matches Box::intersect.");
+	EXPECT((matchesScalar<2, float>(67, 12u)), "SIMD test of 2D float boxes matches Box::intersect.");
+	EXPECT((matchesScalar<3, double>(200, 13u)), "Scalar test of double boxes matches Box::intersect.");
+
+	using ArrayT = math::AABBArray<3, float>;
+	ArrayT array(10);
+	for (size_t i = 0; i < array.size(); ++i)
+		array.set(i, ArrayT::BoxT(glm::vec3(static_cast<float>(i)), glm::vec3(static_cast<float>(i) + 0.5f)));
+	EXPECT(array[4] == ArrayT::BoxT(glm::vec3(4.f), glm::vec3(4.5f)), "Read back a box.");
+
+	array.resize(3);
+	const ArrayT::BoxT everything(glm::vec3(-100.f), glm::vec3(100.f));
+	EXPECT(array.intersectMask(everything, 0) == 0b111, "Padding after a shrink intersects nothing.");
+
+	array.clear();
+	int numHits = 0;
+	array.forEachIntersection(everything, [&](size_t) { ++numHits; });
+	EXPECT(array.empty() && numHits == 0, "Clear the array.");
+
+	return testsFailed;
+}
@@ -0,0 +1,61 @@
+#include "testutils.hpp"
+
+#include <engine/utils/blockalloc.hpp>
+#include <string>
+#include <vector>
+#include <cinttypes>
+
+int alive = 0;
+
+struct Dummy
+{
+	Dummy(int _i) : str(std::to_string(_i)) { ++alive; }
+	~Dummy() { --alive; }
+
+	std::string str;
+};
+
+struct alignas(32) Aligned
+{
+	double values[3];
+};
+
+int main()
+{
+	{
+		utils::BlockAllocator<Dummy, 16> allocator;
+		std::vector<Dummy*> objects;
+		for (int i = 0; i < 1000; ++i)
+			objects.push_back(allocator.create(i));
+		EXPECT(alive == 1000 && objects[42]->str == "42", "Create objects over multiple blocks.");
+
+		for (int i = 0; i < 1000; i += 2)
+			allocator.destroy(objects[i]);
+		EXPECT(alive == 500 && objects[43]->str == "43", "Destroy single objects.");
+
+		Dummy* reused = allocator.create(7);
+		EXPECT(reused == objects[998] && reused->str == "7", "Reuse the memory of destroyed objects.");
+
+		allocator.reset();
+		EXPECT(alive == 0, "Reset destroys all living objects.");
+
+		// Enough blocks that a recursive teardown would be deep.
+		for (int i = 0; i < 200000; ++i)
+			allocator.create(i);
+	}
+	EXPECT(alive == 0, "Destruction destroys all living objects.");
+
+	{
+		utils::BlockAllocator<Aligned, 3, true> allocator;
+		bool allAligned = true;
+		for (int k = 0; k < 3; ++k)
+		{
+			for (int i = 0; i < 500; ++i)
+				allAligned &= reinterpret_cast<uintptr_t>(allocator.create()) % alignof(Aligned) == 0;
+			allocator.reset();
+		}
+		EXPECT(allAligned, "Respect the alignment of the type with cached blocks.");
+	}
+
+	return testsFailed;
+}
@@ -0,0 +1,97 @@
+#include "testutils.hpp"
+
+#include <engine/utils/containers/concurrenthashmap.hpp>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+struct StringHash
+{
+	using is_transparent = void;
+	size_t operator()(std::string_view _str) const { return std::hash<std::string_view>{}(_str); }
+};
+
+int main()
+{
+	{
+		utils::ConcurrentHashMap<int, int> map;
+		EXPECT(map.empty() && map.begin() == map.end(), "Construct an empty map.");
+
+		for (int i = 0; i < 1000; ++i)
+			map.add(i, i * 2);
+		map.add(4, 5);
+		EXPECT(map.size() == 1000 && map.get(4) == 5, "Insert and overwrite elements.");
+		EXPECT(!map.get(1000) && !map.find(1000), "Find a not existing element.");
+		EXPECT(map.remove(7) && !map.remove(7) && map.size() == 999, "Remove an element.");
+
+		{
+			auto handle = map.find(8);
+			EXPECT(handle && handle.key() == 8 && handle.data() == 16, "Find an element with a handle.");
+		}
+
+		int iterated = 0;
+		bool allValid = true;
+		for (const auto& it : map)
+		{
+			++iterated;
+			allValid &= it.key() == 4 ? it.data() == 5 : it.data() == it.key() * 2;
+		}
+		EXPECT(iterated == 999 && allValid, "Iterate over all shards.");
+
+		map.clear();
+		EXPECT(map.empty() && map.begin() == map.end(), "Clear the map.");
+	}
+
+	{
+		utils::ConcurrentHashMap<std::string, int, StringHash, std::equal_to<>> map;
+		constexpr int NUM_THREADS = 8;
+		constexpr int NUM_KEYS = 500;
+		std::atomic<int> numCreated = 0;
+		std::atomic<bool> allValid = true;
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < NUM_THREADS; ++t)
+			threads.emplace_back([&, t]()
+			{
+				for (int i = 0; i < NUM_KEYS; ++i)
+				{
+					const int k = (i + t * 37) % NUM_KEYS;
+					const std::string key = "resource" + std::to_string(k);
+					const int value = map.getOrAdd(std::string_view(key), [&]() { ++numCreated; return k; });
+					if (value != k) allValid = false;
+				}
+			});
+		for (auto& thread : threads)
+			thread.join();
+
+		EXPECT(numCreated == NUM_KEYS && map.size() == NUM_KEYS, "Concurrent getOrAdd creates each element once.");
+		EXPECT(allValid, "Concurrent getOrAdd returns the correct elements.");
+	}
+
+	{
+		// a single shard, so that every access goes to the shard of the key being created
+		utils::ConcurrentHashMap<std::string, int, StringHash, std::equal_to<>, 1> map;
+		map.add(std::string("base"), 1);
+		const int value = map.getOrAdd(std::string_view("derived"), [&]() {
+			return map.get(std::string_view("base")).value() + map.getOrAdd(std::string_view("dependency"), []() { return 10; });
+		});
+		EXPECT(value == 11 && map.size() == 3, "The factory of getOrAdd can access the map.");
+
+		bool threw = false;
+		try
+		{
+			map.getOrAdd(std::string_view("failing"), []() -> int { throw std::runtime_error("load failed"); });
+		}
+		catch (const std::runtime_error&)
+		{
+			threw = true;
+		}
+		EXPECT(threw && !map.get(std::string_view("failing")), "A throwing factory adds no element.");
+		EXPECT(map.getOrAdd(std::string_view("failing"), []() { return 2; }) == 2, "A failed element can be created again.");
+	}
+
+	return testsFailed;
+}
@@ -0,0 +1,192 @@
+#include "testutils.hpp"
+
+#include <engine/math/contactsolver.hpp>
+#include <engine/components/RigidBody.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <cmath>
+
+using vec3 = glm::vec3;
+using Body = math::SolverBody<float>;
+using Pair = std::pair<uint32_t, uint32_t>;
+using Contact = math::Contact<3, float>;
+
+static Body sphere(const vec3& _position, const vec3& _velocity, float _restitution, float _friction, uint32_t _id)
+{
+	const float radius = 1.f;
+	Body body;
+	body.position = _position;
+	body.velocity = _velocity;
+	body.inverseMass = 1.f;
+	body.inverseInertia = glm::mat3(1.f / (0.4f * radius * radius));
+	body.restitution = _restitution;
+	body.friction = _friction;
+	body.id = _id;
+	return body;
+}
+
+static Body ground(float _friction)
+{
+	Body body;
+	body.friction = _friction;
+	body.id = 1000;
+	return body;
+}
+
+// contact of a unit sphere with the plane y = 0
+static Contact groundContact(const Body& _sphere)
+{
+	const float depth = 1.f - _sphere.position.y;
+	return { vec3(_sphere.position.x, -depth * 0.5f, _sphere.position.z), vec3(0.f, -1.f, 0.f), depth, 0 };
+}
+
+int main()
+{
+	const float dt = 1.f / 60.f;
+
+	{
+		// head-on collision of equal masses
+		std::vector<Body> bodies = { sphere(vec3(-1.f, 0.f, 0.f), vec3(2.f, 0.f, 0.f), 1.f, 0.f, 0),
+			sphere(vec3(1.f, 0.f, 0.f), vec3(-1.f, 0.f, 0.f), 1.f, 0.f, 1) };
+		const std::vector<Pair> pairs = { { 0, 1 } };
+		const std::vector<Contact> contacts = { { vec3(0.f), vec3(1.f, 0.f, 0.f), 0.f, 0 } };
+		math::ContactSolver<float> solver;
+		solver.solve(bodies, pairs, contacts, dt);
+		EXPECT(glm::length(bodies[0].velocity - vec3(-1.f, 0.f, 0.f)) < 1e-4f && glm::length(bodies[1].velocity - vec3(2.f, 0.f, 0.f)) < 1e-4f,
+			"Elastic collision exchanges the velocities.");
+
+		bodies[0].velocity = vec3(2.f, 0.f, 0.f);
+		bodies[1].velocity = vec3(-1.f, 0.f, 0.f);
+		bodies[0].restitution = bodies[1].restitution = 0.f;
+		solver.clearCache();
+		solver.solve(bodies, pairs, contacts, dt);
+		EXPECT(glm::length(bodies[0].velocity - vec3(0.5f, 0.f, 0.f)) < 1e-4f && glm::length(bodies[1].velocity - vec3(0.5f, 0.f, 0.f)) < 1e-4f,
+			"Inelastic collision.");
+		EXPECT(bodies[0].angularVelocity == vec3(0.f), "Central collision does not rotate.");
+	}
+
+	// A sphere resting on the ground under gravity, with a single iteration per tick.
+	auto restOnGround = [&](math::ContactSolver<float>& _solver, int _ticks)
+	{
+		std::vector<Body> bodies = { sphere(vec3(0.f, 1.f, 0.f), vec3(0.f), 0.f, 0.5f, 0), ground(0.5f) };
+		const std::vector<Pair> pairs = { { 0, 1 } };
+		float maxSpeed = 0.f;
+		for (int i = 0; i < _ticks; ++i)
+		{
+			bodies[0].velocity.y -= 9.81f * dt;
+			const std::vector<Contact> contacts = { groundContact(bodies[0]) };
+			_solver.solve(bodies, pairs, contacts, dt);
+			bodies[0].position += bodies[0].velocity * dt;
+			maxSpeed = std::max(maxSpeed, glm::length(bodies[0].velocity));
+		}
+		return std::pair(bodies[0], maxSpeed);
+	};
+	{
+		math::ContactSolver<float> solver(1);
+		const auto [body, maxSpeed] = restOnGround(solver, 300);
+		EXPECT(std::abs(body.position.y - 1.f) < 0.02f && maxSpeed < 0.2f, "Sphere rests on the ground.");
+		EXPECT(solver.numIslands() == 1, "One island.");
+	}
+
+	{
+		// sliding sphere: friction slows it down and makes it roll
+		std::vector<Body> bodies = { sphere(vec3(0.f, 1.f, 0.f), vec3(5.f, 0.f, 0.f), 0.f, 0.5f, 0), ground(0.5f) };
+		const std::vector<Pair> pairs = { { 0, 1 } };
+		math::ContactSolver<float> solver;
+		for (int i = 0; i < 120; ++i)
+		{
+			bodies[0].velocity.y -= 9.81f * dt;
+			const std::vector<Contact> contacts = { groundContact(bodies[0]) };
+			solver.solve(bodies, pairs, contacts, dt);
+			bodies[0].position += bodies[0].velocity * dt;
+		}
+		// a solid sphere rolls with 5/7 of its initial speed
+		EXPECT(std::abs(bodies[0].velocity.x - 5.f * 5.f / 7.f) < 0.05f, "Friction decelerates to rolling.");
+		EXPECT(std::abs(bodies[0].angularVelocity.z + bodies[0].velocity.x) < 0.05f, "Rolling without slipping.");
+
+		bodies[0].friction = 0.f;
+		bodies[0].velocity = vec3(5.f, 0.f, 0.f);
+		bodies[0].angularVelocity = vec3(0.f);
+		const std::vector<Contact> contacts = { groundContact(bodies[0]) };
+		solver.solve(bodies, pairs, contacts, dt);
+		EXPECT(bodies[0].velocity.x == 5.f && bodies[0].angularVelocity == vec3(0.f), "No friction.");
+	}
+
+	{
+		// rows of touching spheres on the ground, each row is an island
+		std::default_random_engine rng(3u);
+		std::uniform_real_distribution<float> velocity(-1.f, 1.f);
+		std::vector<Body> bodies = { ground(0.5f) };
+		std::vector<Pair> pairs;
+		std::vector<Contact> contacts;
+		const int numRows = 50;
+		const int rowLength = 6;
+		for (int row = 0; row < numRows; ++row)
+		{
+			for (int i = 0; i < rowLength; ++i)
+			{
+				const uint32_t index = static_cast<uint32_t>(bodies.size());
+				bodies.push_back(sphere(vec3(1.9f * i, 0.95f, 10.f * row), vec3(velocity(rng), velocity(rng), velocity(rng)), 0.3f, 0.5f, index));
+				pairs.emplace_back(index, 0);
+				contacts.push_back(groundContact(bodies.back()));
+				contacts.back().pair = static_cast<uint32_t>(pairs.size() - 1);
+				if (i > 0)
+				{
+					pairs.emplace_back(index - 1, index);
+					contacts.push_back({ vec3(1.9f * i - 0.95f, 0.95f, 10.f * row), vec3(1.f, 0.f, 0.f), 0.1f, static_cast<uint32_t>(pairs.size() - 1) });
+				}
+			}
+		}
+
+		auto run = [&](utils::ThreadPool& _threadPool)
+		{
+			math::ContactSolver<float> solver;
+			std::vector<Body> result = bodies;
+			for (int i = 0; i < 3; ++i)
+				solver.solve(result, pairs, contacts, dt, _threadPool);
+			EXPECT(solver.numIslands() == numRows, "Each row is an island.");
+			return result;
+		};
+		utils::ThreadPool single(1);
+		utils::ThreadPool parallel(4);
+		const std::vector<Body> a = run(single);
+		const std::vector<Body> b = run(parallel);
+		bool equal = true;
+		for (size_t i = 0; i < a.size(); ++i)
+			equal &= a[i].velocity == b[i].velocity && a[i].angularVelocity == b[i].angularVelocity;
+		EXPECT(equal, "Parallel islands give identical results.");
+		EXPECT(a[0].velocity == vec3(0.f), "Static bodies are not changed.");
+	}
+
+	{
+		// the RigidBodySystem with entities
+		entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+		entity::EntityReference *planetA = registry.createEntity(
+			components::Transform(vec3(-1.f, 0.f, 0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(1.f, 0.f, 0.f)),
+			components::RotationalVelocity(vec3(0.f)),
+			components::RigidBody::sphere(1.f, 1.f, 0.f, 1.f));
+		entity::EntityReference *planetB = registry.createEntity(
+			components::Transform(vec3(1.f, 0.f, 0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.f)),
+			components::RigidBody::sphere(1.f, 1.f, 0.f, 1.f));
+		math::ContactSolver<float> solver;
+		const std::vector<components::EntityContact> contacts = {
+			{ planetA, planetB, { vec3(0.f), vec3(1.f, 0.f, 0.f), 0.f, 0 } },
+			{ planetB, nullptr, { vec3(2.f, 0.f, 0.f), vec3(1.f, 0.f, 0.f), 0.f, 0 } } };
+		components::RigidBodySystem(registry, solver, dt).solve(contacts);
+		// b is stopped by the wall, so a bounces back
+		EXPECT(registry.getComponentData<components::Velocity>(planetA).value().velocity.x < -0.5f
+			&& std::abs(registry.getComponentData<components::Velocity>(planetB).value().velocity.x) < 1e-4f,
+			"RigidBodySystem resolves contacts between entities and with the world.");
+
+		for (entity::EntityReference *entity : { planetA, planetB })
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	return testsFailed;
+}
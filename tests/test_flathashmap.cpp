@@ -0,0 +1,104 @@
+#include "testutils.hpp"
+
+#include <engine/utils/containers/flathashmap.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <random>
+
+int constructed = 0;
+int destroyed = 0;
+
+struct Dummy
+{
+	Dummy() { ++constructed; }
+	Dummy(int _i) : i(_i) { ++constructed; }
+	Dummy(Dummy&& _oth) noexcept : i(_oth.i) { ++constructed; }
+	Dummy(const Dummy& _oth) : i(_oth.i) { ++constructed; }
+	~Dummy() { ++destroyed; }
+
+	Dummy& operator=(const Dummy& _oth) = default;
+	Dummy& operator=(Dummy&& _oth) noexcept = default;
+
+	int i = 0;
+};
+
+struct StringHash
+{
+	using is_transparent = void;
+	size_t operator()(std::string_view _str) const { return std::hash<std::string_view>{}(_str); }
+};
+
+int main()
+{
+	{
+		utils::FlatHashMap<int, Dummy> map;
+		EXPECT(map.empty() && map.begin() == map.end(), "Construct an empty map.");
+
+		map.add(4, Dummy(4));
+		EXPECT(map.size() == 1 && map.find(4) && map.find(4).data().i == 4, "Insert a single element.");
+		map.add(4, Dummy(5));
+		EXPECT(map.size() == 1 && map.find(4).data().i == 5, "Overwrite an existing element.");
+		EXPECT(!map.find(3), "Find a not existing element.");
+
+		std::unordered_map<int, int> reference;
+		std::mt19937 gen(42);
+		std::uniform_int_distribution<int> keyDistribution(0, 4000);
+		for (int i = 0; i < 20000; ++i)
+		{
+			const int key = keyDistribution(gen);
+			if (gen() % 3 == 0)
+			{
+				map.remove(key);
+				reference.erase(key);
+			}
+			else
+			{
+				map.add(key, Dummy(i));
+				reference[key] = i;
+			}
+		}
+		EXPECT(map.size() == reference.size(), "Random inserts and removals with capacity increases.");
+
+		bool allFound = true;
+		for (const auto& [key, value] : reference)
+		{
+			auto handle = map.find(key);
+			allFound &= handle && handle.data().i == value;
+		}
+		EXPECT(allFound, "Retrieve all elements after random inserts and removals.");
+
+		size_t iterated = 0;
+		bool allValid = true;
+		for (auto it : map)
+		{
+			++iterated;
+			allValid &= reference.contains(it.key()) && reference[it.key()] == it.data().i;
+		}
+		EXPECT(iterated == reference.size() && allValid, "Iterate over all elements.");
+
+		map[5000].i = 7;
+		EXPECT(map.find(5000).data().i == 7, "Insert with operator[].");
+
+		map.clear();
+		EXPECT(map.empty() && !map.find(5000), "Clear the map.");
+	}
+	EXPECT(constructed == destroyed, "All constructed objects have been destroyed.");
+
+	{
+		utils::FlatHashMap<std::string, int, StringHash, std::equal_to<>> map(4);
+		for (int i = 0; i < 100; ++i)
+			map.add("resource" + std::to_string(i), i);
+
+		EXPECT(map.capacity() >= 100, "Reserve capacity while inserting.");
+		const std::string_view key = "resource42";
+		EXPECT(map.find(key) && map.find(key).data() == 42, "Heterogeneous lookup.");
+		map.remove(key);
+		EXPECT(!map.find(key) && map.size() == 99, "Heterogeneous removal.");
+
+		utils::FlatHashMap<std::string, int, StringHash, std::equal_to<>> map2(std::move(map));
+		EXPECT(map2.size() == 99 && map2.find(std::string_view("resource7")).data() == 7, "Move construct.");
+	}
+
+	return testsFailed;
+}
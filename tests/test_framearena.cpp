@@ -0,0 +1,43 @@
+#include "testutils.hpp"
+
+#include <engine/utils/framearena.hpp>
+#include <memory_resource>
+#include <vector>
+#include <cinttypes>
+
+int main()
+{
+	utils::FrameArena arena(256);
+
+	int* ints = arena.allocate<int>(16);
+	for (int i = 0; i < 16; ++i)
+		ints[i] = i;
+	double* aligned = static_cast<double*>(arena.allocate(sizeof(double), 64));
+	EXPECT(reinterpret_cast<uintptr_t>(aligned) % 64 == 0, "Respect the requested alignment.");
+	EXPECT(arena.frameBytes() >= 16 * sizeof(int) + sizeof(double), "Count allocated bytes.");
+
+	{
+		std::pmr::vector<int> temp(&arena);
+		for (int i = 0; i < 1000; ++i)
+			temp.push_back(i);
+		EXPECT(temp[999] == 999 && arena.capacity() > 512, "Grow beyond the initial chunk.");
+	}
+	EXPECT(ints[15] == 15, "Growing does not move previous allocations.");
+
+	const size_t firstFrame = arena.frameBytes();
+	arena.nextFrame();
+	EXPECT(arena.frameBytes() == 0 && arena.lastFrameBytes() == firstFrame, "Start a new frame.");
+	EXPECT(ints[15] == 15, "Allocations of the previous frame are still valid.");
+
+	arena.allocate<int>(4);
+	arena.nextFrame();
+	EXPECT(arena.peakFrameBytes() == firstFrame, "Track the peak bytes per frame.");
+
+	// The buffer of the first frame was merged into a single chunk.
+	const size_t capacity = arena.capacity();
+	std::pmr::vector<int> temp(&arena);
+	temp.reserve(1000);
+	EXPECT(arena.capacity() == capacity, "Reuse the merged chunk without allocating.");
+
+	return testsFailed;
+}
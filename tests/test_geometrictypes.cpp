@@ -0,0 +1,106 @@
+#include "testutils.hpp"
+
+#include <engine/math/geometrictypes.hpp>
+#include <engine/components/AABBCollider.h>
+#include <engine/utils/framearena.hpp>
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <random>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+// Reference: transform all corners and take their bounds.
+math::AABB<3, float> transformCorners(const math::AABB<3, float>& _box, const glm::mat4& _transform)
+{
+	glm::vec3 min(std::numeric_limits<float>::max());
+	glm::vec3 max(std::numeric_limits<float>::lowest());
+	for (int i = 0; i < 8; ++i)
+	{
+		const glm::vec3 corner((i & 1) ? _box.max.x : _box.min.x, (i & 2) ? _box.max.y : _box.min.y, (i & 4) ? _box.max.z : _box.min.z);
+		const glm::vec3 p = glm::vec3(_transform * glm::vec4(corner, 1.f));
+		min = glm::min(min, p);
+		max = glm::max(max, p);
+	}
+	return { min, max };
+}
+
+bool approxEqual(const glm::vec3& a, const glm::vec3& b)
+{
+	for (int i = 0; i < 3; ++i)
+		if (std::abs(a[i] - b[i]) > 1e-4f) return false;
+	return true;
+}
+
+int main()
+{
+	const math::AABB<3, float> box(glm::vec3(-1.f, -0.5f, -2.f), glm::vec3(1.f, 1.5f, 0.f));
+	EXPECT(math::transform(box, glm::identity<glm::mat4>()) == box, "Identity transformation keeps the box.");
+
+	std::default_random_engine rng(5u);
+	std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+	std::uniform_real_distribution<float> scale(0.2f, 3.f);
+	std::uniform_real_distribution<float> position(-10.f, 10.f);
+	bool allMatch = true;
+	for (int i = 0; i < 100; ++i)
+	{
+		const glm::vec3 translation(position(rng), position(rng), position(rng));
+		const glm::quat rotation(glm::vec3(angle(rng), angle(rng), angle(rng)));
+		const glm::vec3 scaling(scale(rng), scale(rng), scale(rng));
+		const glm::mat4 transform = glm::translate(glm::identity<glm::mat4>(), translation) * glm::toMat4(rotation)
+			* glm::scale(glm::identity<glm::mat4>(), scaling);
+
+		const math::AABB<3, float> expected = transformCorners(box, transform);
+		const math::AABB<3, float> result = math::transform(box, transform);
+		allMatch &= approxEqual(expected.min, result.min) && approxEqual(expected.max, result.max);
+	}
+	EXPECT(allMatch, "Transformed box matches the bounds of all transformed corners.");
+
+	const math::AABB<2, double> rect(glm::dvec2(0.0), glm::dvec2(2.0, 1.0));
+	glm::dmat3 rotate90(0.0);
+	rotate90[0][1] = 1.0;
+	rotate90[1][0] = -1.0;
+	rotate90[2][2] = 1.0;
+	const math::AABB<2, double> rotated = math::transform(rect, rotate90);
+	EXPECT(rotated.min == glm::dvec2(-1.0, 0.0) && rotated.max == glm::dvec2(0.0, 2.0), "Rotate a 2D box by 90 degrees.");
+
+	{
+		// the batched pass over rotated colliders
+		entity::EntityRegistry& registry = entity::EntityRegistry::getInstance();
+		const components::AABBCollider collider(glm::vec3(1.f, 1.5f, 0.f), glm::vec3(-1.f, -0.5f, -2.f));
+		std::vector<entity::EntityReference*> entities;
+		std::vector<glm::mat4> transforms;
+		for (int i = 0; i < 20; ++i)
+		{
+			const components::Transform transform(glm::vec3(position(rng), position(rng), position(rng)),
+				glm::quat(glm::vec3(angle(rng), angle(rng), angle(rng))), glm::vec3(scale(rng), scale(rng), scale(rng)));
+			entities.push_back(registry.createEntity(transform, collider));
+			transforms.push_back(transform.getTransformMatrix());
+		}
+
+		std::pmr::vector<components::AABBColliderSystem::ColliderBox> boxes(&utils::FrameArena::get());
+		components::AABBColliderSystem(registry, boxes).execute();
+		bool systemMatches = boxes.size() == entities.size();
+		for (const components::AABBColliderSystem::ColliderBox& colliderBox : boxes)
+		{
+			const size_t i = std::find(entities.begin(), entities.end(), colliderBox.entity) - entities.begin();
+			if (i == entities.size())
+			{
+				systemMatches = false;
+				continue;
+			}
+			const math::AABB<3, float> expected = math::transform(box, transforms[i]);
+			systemMatches &= approxEqual(expected.min, colliderBox.box.min) && approxEqual(expected.max, colliderBox.box.max);
+		}
+		EXPECT(systemMatches, "AABBColliderSystem computes the transformed box of every collider.");
+
+		for (entity::EntityReference* entity : entities)
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	return testsFailed;
+}
@@ -0,0 +1,204 @@
+#include "testutils.hpp"
+
+#include <engine/math/gravity.hpp>
+#include <engine/components/OrbitalObject.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <cmath>
+
+using vec3 = glm::vec3;
+using dvec3 = glm::dvec3;
+
+struct Bodies
+{
+	Bodies(int _count, unsigned _seed)
+	{
+		std::default_random_engine rng(_seed);
+		std::normal_distribution<float> position(0.f, 50.f);
+		std::uniform_real_distribution<float> mass(1.f, 100.f);
+		for (int i = 0; i < _count; ++i)
+		{
+			positions.emplace_back(position(rng), position(rng), position(rng));
+			masses.push_back(mass(rng));
+		}
+	}
+
+	// exact sum in double precision
+	std::vector<dvec3> reference() const
+	{
+		std::vector<dvec3> accelerations(positions.size(), dvec3(0.0));
+		for (size_t i = 0; i < positions.size(); ++i)
+			for (size_t j = 0; j < positions.size(); ++j)
+			{
+				if (i == j) continue;
+				const dvec3 d = dvec3(positions[j]) - dvec3(positions[i]);
+				const double dist = glm::length(d);
+				accelerations[i] += d * (masses[j] / (dist * dist * dist));
+			}
+		return accelerations;
+	}
+
+	std::vector<vec3> positions;
+	std::vector<float> masses;
+};
+
+// Root mean square of the relative errors.
+static double relativeError(const std::vector<vec3>& _accelerations, const std::vector<dvec3>& _reference)
+{
+	double sum = 0.0;
+	for (size_t i = 0; i < _reference.size(); ++i)
+	{
+		const double error = glm::length(dvec3(_accelerations[i]) - _reference[i]) / glm::length(_reference[i]);
+		sum += error * error;
+	}
+	return std::sqrt(sum / _reference.size());
+}
+
+int main()
+{
+	{
+		math::BarnesHut<float> tree;
+		tree.build({}, {});
+		EXPECT(tree.size() == 0 && tree.numNodes() == 0 && tree.accelerationAt(vec3(1.f)) == vec3(0.f), "Empty tree.");
+	}
+
+	{
+		const Bodies bodies(2000, 11u);
+		const std::vector<dvec3> reference = bodies.reference();
+		std::vector<vec3> accelerations(bodies.positions.size());
+
+		math::BarnesHut<float> exact(0.f);
+		exact.build(bodies.positions, bodies.masses);
+		exact.computeAccelerations(accelerations);
+		EXPECT(relativeError(accelerations, reference) < 1e-5, "Opening angle 0 computes the exact sum.");
+
+		math::BarnesHut<float> tree(0.5f);
+		tree.build(bodies.positions, bodies.masses);
+		tree.computeAccelerations(accelerations);
+		EXPECT(tree.numNodes() > 1 && relativeError(accelerations, reference) < 1e-2, "Opening angle 0.5 is accurate to 1%.");
+
+		utils::ThreadPool threadPool(4);
+		std::vector<vec3> parallel(bodies.positions.size());
+		tree.computeAccelerations(parallel, threadPool);
+		EXPECT(parallel == accelerations, "Parallel evaluation gives the same result.");
+
+		float totalMass = 0.f;
+		for (float m : bodies.masses)
+			totalMass += m;
+		const vec3 far(1e5f, 0.f, 0.f);
+		const vec3 farAcceleration = tree.accelerationAt(far);
+		EXPECT(std::abs(glm::length(farAcceleration) - totalMass / (1e5f * 1e5f)) < 1e-3f * totalMass / (1e5f * 1e5f) && farAcceleration.x < 0.f,
+			"A far point is attracted by the total mass.");
+	}
+
+	{
+		// not a multiple of the tile size
+		const Bodies bodies(1001, 3u);
+		const std::vector<dvec3> reference = bodies.reference();
+		std::vector<vec3> accelerations(bodies.positions.size());
+
+		math::DirectSum<float> vectorized;
+		vectorized.build(bodies.positions, bodies.masses);
+		vectorized.computeAccelerations(accelerations);
+		EXPECT(vectorized.size() == 1001 && relativeError(accelerations, reference) < 1e-5, "Vectorized direct sum.");
+
+		math::DirectSum<float> scalar(0.f, false);
+		scalar.build(bodies.positions, bodies.masses);
+		scalar.computeAccelerations(accelerations);
+		EXPECT(relativeError(accelerations, reference) < 1e-5, "Scalar direct sum.");
+
+		std::vector<dvec3> positions(bodies.positions.begin(), bodies.positions.end());
+		std::vector<double> masses(bodies.masses.begin(), bodies.masses.end());
+		std::vector<dvec3> doubleAccelerations(positions.size());
+		math::DirectSum<double> doubleSum;
+		doubleSum.build(positions, masses);
+		doubleSum.computeAccelerations(doubleAccelerations);
+		double maxError = 0.0;
+		for (size_t i = 0; i < reference.size(); ++i)
+			maxError = std::max(maxError, glm::length(doubleAccelerations[i] - reference[i]) / glm::length(reference[i]));
+		EXPECT(maxError < 1e-12, "Direct sum in double precision.");
+
+		utils::ThreadPool threadPool(3);
+		std::vector<vec3> parallel(bodies.positions.size());
+		vectorized.computeAccelerations(parallel, threadPool);
+		vectorized.computeAccelerations(accelerations);
+		EXPECT(parallel == accelerations, "Parallel direct sum gives the same result.");
+	}
+
+	{
+		const std::vector<vec3> positions = { vec3(0.f), vec3(3.f, 0.f, 0.f) };
+		const std::vector<float> masses = { 1.f, 2.f };
+		std::vector<vec3> accelerations(2);
+		math::DirectSum<float> directSum(4.f);
+		directSum.build(positions, masses);
+		directSum.computeAccelerations(accelerations);
+		// distance with softening is 5
+		EXPECT(std::abs(accelerations[0].x - 2.f * 3.f / 125.f) < 1e-6f && std::abs(accelerations[1].x + 3.f / 125.f) < 1e-6f,
+			"Softening of the direct sum.");
+		math::BarnesHut<float> tree(0.5f, 4.f);
+		tree.build(positions, masses);
+		tree.computeAccelerations(accelerations);
+		EXPECT(std::abs(accelerations[0].x - 2.f * 3.f / 125.f) < 1e-6f, "Softening of Barnes-Hut.");
+	}
+
+	{
+		// all bodies at the same position
+		const std::vector<vec3> positions(100, vec3(1.f));
+		const std::vector<float> masses(100, 1.f);
+		math::BarnesHut<float> tree(0.5f, 0.1f);
+		tree.build(positions, masses);
+		std::vector<vec3> accelerations(positions.size());
+		tree.computeAccelerations(accelerations);
+		bool allZero = true;
+		for (const vec3& a : accelerations)
+			allZero &= a == vec3(0.f);
+		EXPECT(allZero, "Coincident bodies.");
+	}
+
+	{
+		// The Barnes-Hut mode of the OrbitalSystem against the pairwise reference.
+		entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+		const Bodies bodies(300, 5u);
+		std::vector<entity::EntityReference *> entities;
+		for (size_t i = 0; i < bodies.positions.size(); ++i)
+		{
+			entities.push_back(registry.createEntity(
+				components::Transform(bodies.positions[i], glm::quat(vec3(0.f)), vec3(1.f)),
+				components::Velocity(vec3(0.f)),
+				components::OrbitalObject(bodies.masses[i])));
+		}
+
+		auto velocities = [&]()
+		{
+			std::vector<dvec3> result;
+			for (entity::EntityReference *entity : entities)
+			{
+				result.emplace_back(registry.getComponentData<components::Velocity>(entity).value().velocity);
+				registry.addOrSetComponent(entity, components::Velocity(vec3(0.f)));
+			}
+			return result;
+		};
+
+		components::OrbitalSystem(registry, 1.0, 1.0, components::GravitySolver::Pairwise).execute();
+		const std::vector<dvec3> pairwise = velocities();
+		components::OrbitalSystem(registry, 1.0, 1.0, components::GravitySolver::BarnesHut, 0.5f).execute();
+		const std::vector<dvec3> barnesHut = velocities();
+
+		components::OrbitalSystem(registry, 1.0, 1.0, components::GravitySolver::DirectSum).execute();
+		const std::vector<dvec3> directSum = velocities();
+
+		std::vector<vec3> barnesHutFloat(barnesHut.begin(), barnesHut.end());
+		EXPECT(relativeError(barnesHutFloat, pairwise) < 1e-2, "OrbitalSystem with Barnes-Hut matches the pairwise solver.");
+		std::vector<vec3> directSumFloat(directSum.begin(), directSum.end());
+		EXPECT(relativeError(directSumFloat, pairwise) < 1e-4, "OrbitalSystem with the direct sum matches the pairwise solver.");
+
+		for (entity::EntityReference *entity : entities)
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	return testsFailed;
+}
@@ -0,0 +1,60 @@
+#include "testutils.hpp"
+
+#include <engine/utils/containers/hierarchicalbitset.hpp>
+#include <vector>
+#include <set>
+#include <random>
+
+int main()
+{
+	utils::HierarchicalBitSet a;
+	EXPECT(a.empty() && !a.test(5), "Construct an empty set.");
+
+	a.set(5);
+	a.set(100000);
+	EXPECT(a.test(5) && a.test(100000) && !a.test(6) && !a.empty(), "Set single bits.");
+	a.reset(5);
+	a.reset(200000);
+	EXPECT(!a.test(5) && a.test(100000), "Reset single bits.");
+
+	std::vector<uint32_t> visited;
+	a.forEach([&](uint32_t _i) { visited.push_back(_i); });
+	EXPECT(visited.size() == 1 && visited[0] == 100000, "Iterate a sparse set.");
+	a.clear();
+	EXPECT(a.empty(), "Clear the set.");
+
+	utils::HierarchicalBitSet b, c, excluded;
+	std::set<uint32_t> setA, setB, setC, setExcluded;
+	std::mt19937 gen(7);
+	for (int i = 0; i < 20000; ++i)
+	{
+		const uint32_t idx = gen() % 50000;
+		switch (gen() % 4)
+		{
+		case 0: a.set(idx); setA.insert(idx); break;
+		case 1: b.set(idx); setB.insert(idx); break;
+		case 2: c.set(idx); setC.insert(idx); break;
+		case 3: excluded.set(idx); setExcluded.insert(idx); break;
+		}
+		// Dense ranges in all sets and long empty ranges in between.
+		if (idx < 8000 || (idx > 30000 && idx < 31000))
+		{
+			a.set(idx); setA.insert(idx);
+			b.set(idx); setB.insert(idx);
+			c.set(idx); setC.insert(idx);
+		}
+	}
+
+	std::vector<uint32_t> expected;
+	for (uint32_t idx : setA)
+		if (setB.contains(idx) && setC.contains(idx) && !setExcluded.contains(idx))
+			expected.push_back(idx);
+
+	visited.clear();
+	const utils::HierarchicalBitSet* include[] = { &a, &b, &c };
+	const utils::HierarchicalBitSet* exclude[] = { &excluded };
+	utils::HierarchicalBitSet::forEachIntersection(include, exclude, [&](uint32_t _i) { visited.push_back(_i); });
+	EXPECT(visited == expected, "Iterate the intersection of multiple sets in order.");
+
+	return testsFailed;
+}
@@ -0,0 +1,124 @@
+#include "testutils.hpp"
+
+#include <engine/math/integrator.hpp>
+#include <engine/components/OrbitalObject.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <span>
+#include <cmath>
+
+using dvec3 = glm::dvec3;
+
+// Unit mass at the origin.
+static void gravity(std::span<const dvec3> _x, std::span<const dvec3>, std::span<dvec3> _a)
+{
+	for (size_t i = 0; i < _x.size(); ++i)
+	{
+		const double dist = glm::length(_x[i]);
+		_a[i] = -_x[i] / (dist * dist * dist);
+	}
+}
+
+static double energy(const dvec3& _x, const dvec3& _v)
+{
+	return 0.5 * glm::dot(_v, _v) - 1.0 / glm::length(_x);
+}
+
+// Largest relative energy error of a circular orbit over 100 periods.
+static double orbitEnergyError(math::Integrator _integrator, double _dt)
+{
+	std::vector<dvec3> x = { dvec3(1.0, 0.0, 0.0) };
+	std::vector<dvec3> v = { dvec3(0.0, 1.0, 0.0) };
+	const double e0 = energy(x[0], v[0]);
+	double maxError = 0.0;
+	const int steps = static_cast<int>(100.0 * 2.0 * 3.14159265358979 / _dt);
+	for (int i = 0; i < steps; ++i)
+	{
+		math::integrate(_integrator, std::span<dvec3>(x), std::span<dvec3>(v), _dt, gravity);
+		maxError = std::max(maxError, std::abs((energy(x[0], v[0]) - e0) / e0));
+	}
+	return maxError;
+}
+
+int main()
+{
+	{
+		const double dt = 0.05;
+		const double euler = orbitEnergyError(math::Integrator::SemiImplicitEuler, dt);
+		const double verlet = orbitEnergyError(math::Integrator::VelocityVerlet, dt);
+		const double leapfrog = orbitEnergyError(math::Integrator::Leapfrog, dt);
+		EXPECT(euler < 0.1, "Semi-implicit Euler keeps the energy bounded.");
+		EXPECT(verlet < 1e-3 && verlet < euler, "Velocity Verlet keeps the energy bounded.");
+		EXPECT(leapfrog < 1e-3 && leapfrog < euler, "Leapfrog keeps the energy bounded.");
+	}
+
+	{
+		// one period with RK4 returns to the start
+		std::vector<dvec3> x = { dvec3(1.0, 0.0, 0.0) };
+		std::vector<dvec3> v = { dvec3(0.0, 1.0, 0.0) };
+		const int steps = 200;
+		const double dt = 2.0 * 3.14159265358979 / steps;
+		for (int i = 0; i < steps; ++i)
+			math::integrate(math::Integrator::RK4, std::span<dvec3>(x), std::span<dvec3>(v), dt, gravity);
+		EXPECT(glm::length(x[0] - dvec3(1.0, 0.0, 0.0)) < 1e-5 && glm::length(v[0] - dvec3(0.0, 1.0, 0.0)) < 1e-5, "RK4 orbit.");
+	}
+
+	{
+		// drag depends on the velocity: v(t) = v0 * exp(-t)
+		std::vector<dvec3> x = { dvec3(0.0) };
+		std::vector<dvec3> v = { dvec3(1.0, 0.0, 0.0) };
+		auto drag = [](std::span<const dvec3>, std::span<const dvec3> _v, std::span<dvec3> _a)
+		{
+			for (size_t i = 0; i < _v.size(); ++i)
+				_a[i] = -_v[i];
+		};
+		for (int i = 0; i < 10; ++i)
+			math::integrate(math::Integrator::RK4, std::span<dvec3>(x), std::span<dvec3>(v), 0.1, drag);
+		EXPECT(std::abs(v[0].x - std::exp(-1.0)) < 1e-6 && std::abs(x[0].x - (1.0 - std::exp(-1.0))) < 1e-6, "RK4 with drag.");
+	}
+
+	{
+		// A planet on a circular orbit around a heavy sun and an asteroid without gravity.
+		entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+		const float radius = 10.f;
+		const double sunMass = 1e6;
+		const float speed = static_cast<float>(std::sqrt(components::OrbitalSystem::gravConstant * sunMass / radius));
+		entity::EntityReference *sun = registry.createEntity(
+			components::Transform(glm::vec3(0.f), glm::quat(glm::vec3(0.f)), glm::vec3(1.f)),
+			components::Velocity(glm::vec3(0.f)),
+			components::OrbitalObject(sunMass));
+		entity::EntityReference *planet = registry.createEntity(
+			components::Transform(glm::vec3(radius, 0.f, 0.f), glm::quat(glm::vec3(0.f)), glm::vec3(1.f)),
+			components::Velocity(glm::vec3(0.f, 0.f, speed)),
+			components::OrbitalObject(1.0));
+		entity::EntityReference *asteroid = registry.createEntity(
+			components::Transform(glm::vec3(0.f), glm::quat(glm::vec3(0.f)), glm::vec3(1.f)),
+			components::Velocity(glm::vec3(1.f, 0.f, 0.f)));
+
+		const double deltaSeconds = 1.0 / 10.0;
+		const int ticks = 1000;
+		float minRadius = radius;
+		float maxRadius = radius;
+		for (int i = 0; i < ticks; ++i)
+		{
+			components::ApplyVelocitySystem(registry, deltaSeconds, deltaSeconds * deltaSeconds).executeExcluding<components::OrbitalObject>();
+			components::OrbitalSystem(registry, deltaSeconds, deltaSeconds * deltaSeconds).integrate(math::Integrator::Leapfrog);
+			const glm::vec3 toPlanet = registry.getComponentData<components::Transform>(planet).value().getPosition()
+				- registry.getComponentData<components::Transform>(sun).value().getPosition();
+			minRadius = std::min(minRadius, glm::length(toPlanet));
+			maxRadius = std::max(maxRadius, glm::length(toPlanet));
+		}
+		EXPECT(minRadius > 0.99f * radius && maxRadius < 1.01f * radius, "OrbitalSystem keeps a circular orbit with Leapfrog.");
+
+		const glm::vec3 asteroidPosition = registry.getComponentData<components::Transform>(asteroid).value().getPosition();
+		EXPECT(std::abs(asteroidPosition.x - static_cast<float>(ticks * deltaSeconds)) < 1e-2f, "Entities without OrbitalObject are moved by ApplyVelocitySystem.");
+
+		for (entity::EntityReference *entity : { sun, planet, asteroid })
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	return testsFailed;
+}
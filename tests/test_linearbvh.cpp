@@ -0,0 +1,135 @@
+#include "testutils.hpp"
+
+#include <engine/utils/containers/linearbvh.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using TreeT = utils::LinearBVH<int, 3, float>;
+
+std::vector<TreeT::AABB> createBoxes(int _numBoxes, float _worldSize)
+{
+	std::default_random_engine rng(8712u);
+	std::uniform_real_distribution<float> position(-_worldSize, _worldSize);
+	std::uniform_real_distribution<float> radius(0.1f, 2.f);
+
+	std::vector<TreeT::AABB> boxes;
+	for (int i = 0; i < _numBoxes; ++i)
+	{
+		const glm::vec3 center(position(rng), position(rng), position(rng));
+		const glm::vec3 extent(radius(rng));
+		boxes.push_back({ center - extent, center + extent });
+	}
+	return boxes;
+}
+
+std::vector<int> bruteForce(const std::vector<TreeT::AABB>& _boxes, const TreeT::AABB& _query)
+{
+	std::vector<int> hits;
+	for (int i = 0; i < static_cast<int>(_boxes.size()); ++i)
+		if (_query.intersect(_boxes[i])) hits.push_back(i);
+	return hits;
+}
+
+bool queriesMatch(const TreeT& _tree, const std::vector<TreeT::AABB>& _boxes)
+{
+	bool match = true;
+	for (size_t i = 0; i < _boxes.size(); i += 7)
+	{
+		TreeT::AABBQuery query(_boxes[i]);
+		_tree.traverse(query);
+		std::vector<int> hits(query.hits.begin(), query.hits.end());
+		std::sort(hits.begin(), hits.end());
+		match &= hits == bruteForce(_boxes, _boxes[i]);
+	}
+	return match;
+}
+
+int main()
+{
+	utils::ThreadPool singleThread(1);
+	utils::ThreadPool multiThread(4);
+
+	TreeT tree;
+	TreeT::AABBQuery emptyQuery(TreeT::AABB(glm::vec3(-1.f), glm::vec3(1.f)));
+	tree.traverse(emptyQuery);
+	EXPECT(tree.empty() && emptyQuery.hits.empty(), "Query an empty tree.");
+
+	std::vector<TreeT::AABB> boxes = createBoxes(1, 10.f);
+	std::vector<int> elements = { 0 };
+	tree.build(boxes, elements, singleThread);
+	TreeT::AABBQuery singleQuery(boxes[0]);
+	tree.traverse(singleQuery);
+	EXPECT(singleQuery.hits.size() == 1 && tree.getRootAABB() == boxes[0], "Build with a single element.");
+
+	boxes = createBoxes(5000, 40.f);
+	elements.resize(boxes.size());
+	for (int i = 0; i < static_cast<int>(elements.size()); ++i)
+		elements[i] = i;
+
+	tree.build(boxes, elements, singleThread);
+	EXPECT(tree.size() == boxes.size() && queriesMatch(tree, boxes), "Single threaded build returns the same hits as brute force.");
+
+	TreeT parallelTree;
+	parallelTree.build(boxes, elements, multiThread);
+	bool sameOrder = true;
+	for (size_t i = 0; i < boxes.size(); i += 13)
+	{
+		TreeT::AABBQuery q0(boxes[i]);
+		TreeT::AABBQuery q1(boxes[i]);
+		tree.traverse(q0);
+		parallelTree.traverse(q1);
+		sameOrder &= q0.hits == q1.hits;
+	}
+	EXPECT(sameOrder, "Parallel build creates the same tree as a single thread.");
+
+	bool containsAll = true;
+	const TreeT::AABB& root = parallelTree.getRootAABB();
+	for (const TreeT::AABB& box : boxes)
+		containsAll &= glm::min(root.min, box.min) == root.min && glm::max(root.max, box.max) == root.max;
+	EXPECT(containsAll, "Root bounds contain all elements.");
+
+	// all centers identical
+	std::vector<TreeT::AABB> sameBoxes(300, TreeT::AABB(glm::vec3(0.f), glm::vec3(1.f)));
+	std::vector<int> sameElements(sameBoxes.size(), 1);
+	tree.build(sameBoxes, sameElements, multiThread);
+	TreeT::AABBQuery sameQuery(TreeT::AABB(glm::vec3(0.5f), glm::vec3(2.f)));
+	tree.traverse(sameQuery);
+	EXPECT(sameQuery.hits.size() == sameBoxes.size(), "Build with identical Morton codes.");
+
+	// rebuild reuses the tree
+	boxes = createBoxes(2000, 10.f);
+	elements.resize(boxes.size());
+	tree.build(boxes, elements, multiThread);
+	EXPECT(tree.size() == boxes.size() && queriesMatch(tree, boxes), "Rebuild with fewer elements.");
+
+	tree.clear();
+	EXPECT(tree.empty(), "Clear the tree.");
+
+	{
+		// In 2D each axis is quantized to 32 bits. The box at the max corner has to get the
+		// largest coordinate that still fits.
+		using Tree2D = utils::LinearBVH<int, 2, float>;
+		std::vector<Tree2D::AABB> boxes2D;
+		std::vector<int> elements2D;
+		for (int i = 0; i < 64; ++i)
+		{
+			const glm::vec2 center(static_cast<float>(i % 8), static_cast<float>(i / 8));
+			boxes2D.push_back({ center - glm::vec2(0.25f), center + glm::vec2(0.25f) });
+			elements2D.push_back(i);
+		}
+		Tree2D tree2D;
+		tree2D.build(boxes2D, elements2D, singleThread);
+		bool match = true;
+		for (int i = 0; i < 64; ++i)
+		{
+			Tree2D::AABBQuery query(boxes2D[i]);
+			tree2D.traverse(query);
+			match &= query.hits.size() == 1 && query.hits[0] == i;
+		}
+		EXPECT(match, "2D build with a box exactly on the bounds max.");
+	}
+
+	return testsFailed;
+}
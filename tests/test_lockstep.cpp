@@ -0,0 +1,118 @@
+#include "testutils.hpp"
+
+#include <engine/utils/random.hpp>
+#include <engine/components/statehash.h>
+#include <engine/components/velocity.h>
+#include <engine/components/RotationalVelocity.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+using vec3 = glm::vec3;
+
+// Spawns and removes bodies with random values and returns the state hash of each tick.
+static std::vector<uint64_t> simulate(uint64_t _seed)
+{
+	entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+	utils::Random random(_seed);
+	std::vector<entity::EntityReference *> bodies;
+	std::vector<uint64_t> hashes;
+	const double deltaSeconds = 1.0 / 30.0;
+	for (int tick = 0; tick < 100; ++tick)
+	{
+		if (tick % 3 == 0)
+		{
+			bodies.push_back(registry.createEntity(
+				components::Transform(vec3(random.uniformFloat(-5.f, 5.f), 0.f, 0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+				components::Velocity(vec3(random.uniformFloat(-1.f, 1.f), random.uniformFloat(-1.f, 1.f), 0.f)),
+				components::RotationalVelocity(vec3(0.f, random.uniformFloat(-1.f, 1.f), 0.f))));
+		}
+		if (tick % 7 == 0 && bodies.size() > 2)
+		{
+			const int index = random.uniformInt(0, static_cast<int>(bodies.size()) - 1);
+			registry.eraseEntity(bodies[index]);
+			delete bodies[index];
+			bodies.erase(bodies.begin() + index);
+		}
+		components::ApplyVelocitySystem(registry, deltaSeconds, deltaSeconds * deltaSeconds).execute();
+		components::ApplyRotationalVelocitySystem(registry, deltaSeconds, deltaSeconds * deltaSeconds).execute();
+		hashes.push_back(components::StateHashSystem(registry).execute());
+	}
+	for (entity::EntityReference *body : bodies)
+	{
+		registry.eraseEntity(body);
+		delete body;
+	}
+	return hashes;
+}
+
+int main()
+{
+	{
+		utils::Random a(42);
+		utils::Random b(42);
+		utils::Random c(43);
+		bool equal = true;
+		bool different = false;
+		for (int i = 0; i < 100; ++i)
+		{
+			const uint64_t value = a();
+			equal &= value == b();
+			different |= value != c();
+		}
+		EXPECT(equal && different, "Sequences only depend on the seed.");
+
+		// reference values of xoshiro256** with SplitMix64 seeding, the same on every platform
+		utils::Random reference(0);
+		EXPECT(reference() == 0x99ec5f36cb75f2b4ull && reference() == 0xbf6e1f784956452aull, "Reference sequence.");
+
+		bool inRange = true;
+		int histogram[5] = {};
+		for (int i = 0; i < 10000; ++i)
+		{
+			const int value = a.uniformInt(-2, 2);
+			const float f = a.uniformFloat(0.5f, 1.5f);
+			inRange &= value >= -2 && value <= 2 && f >= 0.5f && f < 1.5f;
+			if (value >= -2 && value <= 2) ++histogram[value + 2];
+		}
+		bool uniform = true;
+		for (int count : histogram)
+			uniform &= count > 1800 && count < 2200;
+		EXPECT(inRange && uniform, "Uniform distributions.");
+	}
+
+	{
+		entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+		registry.setStableOrder(true);
+		std::vector<entity::EntityReference *> entities;
+		for (int i = 0; i < 6; ++i)
+			entities.push_back(registry.createEntity(components::Velocity(vec3(static_cast<float>(i)))));
+		registry.addOrSetComponent(entities[4], components::RotationalVelocity(vec3(4.f)));
+		registry.eraseEntity(entities[1]);
+		delete entities[1];
+		entities.erase(entities.begin() + 1);
+
+		std::vector<float> order;
+		registry.execute([&](components::Velocity velocity) { order.push_back(velocity.velocity.x); });
+		EXPECT((order == std::vector<float>{ 0.f, 2.f, 3.f, 4.f, 5.f }), "Stable order is the order of creation.");
+		std::vector<float> rotating;
+		registry.execute([&](components::RotationalVelocity velocity) { rotating.push_back(velocity.eulerAngleVelocity.x); });
+		EXPECT(rotating.size() == 1 && rotating[0] == 4.f
+			&& registry.getComponentData<components::Velocity>(entities[3]).value().velocity.x == 4.f, "Shifted entities keep their components.");
+
+		for (entity::EntityReference *entity : entities)
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	{
+		const std::vector<uint64_t> a = simulate(7);
+		const std::vector<uint64_t> b = simulate(7);
+		const std::vector<uint64_t> c = simulate(8);
+		EXPECT(a == b, "Runs with the same seed have the same state hashes.");
+		EXPECT(a != c && a.back() != c.back(), "A different seed diverges.");
+	}
+
+	return testsFailed;
+}
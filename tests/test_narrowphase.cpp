@@ -0,0 +1,164 @@
+#include "testutils.hpp"
+
+#include <engine/math/narrowphase.hpp>
+#include <engine/math/intersection.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory_resource>
+#include <random>
+#include <cmath>
+
+using Sphere = math::HyperSphere<3, float>;
+using Capsule = math::Capsule<3, float>;
+using OBB = math::OrientedBox<float>;
+using Contact = math::Contact<3, float>;
+
+static bool near(float _a, float _b, float _eps = 1e-4f)
+{
+	return std::abs(_a - _b) <= _eps;
+}
+
+static bool near(const glm::vec3& _a, const glm::vec3& _b, float _eps = 1e-4f)
+{
+	return glm::length(_a - _b) <= _eps;
+}
+
+static glm::mat3 rotation(float _angle)
+{
+	// rotation around the z axis
+	glm::mat3 rot(1.f);
+	rot[0] = glm::vec3(std::cos(_angle), std::sin(_angle), 0.f);
+	rot[1] = glm::vec3(-std::sin(_angle), std::cos(_angle), 0.f);
+	return rot;
+}
+
+// Moving b along the normal by the depth must separate (or just touch) the shapes.
+template<typename ShapeA, typename ShapeB, typename MoveFn>
+bool separatesAlongNormal(const ShapeA& _a, ShapeB _b, MoveFn _move)
+{
+	const auto contact = math::collide(_a, _b);
+	if (!contact) return true;
+	_move(_b, contact->normal * (contact->depth + 1e-3f));
+	return !math::collide(_a, _b);
+}
+
+int main()
+{
+	{
+		const auto contact = math::collide(Sphere(glm::vec3(0.f), 1.f), Sphere(glm::vec3(1.5f, 0.f, 0.f), 1.f));
+		EXPECT(contact && near(contact->normal, glm::vec3(1.f, 0.f, 0.f)) && near(contact->depth, 0.5f)
+			&& near(contact->point, glm::vec3(0.75f, 0.f, 0.f)), "Sphere vs sphere contact.");
+		EXPECT(!math::collide(Sphere(glm::vec3(0.f), 1.f), Sphere(glm::vec3(2.1f, 0.f, 0.f), 1.f)), "Separated spheres.");
+		const auto concentric = math::collide(Sphere(glm::vec3(1.f), 1.f), Sphere(glm::vec3(1.f), 0.5f));
+		EXPECT(concentric && near(glm::length(concentric->normal), 1.f) && near(concentric->depth, 1.5f), "Concentric spheres.");
+	}
+
+	{
+		const OBB box(glm::vec3(0.f), glm::vec3(1.f, 2.f, 3.f), glm::mat3(1.f));
+		const auto outside = math::collide(Sphere(glm::vec3(1.5f, 0.f, 0.f), 1.f), box);
+		EXPECT(outside && near(outside->normal, glm::vec3(-1.f, 0.f, 0.f)) && near(outside->depth, 0.5f)
+			&& near(outside->point, glm::vec3(0.75f, 0.f, 0.f)), "Sphere vs box with the center outside.");
+		const auto inside = math::collide(Sphere(glm::vec3(0.8f, 0.f, 0.f), 0.5f), box);
+		EXPECT(inside && near(inside->normal, glm::vec3(-1.f, 0.f, 0.f)) && near(inside->depth, 0.7f),
+			"Sphere vs box with the center inside.");
+		const auto flipped = math::collide(box, Sphere(glm::vec3(1.5f, 0.f, 0.f), 1.f));
+		EXPECT(flipped && near(flipped->normal, glm::vec3(1.f, 0.f, 0.f)), "Box vs sphere flips the normal.");
+
+		const OBB rotated(glm::vec3(0.f), glm::vec3(1.f), rotation(glm::radians(45.f)));
+		EXPECT(!math::collide(Sphere(glm::vec3(1.5f, 1.5f, 0.f), 0.5f), rotated)
+			&& math::collide(Sphere(glm::vec3(1.9f, 0.f, 0.f), 0.5f), rotated), "Sphere vs rotated box.");
+	}
+
+	{
+		const Capsule capsule(glm::vec3(-2.f, 0.f, 0.f), glm::vec3(2.f, 0.f, 0.f), 0.5f);
+		const auto sphere = math::collide(capsule, Sphere(glm::vec3(1.f, 1.f, 0.f), 1.f));
+		EXPECT(sphere && near(sphere->normal, glm::vec3(0.f, 1.f, 0.f)) && near(sphere->depth, 0.5f), "Capsule vs sphere.");
+
+		const Capsule crossing(glm::vec3(0.f, -2.f, 0.8f), glm::vec3(0.f, 2.f, 0.8f), 0.5f);
+		const auto capsules = math::collide(capsule, crossing);
+		EXPECT(capsules && near(capsules->normal, glm::vec3(0.f, 0.f, 1.f)) && near(capsules->depth, 0.2f)
+			&& near(capsules->point, glm::vec3(0.f, 0.f, 0.4f)), "Crossing capsules.");
+		const Capsule parallel(glm::vec3(-1.f, 0.9f, 0.f), glm::vec3(5.f, 0.9f, 0.f), 0.5f);
+		const auto parallelContact = math::collide(capsule, parallel);
+		EXPECT(parallelContact && near(parallelContact->depth, 0.1f), "Parallel capsules.");
+
+		const OBB box(glm::vec3(0.f, -1.2f, 0.f), glm::vec3(3.f, 1.f, 1.f), glm::mat3(1.f));
+		const Capsule tilted(glm::vec3(-2.f, 0.f, 0.f), glm::vec3(2.f, -0.4f, 0.f), 0.1f);
+		const auto boxContact = math::collide(tilted, box);
+		EXPECT(boxContact && near(boxContact->normal, glm::vec3(0.f, -1.f, 0.f), 1e-3f) && near(boxContact->depth, 0.3f, 1e-3f),
+			"Capsule vs box contact at the deepest point of the segment.");
+		EXPECT(!math::collide(Capsule(glm::vec3(-3.f, 0.f, 0.f), glm::vec3(3.f, 0.f, 0.f), 0.1f), box), "Capsule above a box.");
+	}
+
+	{
+		const OBB a(glm::vec3(0.f), glm::vec3(1.f), glm::mat3(1.f));
+		const auto face = math::collide(a, OBB(glm::vec3(1.8f, 0.f, 0.f), glm::vec3(1.f), glm::mat3(1.f)));
+		EXPECT(face && near(face->normal, glm::vec3(1.f, 0.f, 0.f)) && near(face->depth, 0.2f)
+			&& near(face->point, glm::vec3(0.9f, 0.f, 0.f)), "Face contact of stacked boxes.");
+
+		// a box standing on one of its edges
+		const OBB diamond(glm::vec3(0.f, 2.3f, 0.f), glm::vec3(1.f), rotation(glm::radians(45.f)));
+		const auto edge = math::collide(a, diamond);
+		EXPECT(edge && near(edge->normal, glm::vec3(0.f, 1.f, 0.f)) && near(edge->depth, std::sqrt(2.f) - 1.3f)
+			&& near(edge->point.y, 1.f - edge->depth * 0.5f), "Edge of a rotated box on a face.");
+
+		EXPECT(!math::collide(a, OBB(glm::vec3(0.f, 2.5f, 0.f), glm::vec3(1.f), rotation(glm::radians(45.f)))), "Separated by a face axis.");
+
+		// Crossing edges which are only separated by their cross product.
+		glm::mat3 rotY(1.f);
+		rotY[0] = glm::vec3(std::cos(0.7854f), 0.f, -std::sin(0.7854f));
+		rotY[2] = glm::vec3(std::sin(0.7854f), 0.f, std::cos(0.7854f));
+		const OBB edgeA(glm::vec3(0.f), glm::vec3(1.f), rotation(0.7854f));
+		const float touching = 2.f * std::sqrt(2.f);
+		EXPECT(!math::collide(edgeA, OBB(glm::vec3(touching + 0.05f, 0.f, 0.f), glm::vec3(1.f), rotY)), "Separated by an edge axis.");
+		const auto edges = math::collide(edgeA, OBB(glm::vec3(touching - 0.05f, 0.f, 0.f), glm::vec3(1.f), rotY));
+		EXPECT(edges && near(edges->normal, glm::vec3(1.f, 0.f, 0.f), 1e-3f) && near(edges->depth, 0.05f, 1e-3f)
+			&& near(edges->point, glm::vec3((touching - 0.05f) * 0.5f, 0.f, 0.f), 1e-3f), "Edge contact of crossing edges.");
+
+		std::default_random_engine rng(7u);
+		std::uniform_real_distribution<float> position(-2.f, 2.f);
+		std::uniform_real_distribution<float> angle(0.f, 6.28f);
+		std::uniform_real_distribution<float> size(0.2f, 1.f);
+		auto move = [](auto& _shape, const glm::vec3& _offset) { _shape.center += _offset; };
+		bool allSeparate = true;
+		for (int i = 0; i < 500; ++i)
+		{
+			const OBB boxA(glm::vec3(0.f), glm::vec3(size(rng), size(rng), size(rng)), rotation(angle(rng)));
+			glm::mat3 rot = rotation(angle(rng));
+			std::swap(rot[1], rot[2]);
+			rot[2] = -rot[2];
+			const OBB boxB(glm::vec3(position(rng), position(rng), position(rng)), glm::vec3(size(rng), size(rng), size(rng)), rot);
+			allSeparate &= separatesAlongNormal(boxA, boxB, move);
+			allSeparate &= separatesAlongNormal(boxA, Sphere(boxB.center, boxB.halfSize.x), move);
+			allSeparate &= separatesAlongNormal(Sphere(boxA.center, boxA.halfSize.x), Sphere(boxB.center, boxB.halfSize.x), move);
+		}
+		EXPECT(allSeparate, "Moving along the normal by the depth separates random shapes.");
+	}
+
+	{
+		const Sphere bullet(glm::vec3(0.f, 0.f, -2.f), 0.1f);
+		const Sphere target(glm::vec3(0.f, 0.5f, 0.f), 1.f);
+		const auto toi = math::sweep(bullet, glm::vec3(0.f, 0.f, 4.f), target);
+		const float expected = (2.f - std::sqrt(1.1f * 1.1f - 0.25f)) / 4.f;
+		EXPECT(toi && near(*toi, expected), "Time of impact of a sweeping sphere.");
+		EXPECT(!math::sweep(bullet, glm::vec3(0.f, 0.f, 1.f), target), "Sweep ends before the impact.");
+		EXPECT(!math::sweep(bullet, glm::vec3(0.f, 0.f, -4.f), target), "Sphere moves away.");
+		EXPECT(!math::sweep(bullet, glm::vec3(0.f, 8.f, 4.f), target), "Sweep misses.");
+		EXPECT(math::sweep(Sphere(glm::vec3(0.f), 0.1f), glm::vec3(0.f), target) == 0.f, "Overlap at the start.");
+	}
+
+	{
+		std::vector<Sphere> spheres = { Sphere(glm::vec3(0.f), 1.f), Sphere(glm::vec3(1.f, 0.f, 0.f), 1.f), Sphere(glm::vec3(5.f), 1.f) };
+		std::vector<OBB> boxes = { OBB(glm::vec3(0.f, 1.5f, 0.f), glm::vec3(1.f), glm::mat3(1.f)) };
+		const std::vector<std::pair<uint32_t, uint32_t>> spherePairs = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+		const std::vector<std::pair<uint32_t, uint32_t>> boxPairs = { { 2, 0 }, { 1, 0 } };
+
+		std::pmr::vector<Contact> contacts;
+		math::collidePairs(spheres, spheres, spherePairs, contacts);
+		math::collidePairs(spheres, boxes, boxPairs, contacts);
+		EXPECT(contacts.size() == 2 && contacts[0].pair == 0 && contacts[1].pair == 1
+			&& near(contacts[1].normal, glm::vec3(0.f, 1.f, 0.f)), "Batched pairs write to one contact buffer.");
+	}
+
+	return testsFailed;
+}
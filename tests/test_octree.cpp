@@ -1,6 +1,9 @@
 #include "testutils.hpp"
 #include <engine/utils/containers/octree.hpp>
 #include <glm/glm.hpp>
+#include <random>
+#include <algorithm>
+#include <cmath>
 
 using namespace glm;
 
@@ -124,10 +127,223 @@ void testOctree3D()
 
 }
 
+void testLooseOctree()
+{
+	using TreeT = utils::SparseOctree<int, 3, float>;
+
+	TreeT tree(16.f, 0.5f);
+	Processor<TreeT> proc;
+
+	TreeT::AABB box(vec3(1.f), vec3(1.5f));
+	tree.insert(box, 1);
+	tree.insert({ vec3(9.f), vec3(10.f) }, 2);
+	tree.traverse(proc);
+	const int descends = proc.descends;
+
+	// Small movements within the loose bounds keep the structure.
+	TreeT::AABB moved(vec3(1.2f), vec3(1.7f));
+	EXPECT(tree.update(box, moved, 1), "Update an existing element.");
+	proc.reset();
+	tree.traverse(proc);
+	EXPECT(proc.descends == descends && std::find(proc.found.begin(), proc.found.end(), std::make_pair(moved, 1)) != proc.found.end(),
+		"Small update keeps the node.");
+
+	// Large movements change the node.
+	TreeT::AABB far(vec3(-40.f), vec3(-39.f));
+	EXPECT(tree.update(moved, far, 1), "Move an element outside of the root.");
+	TreeT::AABBQuery query(TreeT::AABB(vec3(-41.f), vec3(-38.f)));
+	tree.traverse(query);
+	EXPECT(query.hits.size() == 1 && query.hits[0] == 1, "Find the moved element.");
+	EXPECT(tree.remove(far, 1) && !tree.remove(far, 1), "Remove the moved element.");
+}
+
+void testBatchQuery(float _looseness)
+{
+	using TreeT = utils::SparseOctree<int, 3, float>;
+
+	std::default_random_engine rng(321u);
+	std::uniform_real_distribution<float> position(-20.f, 20.f);
+	std::uniform_real_distribution<float> size(0.1f, 3.f);
+	auto randomBox = [&]()
+	{
+		const vec3 min(position(rng), position(rng), position(rng));
+		return TreeT::AABB(min, min + vec3(size(rng), size(rng), size(rng)));
+	};
+
+	TreeT tree(1.f, _looseness);
+	for (int i = 0; i < 2000; ++i)
+		tree.insert(randomBox(), i);
+
+	std::vector<TreeT::AABB> queries;
+	for (int i = 0; i < 300; ++i)
+		queries.push_back(randomBox());
+
+	std::vector<std::vector<int>> batchHits(queries.size());
+	tree.traverseBatch(queries, [&](size_t _query, const TreeT::AABB&, int _el) { batchHits[_query].push_back(_el); });
+
+	bool allMatch = true;
+	for (size_t i = 0; i < queries.size(); ++i)
+	{
+		TreeT::AABBQuery query(queries[i]);
+		tree.traverse(query);
+		std::vector<int> hits(query.hits.begin(), query.hits.end());
+		std::sort(hits.begin(), hits.end());
+		std::sort(batchHits[i].begin(), batchHits[i].end());
+		allMatch &= hits == batchHits[i];
+	}
+	EXPECT(allMatch, "Batched queries find the same elements as single queries.");
+
+	int numCalls = 0;
+	tree.traverseBatch({}, [&](size_t, const TreeT::AABB&, int) { ++numCalls; });
+	EXPECT(numCalls == 0, "Batch without queries.");
+}
+
+void testRayAndNearest(float _looseness)
+{
+	using TreeT = utils::SparseOctree<int, 3, float>;
+
+	std::default_random_engine rng(777u);
+	std::uniform_real_distribution<float> position(-20.f, 20.f);
+	std::uniform_real_distribution<float> size(0.1f, 2.f);
+	std::uniform_real_distribution<float> direction(-1.f, 1.f);
+
+	TreeT tree(1.f, _looseness);
+	std::vector<TreeT::AABB> boxes;
+	for (int i = 0; i < 1000; ++i)
+	{
+		const vec3 min(position(rng), position(rng), position(rng));
+		boxes.emplace_back(min, min + vec3(size(rng), size(rng), size(rng)));
+		tree.insert(boxes.back(), i);
+	}
+
+	bool firstHitMatches = true;
+	bool allHitsMatch = true;
+	for (int r = 0; r < 100; ++r)
+	{
+		// some rays are parallel to an axis
+		vec3 dir(direction(rng), direction(rng), direction(rng));
+		if (r % 4 == 0) dir = vec3(0.f, 0.f, 1.f);
+		const math::Ray<3, float> ray(vec3(position(rng), position(rng), position(rng)), dir);
+
+		float closest = std::numeric_limits<float>::max();
+		std::vector<int> expected;
+		for (int i = 0; i < static_cast<int>(boxes.size()); ++i)
+		{
+			if (auto t = math::intersect(ray, boxes[i]))
+			{
+				closest = std::min(closest, *t);
+				expected.push_back(i);
+			}
+		}
+
+		const auto hit = tree.rayCast(ray);
+		firstHitMatches &= expected.empty() ? !hit : (hit && hit->distance == closest && *math::intersect(ray, boxes[hit->element]) == closest);
+
+		TreeT::RayQuery query(ray);
+		tree.traverse(query);
+		std::vector<int> found;
+		for (const TreeT::Hit& h : query.hits)
+			found.push_back(h.element);
+		std::sort(found.begin(), found.end());
+		allHitsMatch &= found == expected;
+	}
+	EXPECT(firstHitMatches, "Ray cast finds the closest box.");
+	EXPECT(allHitsMatch, "Ray query finds all boxes on the ray.");
+
+	bool nearestMatches = true;
+	bool radiusMatches = true;
+	std::pmr::vector<TreeT::Hit> nearest;
+	for (int q = 0; q < 50; ++q)
+	{
+		const vec3 point(position(rng), position(rng), position(rng));
+		std::vector<float> distances;
+		for (const TreeT::AABB& box : boxes)
+			distances.push_back(std::sqrt(math::distanceSq<3, float>(point, box)));
+		std::vector<float> sorted = distances;
+		std::sort(sorted.begin(), sorted.end());
+
+		tree.nearest(point, 5, nearest);
+		bool match = nearest.size() == 5;
+		for (size_t i = 0; match && i < nearest.size(); ++i)
+			match &= nearest[i].distance == sorted[i] && distances[nearest[i].element] == sorted[i];
+		nearestMatches &= match;
+
+		TreeT::RadiusQuery query(point, 3.f);
+		tree.traverse(query);
+		const size_t expected = std::count_if(distances.begin(), distances.end(), [](float d) { return d * d <= 9.f; });
+		radiusMatches &= query.hits.size() == expected;
+	}
+	EXPECT(nearestMatches, "Nearest neighbours are sorted and match brute force.");
+	EXPECT(radiusMatches, "Radius query finds all boxes in range.");
+
+	tree.nearest(vec3(0.f), 5, nearest, 0.01f);
+	EXPECT(nearest.size() <= 1, "Nearest neighbours are limited by the maximum distance.");
+}
+
+void testSweep(float _looseness)
+{
+	using TreeT = utils::SparseOctree<int, 3, float>;
+
+	std::default_random_engine rng(4242u);
+	std::uniform_real_distribution<float> position(-20.f, 20.f);
+	std::uniform_real_distribution<float> size(0.05f, 0.5f);
+	std::uniform_real_distribution<float> displacement(-10.f, 10.f);
+
+	TreeT tree(1.f, _looseness);
+	std::vector<TreeT::AABB> boxes;
+	for (int i = 0; i < 2000; ++i)
+	{
+		const vec3 min(position(rng), position(rng), position(rng));
+		boxes.emplace_back(min, min + vec3(size(rng), size(rng), size(rng)));
+		tree.insert(boxes.back(), i);
+	}
+
+	bool allHitsMatch = true;
+	for (int q = 0; q < 100; ++q)
+	{
+		const vec3 min(position(rng), position(rng), position(rng));
+		const TreeT::AABB box(min, min + vec3(0.2f));
+		vec3 move(displacement(rng), displacement(rng), displacement(rng));
+		if (q % 4 == 0) move = vec3(0.f, move.y, 0.f);
+
+		std::vector<std::pair<int, float>> expected;
+		for (int i = 0; i < static_cast<int>(boxes.size()); ++i)
+			if (auto t = math::sweep(box, move, boxes[i])) expected.emplace_back(i, *t);
+
+		TreeT::SweepQuery query(box, move);
+		tree.traverse(query);
+		std::vector<std::pair<int, float>> found;
+		for (const TreeT::Hit& hit : query.hits)
+			found.emplace_back(hit.element, hit.distance);
+		std::sort(found.begin(), found.end());
+		allHitsMatch &= found == expected;
+	}
+	EXPECT(allHitsMatch, "Sweep query matches brute force.");
+
+	// A small fast box passes a thin wall between two ticks.
+	TreeT wallTree(1.f, _looseness);
+	wallTree.insert(TreeT::AABB(vec3(-5.f, -5.f, 0.f), vec3(5.f, 5.f, 0.1f)), 1);
+	const TreeT::AABB bullet(vec3(-0.05f, -0.05f, -2.05f), vec3(0.05f, 0.05f, -1.95f));
+	const vec3 move(0.f, 0.f, 4.f);
+	TreeT::AABBQuery endQuery(TreeT::AABB(bullet.min + move, bullet.max + move));
+	wallTree.traverse(endQuery);
+	TreeT::SweepQuery sweepQuery(bullet, move);
+	wallTree.traverse(sweepQuery);
+	EXPECT(endQuery.hits.empty() && sweepQuery.hits.size() == 1 && std::abs(sweepQuery.hits[0].distance - 1.95f / 4.f) < 1e-5f,
+		"Sweep query finds a tunneled hit with its time of impact.");
+}
+
 int main() 
 {
 	testOctree2D();
 	testOctree3D();
+	testLooseOctree();
+	testBatchQuery(0.f);
+	testBatchQuery(0.5f);
+	testRayAndNearest(0.f);
+	testRayAndNearest(0.5f);
+	testSweep(0.f);
+	testSweep(0.5f);
 
 	return testsFailed;
 }
@@ -0,0 +1,116 @@
+#include "testutils.hpp"
+
+#include <engine/math/particlepool.hpp>
+#include <engine/components/ParticleEmitter.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+
+using vec3 = glm::vec3;
+using vec4 = glm::vec4;
+
+// Particles with different lifetimes, so that some expire in every update.
+static std::vector<vec3> simulate(bool _vectorized)
+{
+	math::ParticlePool<float> pool(100, vec3(0.f, -9.81f, 0.f), _vectorized);
+	for (int i = 0; i < 100; ++i)
+		pool.emit(vec3(static_cast<float>(i), 0.f, 0.f), vec3(0.f, 10.f, static_cast<float>(i % 7)), 0.05f * static_cast<float>(i % 23 + 1));
+	std::vector<vec3> positions;
+	for (int tick = 0; tick < 10; ++tick)
+	{
+		pool.update(0.1f);
+		for (size_t i = 0; i < pool.size(); ++i)
+			positions.push_back(pool.position(i));
+	}
+	return positions;
+}
+
+int main()
+{
+	{
+		math::ParticlePool<float> pool(3);
+		EXPECT(pool.emit(vec3(0.f), vec3(1.f, 0.f, 0.f), 1.f, vec4(1.f, 0.f, 0.f, 1.f)), "Emit into an empty pool.");
+		EXPECT(pool.emit(vec3(1.f), vec3(0.f), 0.5f) && pool.emit(vec3(2.f), vec3(0.f), 2.f), "Emit up to the capacity.");
+		EXPECT(!pool.emit(vec3(3.f), vec3(0.f), 1.f) && pool.size() == 3, "A full pool rejects particles.");
+
+		pool.update(0.75f);
+		EXPECT(pool.size() == 2, "Expired particles are removed.");
+		EXPECT(pool.position(0) == vec3(0.75f, 0.f, 0.f) && pool.color(0) == vec4(1.f, 0.f, 0.f, 1.f), "Particles move with their velocity.");
+		EXPECT(pool.position(1) == vec3(2.f) && std::abs(pool.life(1) - 1.25f) < 1e-6f, "Remaining particles keep their order.");
+
+		pool.kill(0);
+		EXPECT(pool.size() == 2 && !pool.isAlive(0), "Killed particles stay until the next compact.");
+		pool.compact();
+		EXPECT(pool.size() == 1 && pool.position(0) == vec3(2.f), "Killed particles are removed.");
+	}
+
+	{
+		// free fall: x = 1/2 g t^2 up to the error of the semi-implicit Euler steps
+		math::ParticlePool<float> pool(1, vec3(0.f, -10.f, 0.f));
+		pool.emit(vec3(0.f), vec3(0.f), 10.f);
+		for (int i = 0; i < 100; ++i)
+			pool.update(0.01f);
+		EXPECT(std::abs(pool.position(0).y + 5.f) < 0.06f && std::abs(pool.velocity(0).y + 10.f) < 1e-4f, "Particles fall with gravity.");
+	}
+
+	{
+		const std::vector<vec3> vectorized = simulate(true);
+		const std::vector<vec3> scalar = simulate(false);
+		bool equal = vectorized.size() == scalar.size();
+		for (size_t i = 0; equal && i < vectorized.size(); ++i)
+			equal = glm::length(vectorized[i] - scalar[i]) < 1e-4f;
+		EXPECT(equal, "SIMD and scalar update give the same particles.");
+	}
+
+	{
+		// an emitter on a moving entity
+		entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+		math::ParticlePool<float> pool(1000);
+		math::ParticlePool<float> *const pools[] = { &pool };
+		entity::EntityReference *entity = registry.createEntity(
+			components::Transform(vec3(1.f, 2.f, 3.f), glm::quat(vec3(0.f, glm::radians(90.f), 0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.f, 5.f, 0.f)),
+			components::ParticleEmitter(&pool, 25.f, vec3(0.f, 0.f, 1.f), 2.f, 0.f, 1.f, vec4(1.f), vec3(0.f, 0.f, 1.f)));
+
+		components::ParticleSystem(registry, pools, 0.1).execute();
+		EXPECT(pool.size() == 2, "Emit the rate times the tick length.");
+		components::ParticleSystem(registry, pools, 0.1).execute();
+		EXPECT(pool.size() == 5, "Fractions of particles are carried over.");
+
+		// the last particle was emitted at the offset and moved for one tick
+		const vec3 position = pool.position(4);
+		const vec3 velocity = pool.velocity(4);
+		EXPECT(glm::length(position - vec3(2.2f, 2.5f, 3.f)) < 1e-5f, "Offset is rotated with the entity.");
+		EXPECT(glm::length(velocity - vec3(2.f, 5.f, 0.f)) < 1e-5f, "Direction is rotated and the entity velocity inherited.");
+
+		registry.eraseEntity(entity);
+		delete entity;
+	}
+
+	{
+		// the same seed emits the same particles
+		auto run = [](uint64_t _seed)
+		{
+			utils::Random::get().seed(_seed);
+			entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+			math::ParticlePool<float> pool(1000);
+			math::ParticlePool<float> *const pools[] = { &pool };
+			entity::EntityReference *entity = registry.createEntity(
+				components::Transform(vec3(0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+				components::ParticleEmitter(&pool, 100.f, vec3(0.f, 1.f, 0.f), 1.f, 0.5f, 0.5f, vec4(1.f)));
+			for (int i = 0; i < 20; ++i)
+				components::ParticleSystem(registry, pools, 1.0 / 30.0).execute();
+			std::vector<vec3> positions;
+			for (size_t i = 0; i < pool.size(); ++i)
+				positions.push_back(pool.position(i));
+			registry.eraseEntity(entity);
+			delete entity;
+			return positions;
+		};
+		const std::vector<vec3> a = run(42);
+		EXPECT(!a.empty() && a == run(42), "Emitters are deterministic.");
+		EXPECT(a != run(43), "Emitters use the random generator.");
+	}
+
+	return testsFailed;
+}
@@ -0,0 +1,174 @@
+#include "testutils.hpp"
+
+#include <engine/components/sleep.h>
+#include <engine/components/OrbitalObject.h>
+#include <glm/glm.hpp>
+
+using vec3 = glm::vec3;
+
+static vec3 position(entity::EntityRegistry& _registry, const entity::EntityReference* _entity)
+{
+	return _registry.getComponentData<components::Transform>(_entity).value().getPosition();
+}
+
+int main()
+{
+	entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+	const double deltaSeconds = 0.1;
+	const int ticksUntilSleep = 5;
+
+	auto tick = [&]()
+	{
+		components::SleepSystem(registry, deltaSeconds, 0.1f, 0.1f, ticksUntilSleep).execute();
+		components::ApplyVelocitySystem(registry, deltaSeconds, deltaSeconds * deltaSeconds).executeExcluding<components::Sleeping>();
+		components::ApplyRotationalVelocitySystem(registry, deltaSeconds, deltaSeconds * deltaSeconds).executeExcluding<components::Sleeping>();
+	};
+
+	{
+		entity::EntityReference *resting = registry.createEntity(
+			components::Transform(vec3(0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.05f, 0.f, 0.f)),
+			components::Sleepable());
+		entity::EntityReference *spinning = registry.createEntity(
+			components::Transform(vec3(0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.f)),
+			components::RotationalVelocity(vec3(0.f, 1.f, 0.f)),
+			components::Sleepable());
+		entity::EntityReference *notSleepable = registry.createEntity(
+			components::Transform(vec3(0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.f)));
+
+		for (int i = 0; i < ticksUntilSleep - 1; ++i)
+			tick();
+		EXPECT(!components::SleepSystem::isSleeping(registry, resting), "Awake until the resting ticks are reached.");
+		tick();
+		EXPECT(components::SleepSystem::isSleeping(registry, resting), "Slow body falls asleep.");
+		EXPECT(registry.getComponentData<components::Velocity>(resting).value().velocity == vec3(0.f), "The velocity of a sleeping body is zeroed.");
+		EXPECT(!components::SleepSystem::isSleeping(registry, spinning), "Rotating body stays awake.");
+		EXPECT(!components::SleepSystem::isSleeping(registry, notSleepable), "Only Sleepable bodies fall asleep.");
+
+		// sleeping bodies are skipped by the integration
+		const vec3 sleepPosition = position(registry, resting);
+		registry.addOrSetComponent(resting, components::Velocity(vec3(0.01f, 0.f, 0.f)));
+		tick();
+		EXPECT(components::SleepSystem::isSleeping(registry, resting) && position(registry, resting) == sleepPosition,
+			"Sleeping body is not moved.");
+
+		// an explicit write above the threshold wakes the body before the integration
+		registry.addOrSetComponent(resting, components::Velocity(vec3(1.f, 0.f, 0.f)));
+		tick();
+		EXPECT(!components::SleepSystem::isSleeping(registry, resting), "Writing the velocity wakes the body.");
+		EXPECT(std::abs(position(registry, resting).x - sleepPosition.x - 0.1f) < 1e-5f, "Woken body is moved in the same tick.");
+
+		// contacts wake bodies explicitly and restart the resting ticks
+		registry.addOrSetComponent(resting, components::Velocity(vec3(0.f)));
+		for (int i = 0; i < ticksUntilSleep; ++i)
+			tick();
+		EXPECT(components::SleepSystem::isSleeping(registry, resting), "Body falls asleep again.");
+		components::SleepSystem::wake(registry, resting);
+		EXPECT(!components::SleepSystem::isSleeping(registry, resting)
+			&& registry.getComponentData<components::Sleepable>(resting).value().ticksAtRest == 0, "wake() resets the resting ticks.");
+		tick();
+		EXPECT(!components::SleepSystem::isSleeping(registry, resting), "Woken body has to rest again before sleeping.");
+
+		for (entity::EntityReference *entity : { resting, spinning, notSleepable })
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	{
+		// a sleeping sun still attracts the planet, but is not moved itself
+		entity::EntityReference *sun = registry.createEntity(
+			components::Transform(vec3(0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.f)),
+			components::OrbitalObject(1e6),
+			components::Sleepable());
+		entity::EntityReference *planet = registry.createEntity(
+			components::Transform(vec3(10.f, 0.f, 0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.f)),
+			components::OrbitalObject(1e5));
+		for (int i = 0; i < ticksUntilSleep; ++i)
+			components::SleepSystem(registry, deltaSeconds, 0.1f, 0.1f, ticksUntilSleep).execute();
+		EXPECT(components::SleepSystem::isSleeping(registry, sun), "Sun falls asleep.");
+
+		components::OrbitalSystem(registry, deltaSeconds, deltaSeconds * deltaSeconds).integrate(math::Integrator::Leapfrog);
+		EXPECT(position(registry, sun) == vec3(0.f) && registry.getComponentData<components::Velocity>(sun).value().velocity == vec3(0.f),
+			"Sleeping sun is not integrated.");
+		EXPECT(registry.getComponentData<components::Velocity>(planet).value().velocity.x < 0.f, "Sleeping sun attracts the planet.");
+
+		for (entity::EntityReference *entity : { sun, planet })
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	{
+		// a body held in place against a strong pull does not fall asleep
+		entity::EntityReference *sun = registry.createEntity(
+			components::Transform(vec3(0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.f)),
+			components::OrbitalObject(1e7));
+		entity::EntityReference *supported = registry.createEntity(
+			components::Transform(vec3(10.f, 0.f, 0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.f)),
+			components::OrbitalObject(1.0),
+			components::Sleepable());
+		for (int i = 0; i < 2 * ticksUntilSleep; ++i)
+		{
+			components::SleepSystem(registry, deltaSeconds, 0.1f, 0.1f, ticksUntilSleep).execute();
+			components::OrbitalSystem(registry, deltaSeconds, deltaSeconds * deltaSeconds).integrate(math::Integrator::Leapfrog);
+			registry.addOrSetComponent(supported, components::Transform(vec3(10.f, 0.f, 0.f), glm::quat(vec3(0.f)), vec3(1.f)));
+			registry.addOrSetComponent(supported, components::Velocity(vec3(0.f)));
+		}
+		EXPECT(!components::SleepSystem::isSleeping(registry, supported), "Body under a strong acceleration stays awake.");
+
+		for (entity::EntityReference *entity : { sun, supported })
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	{
+		// a sleeping body is pulled awake once the attraction grows
+		entity::EntityReference *attractor = registry.createEntity(
+			components::Transform(vec3(0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.f)),
+			components::OrbitalObject(1e4));
+		entity::EntityReference *body = registry.createEntity(
+			components::Transform(vec3(10.f, 0.f, 0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::Velocity(vec3(0.f)),
+			components::OrbitalObject(1.0),
+			components::Sleepable());
+		auto orbitalTick = [&]()
+		{
+			components::SleepSystem(registry, deltaSeconds, 0.1f, 0.1f, ticksUntilSleep).execute();
+			components::OrbitalSystem(registry, deltaSeconds, deltaSeconds * deltaSeconds).integrate(math::Integrator::Leapfrog);
+		};
+		for (int i = 0; i < ticksUntilSleep; ++i)
+			orbitalTick();
+		EXPECT(components::SleepSystem::isSleeping(registry, body), "Weakly attracted body falls asleep.");
+		const vec3 sleepPosition = position(registry, body);
+		orbitalTick();
+		EXPECT(components::SleepSystem::isSleeping(registry, body) && position(registry, body) == sleepPosition,
+			"Sleeping body is not accelerated.");
+
+		registry.addOrSetComponent(attractor, components::OrbitalObject(1e7));
+		orbitalTick();
+		orbitalTick();
+		EXPECT(!components::SleepSystem::isSleeping(registry, body), "Strong attraction wakes the body.");
+		EXPECT(position(registry, body).x < sleepPosition.x && registry.getComponentData<components::Velocity>(body).value().velocity.x < 0.f,
+			"Woken body falls towards the attractor.");
+
+		for (entity::EntityReference *entity : { attractor, body })
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	return testsFailed;
+}
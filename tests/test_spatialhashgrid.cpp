@@ -0,0 +1,89 @@
+#include "testutils.hpp"
+
+#include <engine/utils/containers/spatialhashgrid.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+template<int Dim>
+bool queriesMatch(int _numBoxes, float _worldSize, float _maxBoxSize, float _cellSize)
+{
+	using GridT = utils::SpatialHashGrid<int, Dim, float>;
+	using VecT = typename GridT::VecT;
+
+	std::default_random_engine rng(99u);
+	std::uniform_real_distribution<float> position(-_worldSize, _worldSize);
+	std::uniform_real_distribution<float> size(0.f, _maxBoxSize);
+	auto randomBox = [&]()
+	{
+		VecT min, max;
+		for (int d = 0; d < Dim; ++d)
+		{
+			min[d] = position(rng);
+			max[d] = min[d] + size(rng);
+		}
+		return typename GridT::AABB(min, max);
+	};
+
+	std::vector<typename GridT::AABB> boxes;
+	std::vector<int> elements;
+	for (int i = 0; i < _numBoxes; ++i)
+	{
+		boxes.push_back(randomBox());
+		elements.push_back(i);
+	}
+
+	GridT grid(_cellSize > 0 ? _cellSize : GridT::suggestCellSize(boxes));
+	grid.build(boxes, elements);
+	bool match = grid.size() == boxes.size();
+	for (int q = 0; q < 200; ++q)
+	{
+		const typename GridT::AABB query = q < 100 ? boxes[q] : randomBox();
+		std::vector<int> expected;
+		for (int i = 0; i < _numBoxes; ++i)
+			if (query.intersect(boxes[i])) expected.push_back(i);
+
+		typename GridT::AABBQuery proc(query);
+		grid.traverse(proc);
+		std::vector<int> found(proc.hits.begin(), proc.hits.end());
+		std::sort(found.begin(), found.end());
+		match &= found == expected;
+
+		found.clear();
+		grid.query(query, [&](const typename GridT::AABB&, int _el) { found.push_back(_el); });
+		std::sort(found.begin(), found.end());
+		match &= found == expected;
+	}
+	return match;
+}
+
+int main()
+{
+	using GridT = utils::SpatialHashGrid<int, 3, float>;
+
+	GridT grid(2.f);
+	GridT::AABBQuery emptyQuery(GridT::AABB(glm::vec3(-1.f), glm::vec3(1.f)));
+	grid.traverse(emptyQuery);
+	EXPECT(grid.empty() && emptyQuery.hits.empty(), "Query an empty grid.");
+
+	EXPECT(queriesMatch<3>(3000, 30.f, 2.f, 0.f), "3D queries match brute force with the suggested cell size.");
+	EXPECT(queriesMatch<3>(3000, 30.f, 2.f, 0.3f), "3D queries match brute force with cells smaller than the boxes.");
+	EXPECT(queriesMatch<3>(500, 30.f, 2.f, 50.f), "3D queries match brute force with a single cell.");
+	EXPECT(queriesMatch<2>(2000, 100.f, 10.f, 0.f), "2D queries match brute force.");
+
+	std::vector<GridT::AABB> boxes = { { glm::vec3(0.f), glm::vec3(1.f) }, { glm::vec3(10.f), glm::vec3(13.f) } };
+	EXPECT(GridT::suggestCellSize(boxes) == 4.f, "Suggest twice the average extent as cell size.");
+
+	// Elements are only reported once, even if they span multiple cells.
+	std::vector<int> elements = { 1, 2 };
+	grid.build(boxes, elements);
+	GridT::AABBQuery all(GridT::AABB(glm::vec3(-100.f), glm::vec3(100.f)));
+	grid.traverse(all);
+	EXPECT(all.hits.size() == 2 && grid.numCells() == 2, "Each element is stored once.");
+
+	grid.clear();
+	EXPECT(grid.empty(), "Clear the grid.");
+
+	return testsFailed;
+}
@@ -0,0 +1,135 @@
+#include "testutils.hpp"
+
+#include <engine/math/springnetwork.hpp>
+#include <engine/components/SpringParticle.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+#include <cmath>
+
+using vec3 = glm::vec3;
+
+// Cloth hanging from two corners.
+static std::unique_ptr<math::SpringNetwork<float>> cloth(int _size, float _spacing)
+{
+	auto network = std::make_unique<math::SpringNetwork<float>>(vec3(0.f, -9.81f, 0.f), 0.5f);
+	for (int y = 0; y < _size; ++y)
+		for (int x = 0; x < _size; ++x)
+		{
+			const bool pinned = y == 0 && (x == 0 || x == _size - 1);
+			network->addParticle(vec3(x * _spacing, 0.f, y * _spacing), pinned ? 0.f : 0.01f);
+		}
+	for (int y = 0; y < _size; ++y)
+		for (int x = 0; x < _size; ++x)
+		{
+			const uint32_t i = y * _size + x;
+			if (x + 1 < _size) network->addSpring(i, i + 1, 500.f);
+			if (y + 1 < _size) network->addSpring(i, i + _size, 500.f);
+			if (x + 1 < _size && y + 1 < _size) network->addSpring(i, i + _size + 1, 100.f);
+		}
+	return network;
+}
+
+int main()
+{
+	const float dt = 1.f / 30.f;
+
+	{
+		// a mass on a spring oscillates with the period 2 pi sqrt(m / k)
+		const float mass = 50.f;
+		const float stiffness = 10.f;
+		math::SpringNetwork<float> network;
+		const uint32_t anchor = network.addParticle(vec3(0.f), 0.f);
+		const uint32_t body = network.addParticle(vec3(-2.f, 0.f, 0.f), mass);
+		network.addSpring(anchor, body, stiffness, 0.f);
+
+		const float period = 2.f * 3.14159265f * std::sqrt(mass / stiffness);
+		const int halfPeriodSteps = static_cast<int>(std::round(period * 0.5f / dt));
+		for (int i = 0; i < halfPeriodSteps; ++i)
+			network.step(dt);
+		EXPECT(std::abs(network.positions()[body].x - 2.f) < 0.05f, "Half a period of the oscillation.");
+		for (int i = 0; i < halfPeriodSteps; ++i)
+			network.step(dt);
+		EXPECT(std::abs(network.positions()[body].x + 2.f) < 0.05f && network.positions()[anchor] == vec3(0.f), "Full period of the oscillation.");
+	}
+
+	{
+		// A damped rope comes to rest, the top spring carries the weight of the rope.
+		// The error at rest is about g h^2 per particle below the spring, so more substeps are used.
+		const int numParticles = 20;
+		const float mass = 0.1f;
+		const float stiffness = 1000.f;
+		math::SpringNetwork<float> network(vec3(0.f, -9.81f, 0.f), 2.f, 16);
+		network.addParticle(vec3(0.f), 0.f);
+		for (int i = 1; i < numParticles; ++i)
+		{
+			network.addParticle(vec3(0.f, -0.1f * i, 0.f), mass);
+			network.addSpring(i - 1, i, stiffness);
+		}
+		for (int i = 0; i < 600; ++i)
+			network.step(dt);
+
+		const float topLength = glm::length(network.positions()[1] - network.positions()[0]);
+		const float expected = 0.1f + (numParticles - 1) * mass * 9.81f / stiffness;
+		EXPECT(std::abs(topLength - expected) < 0.02f * expected, "Top spring of the rope carries its weight.");
+		EXPECT(glm::length(network.velocities()[numParticles - 1]) < 1e-2f, "Rope comes to rest.");
+	}
+
+	{
+		// independent networks are stepped in parallel with the same result
+		auto run = [&](utils::ThreadPool& _threadPool)
+		{
+			std::vector<std::unique_ptr<math::SpringNetwork<float>>> networks;
+			std::vector<math::SpringNetwork<float>*> pointers;
+			for (int i = 0; i < 6; ++i)
+			{
+				networks.push_back(cloth(20 + i, 0.1f));
+				pointers.push_back(networks.back().get());
+			}
+			for (int i = 0; i < 30; ++i)
+				components::SpringNetworkSystem(entity::EntityRegistry::getInstance(), pointers, dt).execute(_threadPool);
+			std::vector<vec3> positions;
+			for (const auto& network : networks)
+				positions.insert(positions.end(), network->positions().begin(), network->positions().end());
+			return positions;
+		};
+		utils::ThreadPool single(1);
+		utils::ThreadPool parallel(3);
+		const std::vector<vec3> a = run(single);
+		const std::vector<vec3> b = run(parallel);
+		bool finite = true;
+		for (const vec3& p : a)
+			finite &= std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+		EXPECT(a == b, "Parallel networks give identical results.");
+		EXPECT(finite && a[0] == vec3(0.f) && a[20 * 20 - 1].y < -0.1f, "Cloth hangs from its corners.");
+	}
+
+	{
+		// entities follow their particles, pinned particles follow their entities
+		entity::EntityRegistry &registry = entity::EntityRegistry::getInstance();
+		math::SpringNetwork<float> network(vec3(0.f, -9.81f, 0.f));
+		const uint32_t anchor = network.addParticle(vec3(0.f), 0.f);
+		const uint32_t body = network.addParticle(vec3(0.f, -1.f, 0.f), 1.f);
+		network.addSpring(anchor, body, 100.f);
+		entity::EntityReference *anchorEntity = registry.createEntity(
+			components::Transform(vec3(5.f, 0.f, 0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::SpringParticle(&network, anchor));
+		entity::EntityReference *bodyEntity = registry.createEntity(
+			components::Transform(vec3(0.f), glm::quat(vec3(0.f)), vec3(1.f)),
+			components::SpringParticle(&network, body));
+
+		math::SpringNetwork<float>* networks[] = { &network };
+		components::SpringNetworkSystem(registry, networks, dt).execute();
+		EXPECT(network.positions()[anchor] == vec3(5.f, 0.f, 0.f), "Pinned particle follows the Transform.");
+		EXPECT(registry.getComponentData<components::Transform>(bodyEntity).value().getPosition() == network.positions()[body]
+			&& network.positions()[body].x > 0.f, "Transform follows the particle.");
+
+		for (entity::EntityReference *entity : { anchorEntity, bodyEntity })
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	return testsFailed;
+}
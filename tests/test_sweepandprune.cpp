@@ -0,0 +1,110 @@
+#include "testutils.hpp"
+
+#include <engine/utils/containers/sweepandprune.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using SAP = utils::SweepAndPrune<int, 3, float>;
+using Pairs = std::vector<std::pair<int, int>>;
+
+struct Object
+{
+	glm::vec3 position;
+	glm::vec3 velocity;
+	float radius;
+	SAP::ProxyId proxy;
+	bool alive = true;
+
+	SAP::AABB box() const { return { position - glm::vec3(radius), position + glm::vec3(radius) }; }
+};
+
+Pairs normalize(Pairs _pairs)
+{
+	for (auto& [a, b] : _pairs)
+		if (a > b) std::swap(a, b);
+	std::sort(_pairs.begin(), _pairs.end());
+	return _pairs;
+}
+
+Pairs bruteForce(const std::vector<Object>& _objects)
+{
+	Pairs pairs;
+	for (int i = 0; i < static_cast<int>(_objects.size()); ++i)
+		for (int j = i + 1; j < static_cast<int>(_objects.size()); ++j)
+			if (_objects[i].alive && _objects[j].alive && _objects[i].box().intersect(_objects[j].box()))
+				pairs.emplace_back(i, j);
+	return pairs;
+}
+
+// Objects in a flat disc, so that the x and z axes are good choices for the sweep.
+bool simulate(SAP& _sap, int _numTicks)
+{
+	std::default_random_engine rng(4242u);
+	std::uniform_real_distribution<float> position(-30.f, 30.f);
+	std::uniform_real_distribution<float> height(-1.f, 1.f);
+	std::uniform_real_distribution<float> velocity(-1.f, 1.f);
+	std::uniform_real_distribution<float> radius(0.2f, 1.5f);
+
+	std::vector<Object> objects;
+	for (int i = 0; i < 800; ++i)
+	{
+		Object obj{ glm::vec3(position(rng), height(rng), position(rng)), glm::vec3(velocity(rng), 0.f, velocity(rng)), radius(rng) };
+		obj.proxy = _sap.add(obj.box(), i);
+		objects.push_back(obj);
+	}
+
+	bool allMatch = true;
+	for (int tick = 0; tick < _numTicks; ++tick)
+	{
+		for (Object& obj : objects)
+		{
+			if (!obj.alive) continue;
+			obj.position += obj.velocity * 0.1f;
+			_sap.update(obj.proxy, obj.box());
+		}
+
+		// remove and add some objects to test the reuse of proxies
+		if (tick % 5 == 2)
+		{
+			for (int i = tick; i < static_cast<int>(objects.size()); i += 37)
+			{
+				if (objects[i].alive) _sap.remove(objects[i].proxy);
+				else objects[i].proxy = _sap.add(objects[i].box(), i);
+				objects[i].alive = !objects[i].alive;
+			}
+		}
+
+		allMatch &= normalize(_sap.findPairs()) == bruteForce(objects);
+	}
+	return allMatch;
+}
+
+int main()
+{
+	SAP sap;
+	EXPECT(sap.findPairs().empty() && sap.size() == 0, "Find pairs without elements.");
+
+	const SAP::ProxyId a = sap.add(SAP::AABB(glm::vec3(0.f), glm::vec3(1.f)), 1);
+	const SAP::ProxyId b = sap.add(SAP::AABB(glm::vec3(2.f), glm::vec3(3.f)), 2);
+	EXPECT(sap.findPairs().empty(), "Separated boxes do not overlap.");
+	sap.update(b, SAP::AABB(glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(1.5f)));
+	EXPECT(sap.findPairs().size() == 1, "Overlap after an update.");
+	sap.update(b, SAP::AABB(glm::vec3(0.5f, 0.5f, 2.f), glm::vec3(1.5f, 1.5f, 3.f)));
+	EXPECT(sap.findPairs().empty(), "Boxes which only overlap on the sweep axis.");
+	sap.remove(a);
+	const SAP::ProxyId c = sap.add(SAP::AABB(glm::vec3(1.f, 1.f, 2.5f), glm::vec3(2.f, 2.f, 3.f)), 3);
+	EXPECT(c != a && sap.size() == 2, "Removed proxies are not reused before the next sweep.");
+	const auto& pairs = sap.findPairs();
+	EXPECT(pairs.size() == 1 && std::min(pairs[0].first, pairs[0].second) == 2, "Removed elements are ignored.");
+
+	sap.clear();
+	EXPECT(simulate(sap, 40), "Pairs match brute force while objects move, are added and removed.");
+	EXPECT(sap.getSweepAxis() != 1, "The axis with the largest variance is chosen.");
+
+	SAP fixedAxis(1);
+	EXPECT(simulate(fixedAxis, 10) && fixedAxis.getSweepAxis() == 1, "Pairs match brute force with a fixed axis.");
+
+	return testsFailed;
+}
@@ -0,0 +1,94 @@
+#include "testutils.hpp"
+
+#include <engine/components/transform.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <cmath>
+
+using Transform = components::Transform;
+
+static bool near(const glm::mat4& _a, const glm::mat4& _b)
+{
+	for (int c = 0; c < 4; ++c)
+		for (int r = 0; r < 4; ++r)
+			if (std::abs(_a[c][r] - _b[c][r]) > 1e-5f) return false;
+	return true;
+}
+
+static glm::mat4 reference(const Transform& _transform)
+{
+	return glm::translate(glm::identity<glm::mat4>(), _transform.getPosition()) * glm::toMat4(_transform.getRotation())
+		* glm::scale(glm::identity<glm::mat4>(), _transform.getScale());
+}
+
+int main()
+{
+	std::default_random_engine rng(42u);
+	std::uniform_real_distribution<float> position(-10.f, 10.f);
+	std::uniform_real_distribution<float> angle(-3.f, 3.f);
+	std::uniform_real_distribution<float> scale(0.1f, 4.f);
+	auto randomTransform = [&]()
+	{
+		return Transform(glm::vec3(position(rng), position(rng), position(rng)), glm::quat(glm::vec3(angle(rng), angle(rng), angle(rng))),
+			glm::vec3(scale(rng), scale(rng), scale(rng)));
+	};
+
+	{
+		Transform transform = randomTransform();
+		EXPECT(transform.isMatrixOutdated() && transform.hasTransformChanged(), "New transforms have no matrix yet.");
+		EXPECT(near(transform.getTransformMatrix(), reference(transform)) && !transform.isMatrixOutdated(), "Matrix is composed on demand.");
+
+		transform.onChangesHandled();
+		transform.setPosition(glm::vec3(1.f, 2.f, 3.f));
+		transform.setRotation(glm::quat(glm::vec3(0.5f, 0.f, 1.f)));
+		transform.setScale(glm::vec3(2.f));
+		EXPECT(transform.isMatrixOutdated() && transform.hasTransformChanged(), "Setters only mark the matrix.");
+		EXPECT(near(transform.getTransformMatrix(), reference(transform)), "Matrix after multiple changes.");
+	}
+
+	{
+		std::vector<Transform> transforms;
+		for (int i = 0; i < 101; ++i)
+			transforms.push_back(randomTransform());
+		std::vector<glm::mat4> matrices(transforms.size());
+		components::ComposeTransformSystem::composeMatrices(transforms, matrices);
+		bool allNear = true;
+		for (size_t i = 0; i < transforms.size(); ++i)
+			allNear &= near(matrices[i], reference(transforms[i]));
+		EXPECT(allNear, "Batched composition gives the same matrices.");
+		components::ComposeTransformSystem::composeMatrices({}, {});
+	}
+
+	{
+		entity::EntityRegistry& registry = entity::EntityRegistry::getInstance();
+		std::vector<entity::EntityReference*> entities;
+		for (int i = 0; i < 20; ++i)
+			entities.push_back(registry.createEntity(randomTransform()));
+		components::ComposeTransformSystem(registry).execute();
+
+		Transform moved = registry.getComponentData<Transform>(entities[3]).value();
+		moved.setPosition(glm::vec3(5.f));
+		registry.addOrSetComponent(entities[3], moved);
+		EXPECT(registry.getComponentData<Transform>(entities[3]).value().isMatrixOutdated(), "Change is stored in the registry.");
+
+		components::ComposeTransformSystem(registry).execute();
+		bool allComposed = true;
+		for (entity::EntityReference* entity : entities)
+		{
+			const Transform transform = registry.getComponentData<Transform>(entity).value();
+			allComposed &= !transform.isMatrixOutdated() && near(transform.getTransformMatrix(), reference(transform));
+		}
+		EXPECT(allComposed, "System composes the matrices in the registry.");
+		EXPECT(registry.getComponentData<Transform>(entities[3]).value().getTransformMatrix()[3] == glm::vec4(5.f, 5.f, 5.f, 1.f),
+			"Moved transform has the new position.");
+
+		for (entity::EntityReference* entity : entities)
+		{
+			registry.eraseEntity(entity);
+			delete entity;
+		}
+	}
+
+	return testsFailed;
+}